@@ -0,0 +1,100 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+struct bench_case
+{
+    const char *name;
+    void (*run)(void);
+};
+
+static const struct bench_case bench_cases[] = {
+        {"trace", bench_trace},
+        {"min", bench_min},
+        {"service", bench_service},
+        {"loop", bench_loop},
+        {"timerfd", bench_timerfd},
+        {"stat", bench_stat},
+        {"prof", bench_prof},
+        {"store", bench_store},
+        {"jitter", bench_jitter},
+        {"queue", bench_queue},
+        {"sorted", bench_sorted},
+        {"clock", bench_clock},
+        {"edf", bench_edf},
+        {"idle", bench_idle},
+        {"lift", bench_lift},
+        {"replay", bench_replay},
+        {"earliest", bench_earliest},
+        {"bin", bench_bin},
+        {"compact", bench_compact},
+        {"snap", bench_snap},
+        {"wait", bench_wait},
+        {"shm", bench_shm},
+        {"service_late", bench_service_late},
+};
+
+static uint32_t bench_seed = 0x12345678;
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+static void bench_print_name(const char *name)
+{
+    printf("Bench %s ", name);
+    size_t i;
+    for (i = strlen(name); i < 80 - 8 - 22; i++)
+        printf(".");
+}
+
+void bench_report(const char *name, uint64_t ops, uint64_t ns)
+{
+    double ns_per_op = ops ? (double)ns / ops : 0;
+    bench_print_name(name);
+    printf(" %10.2f ns/op %10.2f Mop/s\n", ns_per_op, ns ? ops * 1e3 / ns : 0);
+}
+
+void bench_report_value(const char *name, double value, const char *unit)
+{
+    bench_print_name(name);
+    printf(" %10.2f %s\n", value, unit);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t i;
+    int j;
+
+    for (i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++)
+    {
+        int selected = argc < 2;
+        for (j = 1; j < argc; j++)
+        {
+            if (strcmp(argv[j], bench_cases[i].name) == 0)
+                selected = 1;
+        }
+        if (!selected)
+            continue;
+
+        printf("== %s\n", bench_cases[i].name);
+        bench_cases[i].run();
+    }
+
+    return 0;
+}
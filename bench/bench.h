@@ -0,0 +1,61 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+
+/**
+ * @brief  Monotonic wall clock used by all benchmarks.
+ * @return current time in nanoseconds.
+ */
+uint64_t bench_now_ns(void);
+
+/**
+ * @brief  Small xorshift generator, deterministic across runs.
+ * @return next pseudo random value.
+ */
+uint32_t bench_rand(void);
+
+/**
+ * @brief  Print one benchmark line as ns/op and Mop/s.
+ * @param[in]  name: Case name.
+ * @param[in]  ops: Number of operations measured.
+ * @param[in]  ns: Elapsed time in nanoseconds.
+ */
+void bench_report(const char *name, uint64_t ops, uint64_t ns);
+
+/**
+ * @brief  Print one benchmark line with a free form value.
+ * @param[in]  name: Case name.
+ * @param[in]  value: Measured value.
+ * @param[in]  unit: Unit string of value.
+ */
+void bench_report_value(const char *name, double value, const char *unit);
+
+//
+// Benchmarks
+//
+void bench_trace(void);
+void bench_min(void);
+void bench_service(void);
+void bench_loop(void);
+void bench_timerfd(void);
+void bench_stat(void);
+void bench_prof(void);
+void bench_store(void);
+void bench_jitter(void);
+void bench_queue(void);
+void bench_sorted(void);
+void bench_clock(void);
+void bench_edf(void);
+void bench_idle(void);
+void bench_lift(void);
+void bench_replay(void);
+void bench_earliest(void);
+void bench_bin(void);
+void bench_compact(void);
+void bench_snap(void);
+void bench_wait(void);
+void bench_shm(void);
+void bench_service_late(void);
+
+#endif /* _BENCH_H_ */
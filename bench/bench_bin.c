@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "etimer_bin.h"
+
+#define BENCH_BIN_SET     (16u * 1024) /* events, cache resident */
+#define BENCH_BIN_ROUNDS  1024
+#define BENCH_BIN_WIDTH   1000 /* 1 ms of 1 us ticks */
+#define BENCH_BIN_WIDTH16 10   /* 1 ms of 100 us ticks */
+#define BENCH_BIN_BINS    1000
+
+static uint32_t bench_bin_times[BENCH_BIN_SET];
+static uint16_t bench_bin_times16[BENCH_BIN_SET];
+static uint32_t bench_bin_index[BENCH_BIN_SET];
+static uint32_t bench_bin_counts[BENCH_BIN_BINS];
+static uint32_t bench_bin_base = 0xFFF80000;
+static struct etimer_bin bench_bin_32;
+static struct etimer_bin bench_bin16;
+
+static uint64_t bench_bin_sum(void)
+{
+    uint64_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < BENCH_BIN_BINS; i++)
+    {
+        sum += (uint64_t)bench_bin_counts[i] * (i + 1);
+    }
+    return sum;
+}
+
+/**
+ * @brief  Baseline: etimer_sub() and a division per event.
+ */
+static uint64_t bench_bin_divide(void)
+{
+    uint32_t r;
+    int32_t off;
+    size_t i;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_BIN_SET; i++)
+        {
+            off = etimer_sub(bench_bin_times[i], bench_bin_base);
+            if (off >= 0 && off < BENCH_BIN_WIDTH * BENCH_BIN_BINS)
+            {
+                bench_bin_counts[(uint32_t)off / bench_bin_32.width]++;
+            }
+        }
+    }
+    return bench_bin_sum();
+}
+
+static uint64_t bench_bin_one(void)
+{
+    uint32_t r, index;
+    size_t i;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_BIN_SET; i++)
+        {
+            index = etimer_bin_one(&bench_bin_32, bench_bin_times[i], bench_bin_base);
+            if (index != ETIMER_BIN_NONE)
+            {
+                bench_bin_counts[index]++;
+            }
+        }
+    }
+    return bench_bin_sum();
+}
+
+static uint64_t bench_bin_counted(void)
+{
+    uint32_t r;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        etimer_bin_raw(&bench_bin_32, bench_bin_times, BENCH_BIN_SET, bench_bin_base, NULL,
+                       bench_bin_counts);
+    }
+    return bench_bin_sum();
+}
+
+static uint64_t bench_bin_indexed(void)
+{
+    uint64_t inside = 0;
+    uint32_t r;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        inside += etimer_bin_raw(&bench_bin_32, bench_bin_times, BENCH_BIN_SET, bench_bin_base,
+                                 bench_bin_index, NULL);
+    }
+    return inside;
+}
+
+static uint64_t bench_bin_divide16(void)
+{
+    uint32_t r;
+    int32_t off;
+    size_t i;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_BIN_SET; i++)
+        {
+            off = etimer16_sub(bench_bin_times16[i], (uint16_t)bench_bin_base);
+            if (off >= 0 && off < BENCH_BIN_WIDTH16 * BENCH_BIN_BINS)
+            {
+                bench_bin_counts[(uint32_t)off / bench_bin16.width]++;
+            }
+        }
+    }
+    return bench_bin_sum();
+}
+
+static uint64_t bench_bin_counted16(void)
+{
+    uint32_t r;
+
+    for (r = 0; r < BENCH_BIN_ROUNDS; r++)
+    {
+        etimer16_bin_raw(&bench_bin16, bench_bin_times16, BENCH_BIN_SET,
+                         (uint16_t)bench_bin_base, NULL, bench_bin_counts);
+    }
+    return bench_bin_sum();
+}
+
+static uint64_t bench_bin_run(const char *name, uint64_t (*fn)(void))
+{
+    uint64_t t0, sum;
+
+    memset(bench_bin_counts, 0, sizeof(bench_bin_counts));
+    t0 = bench_now_ns();
+    sum = fn();
+    bench_report(name, (uint64_t)BENCH_BIN_SET * BENCH_BIN_ROUNDS, bench_now_ns() - t0);
+    return sum;
+}
+
+void bench_bin(void)
+{
+    uint64_t sums[6];
+    size_t i;
+
+    etimer_bin_init(&bench_bin_32, BENCH_BIN_WIDTH, BENCH_BIN_BINS, ETIMER_MAX_VALUE);
+    etimer_bin_init(&bench_bin16, BENCH_BIN_WIDTH16, BENCH_BIN_BINS, 0xFFFF);
+
+    // a 1 s window across the wrap, one event in 10 before or after it
+    for (i = 0; i < BENCH_BIN_SET; i++)
+    {
+        bench_bin_times[i] = bench_bin_base + bench_rand() % 1111111 - 55555;
+        bench_bin_times16[i] = (uint16_t)(bench_bin_base + bench_rand() % 11111 - 555);
+    }
+
+    sums[0] = bench_bin_run("32-bit, etimer_sub and divide per event", bench_bin_divide);
+    sums[1] = bench_bin_run("32-bit, etimer_bin_one per event", bench_bin_one);
+    sums[2] = bench_bin_run("32-bit, etimer_bin_raw counts", bench_bin_counted);
+    sums[3] = bench_bin_run("32-bit, etimer_bin_raw indexes", bench_bin_indexed);
+    sums[4] = bench_bin_run("16-bit, etimer16_sub and divide per event", bench_bin_divide16);
+    sums[5] = bench_bin_run("16-bit, etimer16_bin_raw counts", bench_bin_counted16);
+
+    printf("(%s, %.1f%% in the window)\n",
+           sums[0] == sums[1] && sums[1] == sums[2] ? "same counts" : "counts differ",
+           100.0 * sums[3] / ((uint64_t)BENCH_BIN_SET * BENCH_BIN_ROUNDS));
+    printf("(16-bit %s)\n", sums[4] == sums[5] ? "same counts" : "counts differ");
+}
@@ -0,0 +1,126 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "etimer_clock.h"
+
+#define BENCH_CLOCK_READS (16u << 20)
+
+// Simulated 16-bit timer: the counter and overflow flag registers.
+static volatile uint32_t bench_clock_hw;
+static volatile int bench_clock_flag;
+static struct etimer_clock bench_clock_c;
+static uint32_t bench_clock_epoch; /* for the masked read */
+static volatile int bench_clock_stop;
+
+static uint32_t bench_clock_read(void)
+{
+    return bench_clock_hw & 0xFFFF;
+}
+
+static int bench_clock_pending(void)
+{
+    return bench_clock_flag;
+}
+
+static void bench_clock_clear(void)
+{
+    bench_clock_flag = 0;
+}
+
+/**
+ * @brief  What the composite read replaces: mask interrupts, here signals, around two reads.
+ */
+static uint32_t bench_clock_masked(void)
+{
+    sigset_t all, old;
+    uint32_t now;
+
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    now = (bench_clock_epoch << 16) | bench_clock_read();
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    return now;
+}
+
+static void *bench_clock_overflows(void *arg)
+{
+    uint64_t *count = arg;
+
+    while (!bench_clock_stop)
+    {
+        bench_clock_hw = 0;
+        bench_clock_flag = 1;
+        etimer_clock_overflow(&bench_clock_c);
+        (*count)++;
+        bench_clock_hw = 0x8000;
+    }
+
+    return NULL;
+}
+
+static void bench_clock_run(const char *name, int pending, int storm)
+{
+    uint64_t overflows = 0, t0, ns;
+    uint32_t sum = 0, i;
+    pthread_t tid;
+    char label[64];
+
+    etimer_clock_init(&bench_clock_c, 0xFFFF, bench_clock_read,
+                      pending ? bench_clock_pending : NULL, bench_clock_clear);
+    bench_clock_stop = 0;
+    if (storm)
+    {
+        pthread_create(&tid, NULL, bench_clock_overflows, &overflows);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_CLOCK_READS; i++)
+    {
+        sum += etimer_clock_read(&bench_clock_c);
+    }
+    ns = bench_now_ns() - t0;
+
+    if (storm)
+    {
+        bench_clock_stop = 1;
+        pthread_join(tid, NULL);
+    }
+
+    bench_report(name, BENCH_CLOCK_READS, ns);
+    if (storm)
+    {
+        snprintf(label, sizeof(label), "%s, overflows", name);
+        bench_report_value(label, (double)overflows * 1e9 / (double)ns, "/s");
+    }
+    (void)sum;
+}
+
+void bench_clock(void)
+{
+    uint32_t sum = 0, i;
+    uint64_t t0;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_CLOCK_READS; i++)
+    {
+        sum += bench_clock_read();
+    }
+    bench_report("counter read only", BENCH_CLOCK_READS, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_CLOCK_READS / 16; i++)
+    {
+        sum += bench_clock_masked();
+    }
+    bench_report("masked read", BENCH_CLOCK_READS / 16, bench_now_ns() - t0);
+    (void)sum;
+
+    bench_clock_run("composite read", 0, 0);
+    bench_clock_run("composite read, pending flag", 1, 0);
+    bench_clock_run("composite read, overflow storm", 1, 1);
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_compact.h"
+
+#define BENCH_COMPACT_TIMERS  (2u * 1024 * 1024)
+#define BENCH_COMPACT_GRANULE 256 /* us */
+#define BENCH_COMPACT_SLOTS   4096
+#define BENCH_COMPACT_HORIZON (BENCH_COMPACT_GRANULE * BENCH_COMPACT_SLOTS)
+#define BENCH_COMPACT_BATCH   256
+
+//
+// Baseline: the usual node of a pointer wheel, deadline, links and a callback with its argument.
+//
+struct bench_node
+{
+    uint32_t deadline;
+    struct bench_node *prev;
+    struct bench_node *next;
+    void (*cb)(struct bench_node *node, void *arg);
+    void *arg;
+};
+
+static struct bench_node *bench_nodes;
+static struct bench_node *bench_wheel[BENCH_COMPACT_SLOTS];
+static uint32_t bench_wheel_cursor;
+static uint32_t *bench_deadlines;
+static void *bench_expired[BENCH_COMPACT_BATCH];
+static uint32_t bench_expired_handles[BENCH_COMPACT_BATCH];
+
+static void bench_wheel_add(struct bench_node *node, uint32_t deadline)
+{
+    struct bench_node **head =
+            &bench_wheel[(deadline / BENCH_COMPACT_GRANULE) % BENCH_COMPACT_SLOTS];
+
+    node->deadline = deadline;
+    node->prev = NULL;
+    node->next = *head;
+    if (*head != NULL)
+    {
+        (*head)->prev = node;
+    }
+    *head = node;
+}
+
+static void bench_wheel_unlink(struct bench_node *node)
+{
+    if (node->prev != NULL)
+    {
+        node->prev->next = node->next;
+    }
+    else
+    {
+        bench_wheel[(node->deadline / BENCH_COMPACT_GRANULE) % BENCH_COMPACT_SLOTS] = node->next;
+    }
+    if (node->next != NULL)
+    {
+        node->next->prev = node->prev;
+    }
+}
+
+static size_t bench_wheel_expire(uint32_t now, void **out, size_t max)
+{
+    struct bench_node *node, *next;
+    size_t n = 0;
+
+    while (n < max && etimer_sub(now, bench_wheel_cursor) >= 0)
+    {
+        for (node = bench_wheel[(bench_wheel_cursor / BENCH_COMPACT_GRANULE) %
+                                BENCH_COMPACT_SLOTS];
+             node != NULL && n < max; node = next)
+        {
+            next = node->next;
+            if (!etimer_past(now, node->deadline))
+            {
+                bench_wheel_unlink(node);
+                out[n++] = node;
+            }
+        }
+        if (n == max || etimer_sub(now, bench_wheel_cursor + BENCH_COMPACT_GRANULE - 1) < 0)
+        {
+            break;
+        }
+        bench_wheel_cursor += BENCH_COMPACT_GRANULE;
+    }
+    return n;
+}
+
+static struct etimer_compact bench_compact_wheel;
+
+/**
+ * @brief  Expire everything from start in steps, returns ns per expired timer.
+ */
+static double bench_compact_drain(uint32_t start, uint32_t step, int compact, uint64_t *sum)
+{
+    uint32_t now = start, *handles = bench_expired_handles;
+    uint64_t done = 0, t0 = bench_now_ns();
+    size_t n, i;
+
+    while (done < BENCH_COMPACT_TIMERS)
+    {
+        now += step;
+        do
+        {
+            if (compact)
+            {
+                n = etimer_compact_expire(&bench_compact_wheel, now, handles, BENCH_COMPACT_BATCH);
+                for (i = 0; i < n; i++)
+                {
+                    *sum += handles[i];
+                }
+            }
+            else
+            {
+                n = bench_wheel_expire(now, bench_expired, BENCH_COMPACT_BATCH);
+                for (i = 0; i < n; i++)
+                {
+                    *sum += (uint64_t)((struct bench_node *)bench_expired[i] - bench_nodes);
+                }
+            }
+            done += n;
+        } while (n == BENCH_COMPACT_BATCH);
+    }
+    return (double)(bench_now_ns() - t0) / BENCH_COMPACT_TIMERS;
+}
+
+static void bench_compact_case(uint32_t step)
+{
+    uint32_t start = 0xFFF80000, i;
+    uint64_t sums[2] = {0, 0}, t0;
+    double ns[2];
+    char name[96];
+
+    // pointer wheel, nodes linked in random order like objects allocated over time
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_COMPACT_TIMERS; i++)
+    {
+        bench_wheel_add(&bench_nodes[i], bench_deadlines[i]);
+    }
+    if (step == BENCH_COMPACT_GRANULE)
+    {
+        bench_report("pointer wheel, add", BENCH_COMPACT_TIMERS, bench_now_ns() - t0);
+        bench_report_value("pointer wheel, bytes per timer",
+                           sizeof(struct bench_node) +
+                                   (double)sizeof(bench_wheel) / BENCH_COMPACT_TIMERS,
+                           "B");
+    }
+    bench_wheel_cursor = start & ~(uint32_t)(BENCH_COMPACT_GRANULE - 1);
+    ns[0] = bench_compact_drain(start, step, 0, &sums[0]);
+
+    etimer_compact_init(&bench_compact_wheel, BENCH_COMPACT_TIMERS, BENCH_COMPACT_GRANULE,
+                        BENCH_COMPACT_SLOTS, start);
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_COMPACT_TIMERS; i++)
+    {
+        etimer_compact_add(&bench_compact_wheel, bench_deadlines[i]);
+    }
+    if (step == BENCH_COMPACT_GRANULE)
+    {
+        bench_report("etimer_compact, add", BENCH_COMPACT_TIMERS, bench_now_ns() - t0);
+        bench_report_value("etimer_compact, bytes per timer",
+                           (double)etimer_compact_memory(&bench_compact_wheel) /
+                                   BENCH_COMPACT_TIMERS,
+                           "B");
+    }
+    ns[1] = bench_compact_drain(start, step, 1, &sums[1]);
+    etimer_compact_deinit(&bench_compact_wheel);
+
+    snprintf(name, sizeof(name), "pointer wheel, expire, now += %u", step);
+    bench_report_value(name, ns[0], "ns/timer");
+    snprintf(name, sizeof(name), "etimer_compact, expire, now += %u", step);
+    bench_report_value(name, ns[1], "ns/timer");
+    printf("(%s)\n", sums[0] == sums[1] ? "same timers" : "timers differ");
+}
+
+void bench_compact(void)
+{
+    uint32_t start = 0xFFF80000, i;
+
+    bench_nodes = calloc(BENCH_COMPACT_TIMERS, sizeof(*bench_nodes));
+    bench_deadlines = malloc(BENCH_COMPACT_TIMERS * sizeof(*bench_deadlines));
+    for (i = 0; i < BENCH_COMPACT_TIMERS; i++)
+    {
+        bench_deadlines[i] = start + 1 + bench_rand() % (BENCH_COMPACT_HORIZON - 1);
+    }
+
+    // a whole bucket per poll, then polls every 16 us scanning the bucket of now
+    bench_compact_case(BENCH_COMPACT_GRANULE);
+    bench_compact_case(16);
+
+    free(bench_nodes);
+    free(bench_deadlines);
+}
@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "etimer_earliest.h"
+
+#define BENCH_EARLIEST_UPDATES (4u * 1024 * 1024) /* split over the threads */
+#define BENCH_EARLIEST_SPREAD  100000             /* us ahead of now */
+#define BENCH_EARLIEST_READ    256                /* thread 0 reads every this many updates */
+
+static struct etimer_earliest bench_earliest_reg;
+static struct etimer_earliest_shards bench_earliest_set;
+static uint32_t bench_earliest_threads;
+static uint32_t bench_earliest_stored;
+
+static inline uint32_t bench_earliest_now(void)
+{
+    return (uint32_t)(bench_now_ns() / 1000);
+}
+
+//
+// Baseline: one slot per thread in an array behind one mutex, the reader scans it.
+//
+static pthread_mutex_t bench_array_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t bench_array[64];
+static uint8_t bench_array_set[64];
+
+static int bench_array_get(uint32_t *deadline)
+{
+    uint32_t i;
+    int found = 0;
+
+    pthread_mutex_lock(&bench_array_lock);
+    for (i = 0; i < bench_earliest_threads; i++)
+    {
+        if (bench_array_set[i] && (!found || etimer_past(bench_array[i], *deadline)))
+        {
+            *deadline = bench_array[i];
+            found = 1;
+        }
+    }
+    pthread_mutex_unlock(&bench_array_lock);
+    return found;
+}
+
+/**
+ * @brief  Each thread publishes its next deadline, thread 0 also plays the idle thread reading
+ * the global minimum and taking it once in 16 reads.
+ */
+static void *bench_earliest_worker(void *arg)
+{
+    uint32_t self = (uint32_t)((uintptr_t)arg & 0xFF);
+    uint32_t mode = (uint32_t)((uintptr_t)arg >> 8);
+    uint32_t per = BENCH_EARLIEST_UPDATES / bench_earliest_threads;
+    uint32_t seed = self * 2654435761u + 1;
+    uint32_t now = bench_earliest_now(), deadline, stored = 0, i;
+
+    for (i = 0; i < per; i++)
+    {
+        if (i % 64 == 0)
+        {
+            now = bench_earliest_now();
+        }
+        seed = seed * 1103515245u + 12345;
+        deadline = now + (seed >> 8) % BENCH_EARLIEST_SPREAD;
+
+        if (mode == 0)
+        {
+            pthread_mutex_lock(&bench_array_lock);
+            bench_array[self] = deadline;
+            bench_array_set[self] = 1;
+            pthread_mutex_unlock(&bench_array_lock);
+        }
+        else if (mode == 1)
+        {
+            stored += etimer_earliest_update(&bench_earliest_reg, deadline, now);
+        }
+        else
+        {
+            stored += etimer_earliest_shards_update(&bench_earliest_set, self, deadline, now);
+        }
+
+        if (self == 0 && i % BENCH_EARLIEST_READ == 0)
+        {
+            if (mode == 0)
+            {
+                bench_array_get(&deadline);
+            }
+            else if (mode == 1 && i % (16 * BENCH_EARLIEST_READ) == 0)
+            {
+                etimer_earliest_take(&bench_earliest_reg, now, &deadline);
+            }
+            else if (mode == 1)
+            {
+                etimer_earliest_get(&bench_earliest_reg, now, &deadline);
+            }
+            else if (i % (16 * BENCH_EARLIEST_READ) == 0)
+            {
+                etimer_earliest_shards_take(&bench_earliest_set, now, &deadline);
+            }
+            else
+            {
+                etimer_earliest_shards_get(&bench_earliest_set, now, &deadline);
+            }
+        }
+    }
+
+    __atomic_fetch_add(&bench_earliest_stored, stored, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void bench_earliest_run(uint32_t mode, uint32_t threads, const char *label)
+{
+    pthread_t tid[64];
+    char name[64];
+    uint64_t t0, ns;
+    uint32_t i;
+
+    bench_earliest_threads = threads;
+    bench_earliest_stored = 0;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < threads; i++)
+    {
+        pthread_create(&tid[i], NULL, bench_earliest_worker, (void *)(uintptr_t)(mode << 8 | i));
+    }
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(tid[i], NULL);
+    }
+    ns = bench_now_ns() - t0;
+
+    snprintf(name, sizeof(name), "%s, %2u threads", label, threads);
+    bench_report(name, BENCH_EARLIEST_UPDATES / threads * threads, ns);
+    if (mode != 0)
+    {
+        snprintf(name, sizeof(name), "%s, %2u threads, stored", label, threads);
+        bench_report_value(name,
+                           100.0 * bench_earliest_stored /
+                                   (BENCH_EARLIEST_UPDATES / threads * threads),
+                           "%");
+    }
+}
+
+void bench_earliest(void)
+{
+    uint32_t threads, i;
+
+    for (threads = 1; threads <= 64; threads *= 2)
+    {
+        for (i = 0; i < 64; i++)
+        {
+            bench_array_set[i] = 0;
+        }
+        bench_earliest_run(0, threads, "mutex array  ");
+
+        etimer_earliest_init(&bench_earliest_reg);
+        bench_earliest_run(1, threads, "cas register ");
+
+        etimer_earliest_shards_init(&bench_earliest_set, threads < 8 ? threads : 8);
+        bench_earliest_run(2, threads, "sharded      ");
+        etimer_earliest_shards_deinit(&bench_earliest_set);
+    }
+}
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_edf.h"
+
+#define BENCH_EDF_JOBS   (1u << 20)
+#define BENCH_EDF_SCANS  (1u << 26) /* task visits of the linear baseline per case */
+#define BENCH_EDF_START  0xFFF00000 /* runs across the 32-bit wrap */
+
+//
+// Baseline: no queue, every decision scans all tasks comparing deadlines with etimer_past.
+//
+static uint32_t *bench_scan_release;
+static uint32_t *bench_scan_due;
+static uint32_t *bench_scan_period;
+
+static uint64_t bench_edf_scan(uint32_t n, uint32_t jobs, uint32_t *misses)
+{
+    uint32_t now = BENCH_EDF_START, done = 0, best, next, i;
+    uint64_t t0 = bench_now_ns();
+
+    while (done < jobs)
+    {
+        best = n;
+        next = 0;
+        for (i = 0; i < n; i++)
+        {
+            if (etimer_past(bench_scan_release[i], now))
+            {
+                if (best == n || etimer_past(bench_scan_due[i], bench_scan_due[best]))
+                {
+                    best = i;
+                }
+            }
+            else if (i == 0 || etimer_past(bench_scan_release[i], bench_scan_release[next]))
+            {
+                next = i;
+            }
+        }
+        if (best == n)
+        {
+            now = bench_scan_release[next];
+            continue;
+        }
+
+        now++;
+        *misses += etimer_past(bench_scan_due[best], now);
+        bench_scan_release[best] += bench_scan_period[best];
+        bench_scan_due[best] = bench_scan_release[best] + bench_scan_period[best];
+        done++;
+    }
+
+    return bench_now_ns() - t0;
+}
+
+static uint64_t bench_edf_heap(struct etimer_edf *edf, uint32_t jobs)
+{
+    struct etimer_edf_task *task;
+    uint32_t now = BENCH_EDF_START, done = 0;
+    uint64_t t0 = bench_now_ns();
+
+    while (done < jobs)
+    {
+        task = etimer_edf_next(edf, now);
+        if (task == NULL)
+        {
+            etimer_edf_wakeup(edf, &now);
+            continue;
+        }
+        now++;
+        etimer_edf_done(edf, task, now);
+        done++;
+    }
+
+    return bench_now_ns() - t0;
+}
+
+static void bench_edf_job(struct etimer_edf_task *task, void *arg)
+{
+    (void)task;
+    (void)arg;
+}
+
+static void bench_edf_run(uint32_t n)
+{
+    struct etimer_edf_task *tasks = malloc((size_t)n * sizeof(*tasks));
+    struct etimer_edf edf;
+    uint32_t scan_jobs = BENCH_EDF_SCANS / n, misses = 0, period, i;
+    uint64_t ns;
+    char name[64];
+
+    bench_scan_release = malloc((size_t)n * sizeof(uint32_t));
+    bench_scan_due = malloc((size_t)n * sizeof(uint32_t));
+    bench_scan_period = malloc((size_t)n * sizeof(uint32_t));
+    if (tasks == NULL || bench_scan_release == NULL || bench_scan_due == NULL ||
+        bench_scan_period == NULL || etimer_edf_init(&edf, n, ETIMER_MAX_VALUE, 1000,
+                                                     BENCH_EDF_START) != 0)
+    {
+        printf("  out of memory\n");
+        return;
+    }
+
+    // unit budgets and periods of 2n to 4n ticks, half the processor at most
+    for (i = 0; i < n; i++)
+    {
+        period = 2 * n + bench_rand() % (2 * n + 1);
+        etimer_edf_task_init(&tasks[i], period, 1, period, bench_edf_job, NULL);
+        etimer_edf_admit(&edf, &tasks[i], BENCH_EDF_START);
+        bench_scan_period[i] = period;
+        bench_scan_release[i] = BENCH_EDF_START;
+        bench_scan_due[i] = BENCH_EDF_START + period;
+    }
+
+    ns = bench_edf_heap(&edf, BENCH_EDF_JOBS);
+    snprintf(name, sizeof(name), "%6u tasks, edf heap decision", n);
+    bench_report(name, BENCH_EDF_JOBS, ns);
+    snprintf(name, sizeof(name), "%6u tasks, edf heap misses", n);
+    bench_report_value(name, edf.misses, "");
+
+    scan_jobs = scan_jobs < 1000 ? 1000 : scan_jobs;
+    scan_jobs = scan_jobs > BENCH_EDF_JOBS ? BENCH_EDF_JOBS : scan_jobs;
+    ns = bench_edf_scan(n, scan_jobs, &misses);
+    snprintf(name, sizeof(name), "%6u tasks, linear scan decision", n);
+    bench_report(name, scan_jobs, ns);
+    snprintf(name, sizeof(name), "%6u tasks, linear scan misses", n);
+    bench_report_value(name, misses, "");
+
+    etimer_edf_deinit(&edf);
+    free(bench_scan_release);
+    free(bench_scan_due);
+    free(bench_scan_period);
+    free(tasks);
+}
+
+void bench_edf(void)
+{
+    static const uint32_t counts[] = {10, 100, 1000, 10000, 100000};
+    uint32_t i;
+
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        bench_edf_run(counts[i]);
+    }
+}
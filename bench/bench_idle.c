@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_idle.h"
+
+#define BENCH_IDLE_CONNS   (1024u * 1024)
+#define BENCH_IDLE_TOUCHES (16u * 1024 * 1024)
+#define BENCH_IDLE_RATE    4 /* touches per tick */
+#define BENCH_IDLE_TIMEOUT (1u << 20)
+#define BENCH_IDLE_GRANULE (1u << 12)
+#define BENCH_IDLE_START   0xFFF00000 /* runs across the 32-bit wrap */
+
+//
+// Baseline: an indexed binary heap of deadlines, every touch moves the connection down.
+//
+struct bench_idle_entry
+{
+    uint32_t deadline;
+    uint32_t handle;
+};
+
+static struct bench_idle_entry *bench_heap;
+static uint32_t *bench_heap_pos;
+
+static inline void bench_heap_set(uint32_t pos, struct bench_idle_entry entry)
+{
+    bench_heap[pos] = entry;
+    bench_heap_pos[entry.handle] = pos;
+}
+
+static void bench_heap_down(uint32_t pos, struct bench_idle_entry entry)
+{
+    uint32_t child;
+
+    while ((child = pos * 2 + 1) < BENCH_IDLE_CONNS)
+    {
+        if (child + 1 < BENCH_IDLE_CONNS &&
+            etimer_sub(bench_heap[child + 1].deadline, bench_heap[child].deadline) < 0)
+        {
+            child++;
+        }
+        if (etimer_sub(bench_heap[child].deadline, entry.deadline) >= 0)
+        {
+            break;
+        }
+        bench_heap_set(pos, bench_heap[child]);
+        pos = child;
+    }
+    bench_heap_set(pos, entry);
+}
+
+static inline uint32_t bench_idle_pick(void)
+{
+    // one connection in 8 stays silent
+    uint32_t handle = bench_rand() % BENCH_IDLE_CONNS;
+    return handle % 8 ? handle : handle + 1;
+}
+
+static void bench_idle_heap(void)
+{
+    struct bench_idle_entry entry;
+    uint32_t now = BENCH_IDLE_START, expired = 0, i;
+    uint64_t t0, scan = 0, ns;
+
+    bench_heap = malloc(BENCH_IDLE_CONNS * sizeof(*bench_heap));
+    bench_heap_pos = malloc(BENCH_IDLE_CONNS * sizeof(*bench_heap_pos));
+    if (bench_heap == NULL || bench_heap_pos == NULL)
+    {
+        printf("  out of memory\n");
+        return;
+    }
+    for (i = 0; i < BENCH_IDLE_CONNS; i++)
+    {
+        entry.deadline = now + BENCH_IDLE_TIMEOUT;
+        entry.handle = i;
+        bench_heap_set(i, entry);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_IDLE_TOUCHES; i++)
+    {
+        entry.handle = bench_idle_pick();
+        entry.deadline = now + BENCH_IDLE_TIMEOUT;
+        bench_heap_down(bench_heap_pos[entry.handle], entry);
+
+        if (i % BENCH_IDLE_RATE == 0 && ++now % BENCH_IDLE_GRANULE == 0)
+        {
+            uint64_t s0 = bench_now_ns();
+            while (etimer_sub(now, bench_heap[0].deadline) >= 0)
+            {
+                // reconnect
+                entry = bench_heap[0];
+                entry.deadline = now + BENCH_IDLE_TIMEOUT;
+                bench_heap_down(0, entry);
+                expired++;
+            }
+            scan += bench_now_ns() - s0;
+        }
+    }
+    ns = bench_now_ns() - t0;
+
+    bench_report("1M conns, heap re-arm per touch", BENCH_IDLE_TOUCHES, ns - scan);
+    bench_report("1M conns, heap expiry per touch", BENCH_IDLE_TOUCHES, scan);
+    bench_report_value("1M conns, heap memory",
+                       (double)(sizeof(*bench_heap) + sizeof(*bench_heap_pos)), "B/conn");
+    bench_report_value("1M conns, heap expired", expired, "");
+
+    free(bench_heap);
+    free(bench_heap_pos);
+}
+
+static void bench_idle_lazy(void)
+{
+    static uint32_t handles[4096];
+    struct etimer_idle idle;
+    uint32_t now = BENCH_IDLE_START, expired = 0, i;
+    uint64_t t0, scan = 0, ns;
+    size_t n, k;
+
+    if (etimer_idle_init(&idle, BENCH_IDLE_CONNS, BENCH_IDLE_TIMEOUT, BENCH_IDLE_GRANULE,
+                         now) != 0)
+    {
+        printf("  out of memory\n");
+        return;
+    }
+    for (i = 0; i < BENCH_IDLE_CONNS; i++)
+    {
+        etimer_idle_add(&idle, now);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_IDLE_TOUCHES; i++)
+    {
+        etimer_idle_touch(&idle, bench_idle_pick(), now);
+
+        if (i % BENCH_IDLE_RATE == 0 && ++now % BENCH_IDLE_GRANULE == 0)
+        {
+            uint64_t s0 = bench_now_ns();
+            do
+            {
+                n = etimer_idle_expire(&idle, now, handles, 4096);
+                for (k = 0; k < n; k++)
+                {
+                    etimer_idle_add(&idle, now);
+                }
+                expired += n;
+            } while (n == 4096);
+            scan += bench_now_ns() - s0;
+        }
+    }
+    ns = bench_now_ns() - t0;
+
+    bench_report("1M conns, lazy touch", BENCH_IDLE_TOUCHES, ns - scan);
+    bench_report("1M conns, lazy expiry per touch", BENCH_IDLE_TOUCHES, scan);
+    bench_report_value("1M conns, lazy memory",
+                       (double)(3 * sizeof(uint32_t)) +
+                               (double)((idle.mask + 1) * sizeof(uint32_t)) / BENCH_IDLE_CONNS,
+                       "B/conn");
+    bench_report_value("1M conns, lazy expired", expired, "");
+
+    etimer_idle_deinit(&idle);
+}
+
+void bench_idle(void)
+{
+    bench_idle_heap();
+    bench_idle_lazy();
+}
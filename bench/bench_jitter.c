@@ -0,0 +1,92 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_jitter.h"
+
+#define BENCH_JITTER_N      (16u * 1024 * 1024)
+#define BENCH_JITTER_CHUNK  (64u * 1024)
+#define BENCH_JITTER_PERIOD 1000
+
+/**
+ * @brief  Baseline: one etimer_sub per interval and scalar running sums.
+ */
+static double bench_jitter_scalar(const uint32_t *times, size_t n, uint64_t *outliers)
+{
+    int32_t min = INT32_MAX, max = INT32_MIN;
+    int64_t sum = 0;
+    double sumsq = 0;
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        int32_t delta = etimer_sub(times[i], times[i - 1]);
+        int32_t err = delta - BENCH_JITTER_PERIOD;
+        min = delta < min ? delta : min;
+        max = delta > max ? delta : max;
+        sum += err;
+        sumsq += (double)err * err;
+        *outliers += err > 50 || err < -50;
+    }
+
+    return sqrt(sumsq / (n - 1)) + min + max + sum;
+}
+
+static void bench_jitter_report(const char *name, size_t bytes, uint64_t ns)
+{
+    bench_report_value(name, (double)bytes / ns, "GB/s");
+}
+
+void bench_jitter(void)
+{
+    uint32_t *times = malloc(BENCH_JITTER_N * sizeof(*times));
+    uint16_t *times16 = malloc(BENCH_JITTER_N * sizeof(*times16));
+    struct etimer_jitter jitter;
+    struct etimer_jitter_result res;
+    uint64_t outliers = 0, t0;
+    double sink = 0;
+    size_t i, pos;
+
+    times[0] = bench_rand();
+    for (i = 1; i < BENCH_JITTER_N; i++)
+    {
+        times[i] = times[i - 1] + BENCH_JITTER_PERIOD + bench_rand() % 21 - 10 +
+                   (bench_rand() % 10000 == 0 ? 100 : 0);
+    }
+    for (i = 0; i < BENCH_JITTER_N; i++)
+    {
+        times16[i] = (uint16_t)times[i];
+    }
+
+    t0 = bench_now_ns();
+    sink += bench_jitter_scalar(times, BENCH_JITTER_N, &outliers);
+    bench_jitter_report("32-bit, etimer_sub loop", BENCH_JITTER_N * sizeof(*times),
+                        bench_now_ns() - t0);
+
+    etimer_jitter_init(&jitter, BENCH_JITTER_PERIOD, 50, NULL, 0);
+    t0 = bench_now_ns();
+    for (pos = 0; pos < BENCH_JITTER_N; pos += BENCH_JITTER_CHUNK)
+    {
+        etimer_jitter_feed(&jitter, times + pos, BENCH_JITTER_CHUNK);
+    }
+    bench_jitter_report("32-bit, etimer_jitter_feed", BENCH_JITTER_N * sizeof(*times),
+                        bench_now_ns() - t0);
+    etimer_jitter_result(&jitter, &res);
+    sink += res.rms_err;
+
+    etimer_jitter_init(&jitter, BENCH_JITTER_PERIOD, 50, NULL, 0);
+    t0 = bench_now_ns();
+    for (pos = 0; pos < BENCH_JITTER_N; pos += BENCH_JITTER_CHUNK)
+    {
+        etimer16_jitter_feed(&jitter, times16 + pos, BENCH_JITTER_CHUNK);
+    }
+    bench_jitter_report("16-bit, etimer16_jitter_feed", BENCH_JITTER_N * sizeof(*times16),
+                        bench_now_ns() - t0);
+    etimer_jitter_result(&jitter, &res);
+
+    printf("(%.3f %llu %llu)\n", sink, (unsigned long long)outliers,
+           (unsigned long long)res.outliers);
+    free(times);
+    free(times16);
+}
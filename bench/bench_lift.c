@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_lift.h"
+
+#define BENCH_LIFT_SET   (16u * 1024) /* packets, cache resident */
+#define BENCH_LIFT_ROUNDS 1024
+#define BENCH_LIFT_BURST 32 /* packets per receive batch */
+#define BENCH_LIFT_MAX16 0xFFFF
+#define BENCH_LIFT_MAX24 0xFFFFFF
+
+static uint16_t bench_lift_stamps[BENCH_LIFT_SET];
+static uint32_t bench_lift_stamps24[BENCH_LIFT_SET];
+static uint32_t bench_lift_refs[BENCH_LIFT_SET / BENCH_LIFT_BURST];
+static uint32_t bench_lift_out[BENCH_LIFT_SET];
+
+static uint64_t bench_lift_sum(void)
+{
+    uint64_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < BENCH_LIFT_SET; i++)
+    {
+        sum += bench_lift_out[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief  Baseline: one packet at a time through the branching etimer_sub_raw().
+ */
+static uint64_t bench_lift_branchy(const uint32_t *stamps, uint32_t max_value)
+{
+    uint32_t ref, r;
+    size_t i, j;
+
+    for (r = 0; r < BENCH_LIFT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+        {
+            ref = bench_lift_refs[i / BENCH_LIFT_BURST];
+            for (j = i; j < i + BENCH_LIFT_BURST; j++)
+            {
+                bench_lift_out[j] = ref + (uint32_t)etimer_sub_raw(stamps[j], ref & max_value,
+                                                                   max_value >> 1, max_value);
+            }
+        }
+    }
+
+    return bench_lift_sum();
+}
+
+static uint64_t bench_lift_branchy16(void)
+{
+    uint32_t ref, r;
+    size_t i, j;
+
+    for (r = 0; r < BENCH_LIFT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+        {
+            ref = bench_lift_refs[i / BENCH_LIFT_BURST];
+            for (j = i; j < i + BENCH_LIFT_BURST; j++)
+            {
+                bench_lift_out[j] =
+                        ref + (uint32_t)etimer_sub_raw(bench_lift_stamps[j], ref & BENCH_LIFT_MAX16,
+                                                       BENCH_LIFT_MAX16 >> 1, BENCH_LIFT_MAX16);
+            }
+        }
+    }
+
+    return bench_lift_sum();
+}
+
+static uint64_t bench_lift_one16(void)
+{
+    uint32_t r;
+    size_t i, j;
+
+    for (r = 0; r < BENCH_LIFT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+        {
+            for (j = i; j < i + BENCH_LIFT_BURST; j++)
+            {
+                bench_lift_out[j] = etimer_lift_one(bench_lift_stamps[j],
+                                                    bench_lift_refs[i / BENCH_LIFT_BURST],
+                                                    BENCH_LIFT_MAX16);
+            }
+        }
+    }
+
+    return bench_lift_sum();
+}
+
+static uint64_t bench_lift_batch16(void)
+{
+    uint32_t r;
+    size_t i;
+
+    for (r = 0; r < BENCH_LIFT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+        {
+            etimer16_lift(bench_lift_stamps + i, BENCH_LIFT_BURST,
+                          bench_lift_refs[i / BENCH_LIFT_BURST], bench_lift_out + i);
+        }
+    }
+
+    return bench_lift_sum();
+}
+
+static uint64_t bench_lift_batch24(void)
+{
+    uint32_t r;
+    size_t i;
+
+    for (r = 0; r < BENCH_LIFT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+        {
+            etimer_lift_raw(bench_lift_stamps24 + i, BENCH_LIFT_BURST,
+                            bench_lift_refs[i / BENCH_LIFT_BURST], BENCH_LIFT_MAX24,
+                            bench_lift_out + i);
+        }
+    }
+
+    return bench_lift_sum();
+}
+
+static uint64_t bench_lift_run(const char *name, uint64_t (*fn)(void))
+{
+    uint64_t t0 = bench_now_ns(), sum = fn();
+
+    bench_report(name, (uint64_t)BENCH_LIFT_SET * BENCH_LIFT_ROUNDS, bench_now_ns() - t0);
+    return sum;
+}
+
+static uint64_t bench_lift_branchy24(void)
+{
+    return bench_lift_branchy(bench_lift_stamps24, BENCH_LIFT_MAX24);
+}
+
+void bench_lift(void)
+{
+    uint32_t now = 0xFFFF8000, sent;
+    uint64_t sums[5];
+    size_t i, j;
+
+    // a burst is received at ref, its packets were stamped up to 20000 ticks before, the clock
+    // wraps inside the set
+    for (i = 0; i < BENCH_LIFT_SET; i += BENCH_LIFT_BURST)
+    {
+        now += 1 + bench_rand() % 64;
+        bench_lift_refs[i / BENCH_LIFT_BURST] = now;
+        for (j = i; j < i + BENCH_LIFT_BURST; j++)
+        {
+            sent = now - bench_rand() % 20000;
+            bench_lift_stamps[j] = (uint16_t)sent;
+            bench_lift_stamps24[j] = sent & BENCH_LIFT_MAX24;
+        }
+    }
+
+    sums[0] = bench_lift_run("16-bit, etimer_sub_raw per packet", bench_lift_branchy16);
+    sums[1] = bench_lift_run("16-bit, etimer_lift_one per packet", bench_lift_one16);
+    sums[2] = bench_lift_run("16-bit, etimer16_lift burst of 32", bench_lift_batch16);
+    sums[3] = bench_lift_run("24-bit, etimer_sub_raw per packet", bench_lift_branchy24);
+    sums[4] = bench_lift_run("24-bit, etimer_lift_raw burst of 32", bench_lift_batch24);
+
+    printf("(%s)\n", sums[0] == sums[1] && sums[1] == sums[2] && sums[2] == sums[3] &&
+                                     sums[3] == sums[4]
+                             ? "same results"
+                             : "results differ");
+}
@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_loop.h"
+
+#define BENCH_LOOP_FLOWS 10000
+#define BENCH_LOOP_STEPS 100
+
+static uint32_t bench_loop_allocs;
+
+//
+// Coroutine flow: BENCH_LOOP_STEPS sleeps in one pooled frame.
+//
+struct bench_flow
+{
+    struct etimer_co co;
+    uint32_t step;
+};
+
+static int bench_flow_fn(struct etimer_co *co)
+{
+    struct bench_flow *flow = (struct bench_flow *)co;
+
+    ETIMER_CO_BEGIN(co);
+    for (flow->step = 0; flow->step < BENCH_LOOP_STEPS; flow->step++)
+    {
+        ETIMER_CO_SLEEP_FOR(co, 1 + bench_rand() % 1000);
+    }
+    ETIMER_CO_END(co);
+}
+
+//
+// Callback flow: every step allocates its continuation, as callbacks over etimer deadlines do.
+//
+struct bench_cb
+{
+    uint32_t deadline;
+    uint32_t step;
+    void (*fn)(struct bench_cb *cb, uint32_t now);
+};
+
+static struct bench_cb **bench_cb_heap;
+static uint32_t bench_cb_size;
+
+static void bench_cb_push(struct bench_cb *cb)
+{
+    uint32_t pos = bench_cb_size++;
+
+    while (pos > 0 && etimer_sub(cb->deadline, bench_cb_heap[(pos - 1) / 2]->deadline) < 0)
+    {
+        bench_cb_heap[pos] = bench_cb_heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    bench_cb_heap[pos] = cb;
+}
+
+static struct bench_cb *bench_cb_pop(void)
+{
+    struct bench_cb *top = bench_cb_heap[0];
+    struct bench_cb *last = bench_cb_heap[--bench_cb_size];
+    uint32_t pos = 0;
+
+    for (;;)
+    {
+        uint32_t child = pos * 2 + 1;
+        if (child >= bench_cb_size)
+        {
+            break;
+        }
+        if (child + 1 < bench_cb_size &&
+            etimer_sub(bench_cb_heap[child + 1]->deadline, bench_cb_heap[child]->deadline) < 0)
+        {
+            child++;
+        }
+        if (etimer_sub(bench_cb_heap[child]->deadline, last->deadline) >= 0)
+        {
+            break;
+        }
+        bench_cb_heap[pos] = bench_cb_heap[child];
+        pos = child;
+    }
+    bench_cb_heap[pos] = last;
+
+    return top;
+}
+
+static void bench_cb_step(struct bench_cb *cb, uint32_t now)
+{
+    uint32_t step = cb->step + 1;
+
+    free(cb);
+    if (step >= BENCH_LOOP_STEPS)
+    {
+        return;
+    }
+
+    cb = malloc(sizeof(*cb));
+    bench_loop_allocs++;
+    cb->deadline = etimer_add(now, 1 + bench_rand() % 1000);
+    cb->step = step;
+    cb->fn = bench_cb_step;
+    bench_cb_push(cb);
+}
+
+void bench_loop(void)
+{
+    struct etimer_loop loop;
+    uint32_t now = 0xFFFF0000;
+    uint32_t deadline;
+    uint64_t t0, switches = 0;
+    uint32_t i;
+
+    etimer_loop_init(&loop, sizeof(struct bench_flow), BENCH_LOOP_FLOWS, now);
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_LOOP_FLOWS; i++)
+    {
+        etimer_loop_spawn(&loop, bench_flow_fn);
+    }
+    do
+    {
+        switches += etimer_loop_run(&loop, now);
+        now = deadline;
+    } while (etimer_loop_next(&loop, &deadline));
+    bench_report("coroutine loop, per switch", switches, bench_now_ns() - t0);
+    printf("coroutine loop: %llu switches, %u frame allocations, 2 mallocs\n",
+           (unsigned long long)switches, loop.spawned);
+    etimer_loop_deinit(&loop);
+
+    now = 0xFFFF0000;
+    switches = 0;
+    bench_loop_allocs = 0;
+    bench_cb_size = 0;
+    bench_cb_heap = malloc(BENCH_LOOP_FLOWS * sizeof(*bench_cb_heap));
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_LOOP_FLOWS; i++)
+    {
+        struct bench_cb *cb = malloc(sizeof(*cb));
+        bench_loop_allocs++;
+        cb->deadline = now;
+        cb->step = 0;
+        cb->fn = bench_cb_step;
+        bench_cb_push(cb);
+    }
+    while (bench_cb_size)
+    {
+        now = bench_cb_heap[0]->deadline;
+        while (bench_cb_size && etimer_sub(bench_cb_heap[0]->deadline, now) <= 0)
+        {
+            struct bench_cb *cb = bench_cb_pop();
+            cb->fn(cb, now);
+            switches++;
+        }
+    }
+    bench_report("callback loop, per callback", switches, bench_now_ns() - t0);
+    printf("callback loop: %llu callbacks, %u mallocs\n", (unsigned long long)switches,
+           bench_loop_allocs);
+    free(bench_cb_heap);
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_min.h"
+
+/**
+ * @brief  Baseline: pairwise etimer_past_raw over the whole array. etimer_past_raw is true for
+ * equal times, so ties resolve to the last index here and only the values are compared.
+ */
+static size_t bench_min_scalar(const uint32_t *deadlines, size_t n, uint32_t overflow)
+{
+    size_t best = 0;
+    size_t i;
+
+    for (i = 1; i < n; i++)
+    {
+        if (etimer_past_raw(deadlines[i], deadlines[best], overflow))
+        {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+static void bench_min_size(size_t n, uint32_t max_value)
+{
+    uint32_t *deadlines = malloc(n * sizeof(*deadlines));
+    uint32_t now = bench_rand() & max_value;
+    uint32_t overflow = max_value >> 1;
+    uint32_t value;
+    size_t rounds = (64u * 1024 * 1024) / n;
+    size_t i, sum = 0;
+    uint64_t t0;
+    char name[64];
+
+    for (i = 0; i < n; i++)
+    {
+        // pending deadlines, all within overflow ahead of now
+        deadlines[i] = etimer_add_raw(now, bench_rand() % overflow, max_value);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < rounds; i++)
+    {
+        sum += deadlines[bench_min_scalar(deadlines, n, overflow)];
+    }
+    snprintf(name, sizeof(name), "min %7zu, 0x%08x, etimer_past_raw loop", n, max_value);
+    bench_report(name, rounds * n, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (i = 0; i < rounds; i++)
+    {
+        sum -= deadlines[etimer_min_raw(deadlines, n, now, overflow, max_value, &value)];
+    }
+    snprintf(name, sizeof(name), "min %7zu, 0x%08x, etimer_min_raw", n, max_value);
+    bench_report(name, rounds * n, bench_now_ns() - t0);
+
+    if (sum != 0)
+    {
+        printf("mismatch\n");
+    }
+    free(deadlines);
+}
+
+static void bench_min16_size(size_t n)
+{
+    uint16_t *deadlines = malloc(n * sizeof(*deadlines));
+    uint16_t now = (uint16_t)bench_rand();
+    uint16_t value;
+    size_t rounds = (64u * 1024 * 1024) / n;
+    size_t i, j, best, sum = 0;
+    uint64_t t0;
+    char name[64];
+
+    for (i = 0; i < n; i++)
+    {
+        deadlines[i] = etimer16_add(now, bench_rand() % ETIMER16_MAX_VALUE_OVERFLOW);
+    }
+
+    t0 = bench_now_ns();
+    for (i = 0; i < rounds; i++)
+    {
+        for (j = 1, best = 0; j < n; j++)
+        {
+            if (etimer16_past(deadlines[j], deadlines[best]))
+            {
+                best = j;
+            }
+        }
+        sum += deadlines[best];
+    }
+    snprintf(name, sizeof(name), "min16 %7zu, etimer16_past loop", n);
+    bench_report(name, rounds * n, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (i = 0; i < rounds; i++)
+    {
+        sum -= deadlines[etimer16_min(deadlines, n, now, &value)];
+    }
+    snprintf(name, sizeof(name), "min16 %7zu, etimer16_min", n);
+    bench_report(name, rounds * n, bench_now_ns() - t0);
+
+    if (sum != 0)
+    {
+        printf("mismatch\n");
+    }
+    free(deadlines);
+}
+
+void bench_min(void)
+{
+    static const size_t sizes[] = {64, 4096, 1024 * 1024};
+    size_t i;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        bench_min_size(sizes[i], ETIMER_MAX_VALUE);
+        bench_min_size(sizes[i], 0x00FFFFFF);
+        bench_min16_size(sizes[i]);
+    }
+}
@@ -0,0 +1,56 @@
+#include <stdio.h>
+
+#include "bench.h"
+#include "etimer_prof.h"
+
+#define BENCH_PROF_ROUNDS (4u * 1024 * 1024)
+
+static uint32_t bench_prof_ns(void)
+{
+    return (uint32_t)bench_now_ns();
+}
+
+static void bench_prof_clock(const char *label)
+{
+    volatile uint32_t sink = 0;
+    char name[64];
+    uint64_t t0;
+    uint32_t i;
+
+    etimer_prof_thread_init();
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_PROF_ROUNDS; i++)
+    {
+        ETIMER_PROF_BEGIN(bench_begin_end);
+        sink += i;
+        ETIMER_PROF_END(bench_begin_end);
+    }
+    snprintf(name, sizeof(name), "%s, begin/end", label);
+    bench_report(name, BENCH_PROF_ROUNDS, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_PROF_ROUNDS; i++)
+    {
+        ETIMER_PROF_SCOPE(bench_scope);
+        sink += i;
+    }
+    snprintf(name, sizeof(name), "%s, scope", label);
+    bench_report(name, BENCH_PROF_ROUNDS, bench_now_ns() - t0);
+
+    snprintf(name, sizeof(name), "%s, etimer_prof_overhead", label);
+    bench_report_value(name, etimer_prof_overhead(BENCH_PROF_ROUNDS), "ticks");
+}
+
+void bench_prof(void)
+{
+    bench_prof_clock("tsc");
+    etimer_prof_report(stdout);
+    etimer_prof_reset();
+
+    etimer_prof_set_clock(bench_prof_ns, ETIMER_MAX_VALUE);
+    bench_prof_clock("ns ");
+    etimer_prof_report(stdout);
+    etimer_prof_reset();
+    etimer_prof_set_clock(NULL, 0);
+}
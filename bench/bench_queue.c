@@ -0,0 +1,115 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_queue.h"
+
+#define BENCH_QUEUE_SIZE  4096
+#define BENCH_QUEUE_TOTAL (4u << 20) /* split over the producers */
+#define BENCH_QUEUE_BATCH 256
+
+static struct etimer_queue bench_queue_q;
+static uint32_t bench_queue_full;
+static uint32_t bench_queue_per;
+static uint32_t *bench_queue_lat; /* ns, per push */
+
+static int bench_queue_cmp(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void *bench_queue_producer(void *arg)
+{
+    uint32_t self = (uint32_t)(uintptr_t)arg;
+    uint32_t *lat = bench_queue_lat + (size_t)self * bench_queue_per;
+    uint32_t full = 0;
+    uint32_t i;
+
+    for (i = 0; i < bench_queue_per; i++)
+    {
+        uint64_t t0 = bench_now_ns();
+        int ret = etimer_queue_push(&bench_queue_q, i & 1, self, (uint32_t)t0);
+        lat[i] = (uint32_t)(bench_now_ns() - t0);
+        if (ret != 0)
+        {
+            // full, let the consumer run when cores are scarce
+            full++;
+            i--;
+            sched_yield();
+        }
+    }
+
+    __atomic_fetch_add(&bench_queue_full, full, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+static void bench_queue_run(uint32_t producers)
+{
+    struct etimer_queue_req reqs[BENCH_QUEUE_BATCH];
+    uint64_t total = (uint64_t)producers * (BENCH_QUEUE_TOTAL / producers);
+    uint64_t taken = 0, batches = 0, t0, ns;
+    size_t count = (size_t)total;
+    pthread_t tid[64];
+    char name[64];
+    uint32_t i;
+
+    etimer_queue_init(&bench_queue_q, BENCH_QUEUE_SIZE);
+    bench_queue_full = 0;
+    bench_queue_per = BENCH_QUEUE_TOTAL / producers;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < producers; i++)
+    {
+        pthread_create(&tid[i], NULL, bench_queue_producer, (void *)(uintptr_t)i);
+    }
+    while (taken < total)
+    {
+        size_t n = etimer_queue_drain(&bench_queue_q, reqs, BENCH_QUEUE_BATCH);
+        taken += n;
+        batches += n != 0;
+        if (n == 0)
+        {
+            sched_yield();
+        }
+    }
+    ns = bench_now_ns() - t0;
+    for (i = 0; i < producers; i++)
+    {
+        pthread_join(tid[i], NULL);
+    }
+
+    snprintf(name, sizeof(name), "%2u producers, drain", producers);
+    bench_report(name, total, ns);
+    snprintf(name, sizeof(name), "%2u producers, mean batch", producers);
+    bench_report_value(name, (double)taken / batches, "reqs");
+
+    qsort(bench_queue_lat, count, sizeof(*bench_queue_lat), bench_queue_cmp);
+    snprintf(name, sizeof(name), "%2u producers, push p50", producers);
+    bench_report_value(name, bench_queue_lat[count / 2], "ns");
+    snprintf(name, sizeof(name), "%2u producers, push p99", producers);
+    bench_report_value(name, bench_queue_lat[count / 100 * 99], "ns");
+    snprintf(name, sizeof(name), "%2u producers, push p999", producers);
+    bench_report_value(name, bench_queue_lat[count / 1000 * 999], "ns");
+    snprintf(name, sizeof(name), "%2u producers, queue full", producers);
+    bench_report_value(name, 100.0 * bench_queue_full / (total + bench_queue_full), "%");
+
+    etimer_queue_deinit(&bench_queue_q);
+}
+
+void bench_queue(void)
+{
+    uint32_t producers;
+
+    bench_queue_lat = malloc(BENCH_QUEUE_TOTAL * sizeof(*bench_queue_lat));
+    // latencies include one clock read
+    for (producers = 1; producers <= 16; producers *= 2)
+    {
+        bench_queue_run(producers);
+    }
+    free(bench_queue_lat);
+}
@@ -0,0 +1,768 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "etimer_service.h"
+#include "etimer_sorted.h"
+
+//
+// Workload replay: synthetic timer traffic driven through any timer structure behind
+// struct bench_replay_timers. Every structure sees the same operation stream for a workload,
+// as long as it expires the same timers. A shadow copy of the armed deadlines checks every
+// expiry, and each run starts shortly before the time domain wraps.
+//
+
+#define BENCH_REPLAY_NONE  (~(uint32_t)0)
+#define BENCH_REPLAY_CHUNK 256
+
+/**
+ * Timer structure under test, handles are chosen by the caller below capacity.
+ */
+struct bench_replay_timers
+{
+    const char *name;
+    int (*init)(uint32_t capacity, uint32_t max_value);
+    void (*deinit)(void);
+    void (*arm)(uint32_t handle, uint32_t now, uint32_t deadline); /* re-arms if pending */
+    void (*cancel)(uint32_t handle);
+    size_t (*expire)(uint32_t now, uint32_t *handles, size_t max);
+    int (*next)(uint32_t *deadline);
+    size_t (*memory)(void); /* bytes held */
+};
+
+//
+// Latency histogram, exact below 64 ns then 16 buckets per power of 2.
+//
+#define BENCH_REPLAY_SUB     16
+#define BENCH_REPLAY_BUCKETS (64 + 26 * BENCH_REPLAY_SUB)
+
+struct bench_replay_run
+{
+    const struct bench_replay_timers *timers;
+    uint32_t max_value;
+    uint32_t overflow;
+    uint32_t capacity;
+    uint32_t *shadow;  /* armed deadline per handle */
+    uint8_t *pending;  /* per handle, any deadline is valid so armed is kept apart */
+    uint32_t now;
+    uint32_t wraps;
+    uint64_t ops;
+    uint64_t ns;
+    uint64_t errors; /* early, stale or missed expiries */
+    size_t memory_peak;
+    uint32_t armed;
+    uint32_t armed_peak;
+    uint64_t hist[BENCH_REPLAY_BUCKETS];
+    void (*on_expire)(struct bench_replay_run *run, uint32_t handle);
+};
+
+static uint64_t bench_replay_overhead;
+
+static uint32_t bench_replay_bucket(uint64_t ns)
+{
+    uint32_t log = 6;
+
+    if (ns < 64)
+    {
+        return (uint32_t)ns;
+    }
+    while (log < 31 && (ns >> (log + 1)) != 0)
+    {
+        log++;
+    }
+    if (ns >> (log + 1))
+    {
+        return BENCH_REPLAY_BUCKETS - 1;
+    }
+    return 64 + (log - 6) * BENCH_REPLAY_SUB +
+           (uint32_t)((ns - (1ull << log)) >> (log - 4));
+}
+
+static uint64_t bench_replay_bucket_ns(uint32_t bucket)
+{
+    uint32_t log;
+
+    if (bucket < 64)
+    {
+        return bucket;
+    }
+    log = 6 + (bucket - 64) / BENCH_REPLAY_SUB;
+    return (1ull << log) + ((uint64_t)((bucket - 64) % BENCH_REPLAY_SUB) << (log - 4));
+}
+
+static uint64_t bench_replay_percentile(const struct bench_replay_run *run, double p)
+{
+    uint64_t want = (uint64_t)(run->ops * p), seen = 0;
+    uint32_t i;
+
+    for (i = 0; i < BENCH_REPLAY_BUCKETS; i++)
+    {
+        seen += run->hist[i];
+        if (seen > want)
+        {
+            return bench_replay_bucket_ns(i);
+        }
+    }
+    return bench_replay_bucket_ns(BENCH_REPLAY_BUCKETS - 1);
+}
+
+static inline void bench_replay_account(struct bench_replay_run *run, uint64_t t0, uint64_t t1)
+{
+    uint64_t ns = t1 - t0;
+
+    ns = ns > bench_replay_overhead ? ns - bench_replay_overhead : 0;
+    run->hist[bench_replay_bucket(ns)]++;
+    run->ns += ns;
+    run->ops++;
+}
+
+static void bench_replay_arm(struct bench_replay_run *run, uint32_t handle, uint32_t deadline)
+{
+    uint64_t t0 = bench_now_ns();
+
+    run->timers->arm(handle, run->now, deadline);
+    bench_replay_account(run, t0, bench_now_ns());
+
+    run->armed += !run->pending[handle];
+    run->armed_peak = run->armed > run->armed_peak ? run->armed : run->armed_peak;
+    run->shadow[handle] = deadline;
+    run->pending[handle] = 1;
+}
+
+static void bench_replay_cancel(struct bench_replay_run *run, uint32_t handle)
+{
+    uint64_t t0 = bench_now_ns();
+
+    run->timers->cancel(handle);
+    bench_replay_account(run, t0, bench_now_ns());
+
+    run->armed -= run->pending[handle];
+    run->pending[handle] = 0;
+}
+
+static void bench_replay_advance(struct bench_replay_run *run, uint32_t now)
+{
+    // forward only, counting wraps of the domain
+    run->wraps += now < run->now;
+    run->now = now;
+}
+
+/**
+ * @brief  Expire everything due at now, check each timer against the shadow and hand it to the
+ * workload.
+ */
+static void bench_replay_poll(struct bench_replay_run *run)
+{
+    uint32_t handles[BENCH_REPLAY_CHUNK], handle, deadline;
+    size_t n, i;
+    uint64_t t0;
+    size_t memory;
+
+    do
+    {
+        t0 = bench_now_ns();
+        n = run->timers->expire(run->now, handles, BENCH_REPLAY_CHUNK);
+        bench_replay_account(run, t0, bench_now_ns());
+
+        for (i = 0; i < n; i++)
+        {
+            handle = handles[i];
+            deadline = run->shadow[handle];
+            if (!run->pending[handle] ||
+                etimer_sub_raw(run->now, deadline, run->overflow, run->max_value) < 0)
+            {
+                run->errors++;
+                continue;
+            }
+            run->pending[handle] = 0;
+            run->armed--;
+            run->on_expire(run, handle);
+        }
+    } while (n == BENCH_REPLAY_CHUNK);
+
+    memory = run->timers->memory();
+    run->memory_peak = memory > run->memory_peak ? memory : run->memory_peak;
+}
+
+//
+// Baseline: indexed binary heap ordered by etimer_past_raw().
+//
+static struct etimer_sorted_entry *bench_heap;
+static uint32_t *bench_heap_pos;
+static uint32_t bench_heap_size;
+static uint32_t bench_heap_cap;
+static uint32_t bench_heap_overflow;
+
+static inline int bench_heap_before(uint32_t a, uint32_t b)
+{
+    return a != b && etimer_past_raw(a, b, bench_heap_overflow);
+}
+
+static inline void bench_heap_set(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    bench_heap[pos] = entry;
+    bench_heap_pos[entry.handle] = pos;
+}
+
+static void bench_heap_up(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    while (pos > 0 && bench_heap_before(entry.deadline, bench_heap[(pos - 1) / 2].deadline))
+    {
+        bench_heap_set(pos, bench_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    bench_heap_set(pos, entry);
+}
+
+static void bench_heap_down(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    uint32_t child;
+
+    while ((child = pos * 2 + 1) < bench_heap_size)
+    {
+        if (child + 1 < bench_heap_size &&
+            bench_heap_before(bench_heap[child + 1].deadline, bench_heap[child].deadline))
+        {
+            child++;
+        }
+        if (!bench_heap_before(bench_heap[child].deadline, entry.deadline))
+        {
+            break;
+        }
+        bench_heap_set(pos, bench_heap[child]);
+        pos = child;
+    }
+    bench_heap_set(pos, entry);
+}
+
+static void bench_heap_remove(uint32_t handle)
+{
+    uint32_t pos = bench_heap_pos[handle];
+    struct etimer_sorted_entry last;
+
+    if (pos == BENCH_REPLAY_NONE)
+    {
+        return;
+    }
+    bench_heap_pos[handle] = BENCH_REPLAY_NONE;
+    last = bench_heap[--bench_heap_size];
+    if (pos == bench_heap_size)
+    {
+        return;
+    }
+    if (pos > 0 && bench_heap_before(last.deadline, bench_heap[(pos - 1) / 2].deadline))
+    {
+        bench_heap_up(pos, last);
+    }
+    else
+    {
+        bench_heap_down(pos, last);
+    }
+}
+
+static int bench_heap_init(uint32_t capacity, uint32_t max_value)
+{
+    bench_heap = malloc((size_t)capacity * sizeof(*bench_heap));
+    bench_heap_pos = malloc((size_t)capacity * sizeof(*bench_heap_pos));
+    if (bench_heap == NULL || bench_heap_pos == NULL)
+    {
+        return -1;
+    }
+    memset(bench_heap_pos, 0xFF, (size_t)capacity * sizeof(*bench_heap_pos));
+    bench_heap_size = 0;
+    bench_heap_cap = capacity;
+    bench_heap_overflow = max_value >> 1;
+    return 0;
+}
+
+static void bench_heap_deinit(void)
+{
+    free(bench_heap);
+    free(bench_heap_pos);
+}
+
+static void bench_heap_arm(uint32_t handle, uint32_t now, uint32_t deadline)
+{
+    struct etimer_sorted_entry entry = {deadline, handle};
+
+    (void)now;
+    bench_heap_remove(handle);
+    bench_heap_up(bench_heap_size++, entry);
+}
+
+static size_t bench_heap_expire(uint32_t now, uint32_t *handles, size_t max)
+{
+    size_t n = 0;
+
+    while (n < max && bench_heap_size && !bench_heap_before(now, bench_heap[0].deadline))
+    {
+        handles[n] = bench_heap[0].handle;
+        bench_heap_remove(handles[n++]);
+    }
+    return n;
+}
+
+static int bench_heap_next(uint32_t *deadline)
+{
+    if (bench_heap_size == 0)
+    {
+        return 0;
+    }
+    *deadline = bench_heap[0].deadline;
+    return 1;
+}
+
+static size_t bench_heap_memory(void)
+{
+    return (size_t)bench_heap_cap * (sizeof(*bench_heap) + sizeof(*bench_heap_pos));
+}
+
+static const struct bench_replay_timers bench_replay_heap = {
+        "heap",           bench_heap_init,   bench_heap_deinit, bench_heap_arm,
+        bench_heap_remove, bench_heap_expire, bench_heap_next,   bench_heap_memory,
+};
+
+//
+// etimer_sorted, one timer per batch.
+//
+static struct etimer_sorted bench_sorted_set;
+
+static int bench_sorted_init(uint32_t capacity, uint32_t max_value)
+{
+    // slack for stale copies, a full array compacts on every arm
+    return etimer_sorted_init(&bench_sorted_set, capacity * 2, max_value);
+}
+
+static void bench_sorted_deinit(void)
+{
+    etimer_sorted_deinit(&bench_sorted_set);
+}
+
+static void bench_sorted_arm(uint32_t handle, uint32_t now, uint32_t deadline)
+{
+    struct etimer_sorted_entry entry = {deadline, handle};
+
+    etimer_sorted_arm(&bench_sorted_set, now, &entry, 1);
+}
+
+static void bench_sorted_cancel(uint32_t handle)
+{
+    etimer_sorted_cancel(&bench_sorted_set, &handle, 1);
+}
+
+static size_t bench_sorted_expire(uint32_t now, uint32_t *handles, size_t max)
+{
+    return etimer_sorted_expire(&bench_sorted_set, now, handles, max);
+}
+
+static int bench_sorted_next(uint32_t *deadline)
+{
+    return etimer_sorted_next(&bench_sorted_set, deadline);
+}
+
+static size_t bench_sorted_memory(void)
+{
+    return (size_t)bench_sorted_set.capacity *
+           (2 * sizeof(struct etimer_sorted_slot) + sizeof(uint32_t) +
+            2 * sizeof(struct etimer_sorted_key));
+}
+
+static const struct bench_replay_timers bench_replay_sorted = {
+        "etimer_sorted",     bench_sorted_init,   bench_sorted_deinit,
+        bench_sorted_arm,    bench_sorted_cancel, bench_sorted_expire,
+        bench_sorted_next,   bench_sorted_memory,
+};
+
+//
+// etimer_service, a single shard polled by the replay thread, 32-bit domain only.
+//
+static struct etimer_service bench_svc;
+static struct etimer_service_timer *bench_svc_timers;
+static uint32_t bench_svc_capacity;
+static uint32_t *bench_svc_out;
+static size_t bench_svc_out_n;
+
+static void bench_svc_cb(struct etimer_service_timer *timer, void *arg)
+{
+    (void)arg;
+    bench_svc_out[bench_svc_out_n++] = (uint32_t)(timer - bench_svc_timers);
+}
+
+static int bench_svc_init(uint32_t capacity, uint32_t max_value)
+{
+    uint32_t i;
+
+    if (max_value != ETIMER_MAX_VALUE || etimer_service_init(&bench_svc, 1) != 0)
+    {
+        return -1;
+    }
+    bench_svc_timers = malloc((size_t)capacity * sizeof(*bench_svc_timers));
+    if (bench_svc_timers == NULL)
+    {
+        etimer_service_deinit(&bench_svc);
+        return -1;
+    }
+    for (i = 0; i < capacity; i++)
+    {
+        etimer_service_timer_init(&bench_svc_timers[i], bench_svc_cb, NULL);
+    }
+    bench_svc_capacity = capacity;
+    return 0;
+}
+
+static void bench_svc_deinit(void)
+{
+    etimer_service_deinit(&bench_svc);
+    free(bench_svc_timers);
+}
+
+static void bench_svc_arm(uint32_t handle, uint32_t now, uint32_t deadline)
+{
+    (void)now;
+    etimer_service_cancel(&bench_svc, 0, &bench_svc_timers[handle]);
+    etimer_service_start(&bench_svc, 0, &bench_svc_timers[handle], 0, deadline);
+}
+
+static void bench_svc_cancel(uint32_t handle)
+{
+    etimer_service_cancel(&bench_svc, 0, &bench_svc_timers[handle]);
+}
+
+static size_t bench_svc_expire(uint32_t now, uint32_t *handles, size_t max)
+{
+    bench_svc_out = handles;
+    bench_svc_out_n = 0;
+    etimer_service_poll(&bench_svc, 0, now, (uint32_t)max);
+    return bench_svc_out_n;
+}
+
+static int bench_svc_next(uint32_t *deadline)
+{
+    return etimer_service_next(&bench_svc, 0, deadline);
+}
+
+static size_t bench_svc_memory(void)
+{
+    return sizeof(struct etimer_service_shard) +
+           (size_t)bench_svc.shards[0].heap_cap * sizeof(struct etimer_service_timer *) +
+           (size_t)bench_svc_capacity * sizeof(struct etimer_service_timer);
+}
+
+static const struct bench_replay_timers bench_replay_service = {
+        "etimer_service",  bench_svc_init,   bench_svc_deinit, bench_svc_arm,
+        bench_svc_cancel,  bench_svc_expire, bench_svc_next,   bench_svc_memory,
+};
+
+static const struct bench_replay_timers *const bench_replay_structures[] = {
+        &bench_replay_heap,
+        &bench_replay_sorted,
+        &bench_replay_service,
+};
+
+//
+// BLE: periodic connection events on a 28-bit microsecond counter. Each event re-arms one
+// interval after the previous anchor, one event in 100 also renegotiates another connection.
+//
+#define BENCH_BLE_MAX    0x0FFFFFFF
+#define BENCH_BLE_CONNS  10000
+#define BENCH_BLE_EVENTS (2u * 1024 * 1024)
+
+static uint32_t *bench_ble_interval;
+static uint32_t bench_ble_events;
+
+static uint32_t bench_ble_new_interval(void)
+{
+    // 7.5 ms to 4 s in 1.25 ms units
+    return 1250 * (6 + bench_rand() % 3195);
+}
+
+static void bench_ble_expire(struct bench_replay_run *run, uint32_t handle)
+{
+    uint32_t other, deadline;
+
+    bench_ble_events++;
+    deadline = etimer_add_raw(run->now, (int32_t)bench_ble_interval[handle], run->max_value);
+    bench_replay_arm(run, handle, deadline);
+
+    if (bench_rand() % 100 == 0)
+    {
+        other = bench_rand() % BENCH_BLE_CONNS;
+        bench_replay_cancel(run, other);
+        bench_ble_interval[other] = bench_ble_new_interval();
+        bench_replay_arm(run, other,
+                         etimer_add_raw(run->now, (int32_t)bench_ble_interval[other],
+                                        run->max_value));
+    }
+}
+
+static void bench_ble_run(struct bench_replay_run *run)
+{
+    uint32_t i, next;
+
+    bench_ble_interval = malloc(BENCH_BLE_CONNS * sizeof(*bench_ble_interval));
+    bench_ble_events = 0;
+    run->on_expire = bench_ble_expire;
+    for (i = 0; i < BENCH_BLE_CONNS; i++)
+    {
+        bench_ble_interval[i] = bench_ble_new_interval();
+        bench_replay_arm(run, i,
+                         etimer_add_raw(run->now, (int32_t)(1 + bench_rand() % 4000000),
+                                        run->max_value));
+    }
+
+    // event driven, time jumps to the next anchor
+    while (bench_ble_events < BENCH_BLE_EVENTS && run->timers->next(&next))
+    {
+        bench_replay_advance(run, next);
+        bench_replay_poll(run);
+    }
+    free(bench_ble_interval);
+}
+
+//
+// TCP retransmit: a send arms the connection's RTO, the ACK cancels it about 26 ms later. One
+// segment in 100 is lost, its RTO fires and the retransmission is armed with the timeout doubled.
+//
+#define BENCH_TCP_CONNS  100000
+#define BENCH_TCP_STEPS  40000
+#define BENCH_TCP_STEP   100 /* microseconds */
+#define BENCH_TCP_RATE   50  /* sends per step */
+#define BENCH_TCP_RTT    8   /* one outstanding segment in 1 << 8 is acked per step */
+#define BENCH_TCP_RTO    200000
+
+static uint32_t *bench_tcp_pool; /* idle first, then ackable outstanding */
+static uint32_t *bench_tcp_pos;
+static uint32_t bench_tcp_idle; /* idle connections at the front of the pool */
+static uint32_t bench_tcp_ackable;
+static uint32_t *bench_tcp_rto;
+
+static void bench_tcp_swap(uint32_t a, uint32_t b)
+{
+    uint32_t ha = bench_tcp_pool[a], hb = bench_tcp_pool[b];
+
+    bench_tcp_pool[a] = hb;
+    bench_tcp_pos[hb] = a;
+    bench_tcp_pool[b] = ha;
+    bench_tcp_pos[ha] = b;
+}
+
+/**
+ * @brief  Pool layout: [idle | ackable | lost], moves keep the three ranges contiguous.
+ */
+static void bench_tcp_to_ackable_from_idle(uint32_t handle)
+{
+    bench_tcp_swap(bench_tcp_pos[handle], bench_tcp_idle - 1);
+    bench_tcp_idle--;
+    bench_tcp_ackable++;
+}
+
+static void bench_tcp_to_idle_from_ackable(uint32_t handle)
+{
+    bench_tcp_swap(bench_tcp_pos[handle], bench_tcp_idle);
+    bench_tcp_idle++;
+    bench_tcp_ackable--;
+}
+
+static void bench_tcp_to_lost_from_ackable(uint32_t handle)
+{
+    bench_tcp_swap(bench_tcp_pos[handle], bench_tcp_idle + bench_tcp_ackable - 1);
+    bench_tcp_ackable--;
+}
+
+static void bench_tcp_to_ackable_from_lost(uint32_t handle)
+{
+    bench_tcp_swap(bench_tcp_pos[handle], bench_tcp_idle + bench_tcp_ackable);
+    bench_tcp_ackable++;
+}
+
+static void bench_tcp_expire(struct bench_replay_run *run, uint32_t handle)
+{
+    // retransmit, this copy gets through, the ACK of a spurious one is still due
+    bench_tcp_rto[handle] = bench_tcp_rto[handle] < 8 * BENCH_TCP_RTO ? bench_tcp_rto[handle] * 2
+                                                                      : bench_tcp_rto[handle];
+    bench_replay_arm(run, handle, etimer_add(run->now, (int32_t)bench_tcp_rto[handle]));
+    if (bench_tcp_pos[handle] >= bench_tcp_idle + bench_tcp_ackable)
+    {
+        bench_tcp_to_ackable_from_lost(handle);
+    }
+}
+
+static void bench_tcp_run(struct bench_replay_run *run)
+{
+    uint32_t step, i, acks, handle;
+
+    bench_tcp_pool = malloc(BENCH_TCP_CONNS * sizeof(*bench_tcp_pool));
+    bench_tcp_pos = malloc(BENCH_TCP_CONNS * sizeof(*bench_tcp_pos));
+    bench_tcp_rto = malloc(BENCH_TCP_CONNS * sizeof(*bench_tcp_rto));
+    for (i = 0; i < BENCH_TCP_CONNS; i++)
+    {
+        bench_tcp_pool[i] = i;
+        bench_tcp_pos[i] = i;
+    }
+    bench_tcp_idle = BENCH_TCP_CONNS;
+    bench_tcp_ackable = 0;
+    run->on_expire = bench_tcp_expire;
+
+    for (step = 0; step < BENCH_TCP_STEPS; step++)
+    {
+        bench_replay_advance(run, run->now + BENCH_TCP_STEP);
+        for (i = 0; i < BENCH_TCP_RATE && bench_tcp_idle; i++)
+        {
+            handle = bench_tcp_pool[bench_rand() % bench_tcp_idle];
+            bench_tcp_rto[handle] = BENCH_TCP_RTO;
+            bench_replay_arm(run, handle, etimer_add(run->now, BENCH_TCP_RTO));
+            bench_tcp_to_ackable_from_idle(handle);
+            if (bench_rand() % 100 == 0)
+            {
+                bench_tcp_to_lost_from_ackable(handle);
+            }
+        }
+        acks = (bench_tcp_ackable + (1u << (BENCH_TCP_RTT - 1))) >> BENCH_TCP_RTT;
+        for (i = 0; i < acks; i++)
+        {
+            handle = bench_tcp_pool[bench_tcp_idle + bench_rand() % bench_tcp_ackable];
+            bench_replay_cancel(run, handle);
+            bench_tcp_to_idle_from_ackable(handle);
+        }
+        bench_replay_poll(run);
+    }
+
+    free(bench_tcp_pool);
+    free(bench_tcp_pos);
+    free(bench_tcp_rto);
+}
+
+//
+// Mass idle timeouts: every packet re-arms its connection's idle timer, one connection in 8 is
+// silent and times out, then reconnects.
+//
+#define BENCH_IDLE_CONNS   200000
+#define BENCH_IDLE_STEPS   20000
+#define BENCH_IDLE_STEP    1000 /* microseconds */
+#define BENCH_IDLE_RATE    200  /* packets per step */
+#define BENCH_IDLE_TIMEOUT 5000000
+
+static void bench_idle_expire(struct bench_replay_run *run, uint32_t handle)
+{
+    bench_replay_arm(run, handle, etimer_add(run->now, BENCH_IDLE_TIMEOUT));
+}
+
+static void bench_idle_run(struct bench_replay_run *run)
+{
+    uint32_t step, i, handle;
+
+    run->on_expire = bench_idle_expire;
+    for (i = 0; i < BENCH_IDLE_CONNS; i++)
+    {
+        bench_replay_arm(run, i, etimer_add(run->now, BENCH_IDLE_TIMEOUT));
+    }
+
+    for (step = 0; step < BENCH_IDLE_STEPS; step++)
+    {
+        bench_replay_advance(run, run->now + BENCH_IDLE_STEP);
+        for (i = 0; i < BENCH_IDLE_RATE; i++)
+        {
+            handle = bench_rand() % BENCH_IDLE_CONNS;
+            handle = handle % 8 ? handle : handle + 1;
+            bench_replay_arm(run, handle, etimer_add(run->now, BENCH_IDLE_TIMEOUT));
+        }
+        bench_replay_poll(run);
+    }
+}
+
+struct bench_replay_workload
+{
+    const char *name;
+    uint32_t max_value;
+    uint32_t capacity;
+    uint32_t lead; /* ticks before the wrap at start */
+    void (*run)(struct bench_replay_run *run);
+};
+
+static const struct bench_replay_workload bench_replay_workloads[] = {
+        {"ble 28-bit", BENCH_BLE_MAX, BENCH_BLE_CONNS, 2000000, bench_ble_run},
+        {"tcp rto", ETIMER_MAX_VALUE, BENCH_TCP_CONNS, 1000000, bench_tcp_run},
+        {"idle", ETIMER_MAX_VALUE, BENCH_IDLE_CONNS, 1000000, bench_idle_run},
+};
+
+static void bench_replay_calibrate(void)
+{
+    uint64_t best = ~(uint64_t)0, t0, t1;
+    uint32_t i;
+
+    for (i = 0; i < 100000; i++)
+    {
+        t0 = bench_now_ns();
+        t1 = bench_now_ns();
+        best = t1 - t0 < best ? t1 - t0 : best;
+    }
+    bench_replay_overhead = best;
+}
+
+static void bench_replay_one(const struct bench_replay_workload *work,
+                             const struct bench_replay_timers *timers)
+{
+    static struct bench_replay_run run;
+    char name[96];
+    uint32_t i, next;
+
+    memset(&run, 0, sizeof(run));
+    run.timers = timers;
+    run.max_value = work->max_value;
+    run.overflow = work->max_value >> 1;
+    run.capacity = work->capacity;
+    run.now = work->max_value - work->lead;
+    if (timers->init(work->capacity, work->max_value) != 0)
+    {
+        printf("  %s, %s: not applicable\n", work->name, timers->name);
+        return;
+    }
+    run.shadow = malloc((size_t)work->capacity * sizeof(*run.shadow));
+    run.pending = calloc(work->capacity, sizeof(*run.pending));
+
+    work->run(&run);
+
+    // nothing due may be left behind
+    if (timers->next(&next) &&
+        etimer_sub_raw(run.now, next, run.overflow, run.max_value) >= 0)
+    {
+        run.errors++;
+    }
+    for (i = 0; i < work->capacity; i++)
+    {
+        run.errors += run.pending[i] &&
+                      etimer_sub_raw(run.now, run.shadow[i], run.overflow, run.max_value) > 0;
+    }
+
+    snprintf(name, sizeof(name), "%s, %s", work->name, timers->name);
+    bench_report(name, run.ops, run.ns);
+    printf("      p50 %llu ns, p99 %llu ns, p999 %llu ns, peak %.1f B/timer (%u armed), "
+           "%u wraps, %llu errors\n",
+           (unsigned long long)bench_replay_percentile(&run, 0.50),
+           (unsigned long long)bench_replay_percentile(&run, 0.99),
+           (unsigned long long)bench_replay_percentile(&run, 0.999),
+           (double)run.memory_peak / run.armed_peak, run.armed_peak, run.wraps,
+           (unsigned long long)run.errors);
+
+    timers->deinit();
+    free(run.shadow);
+    free(run.pending);
+}
+
+void bench_replay(void)
+{
+    size_t w, t;
+
+    bench_replay_calibrate();
+    printf("(op = arm, cancel or expire call, clock overhead of %llu ns removed)\n",
+           (unsigned long long)bench_replay_overhead);
+    for (w = 0; w < sizeof(bench_replay_workloads) / sizeof(bench_replay_workloads[0]); w++)
+    {
+        for (t = 0; t < sizeof(bench_replay_structures) / sizeof(bench_replay_structures[0]);
+             t++)
+        {
+            bench_replay_one(&bench_replay_workloads[w], bench_replay_structures[t]);
+        }
+    }
+}
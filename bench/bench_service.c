@@ -0,0 +1,249 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_service.h"
+
+#define BENCH_SERVICE_TIMERS (2u * 1024 * 1024)
+#define BENCH_SERVICE_BATCH  256
+#define BENCH_SERVICE_SPREAD 1000 /* us */
+
+static struct etimer_service bench_svc;
+static struct etimer_service_timer *bench_service_timers;
+static uint32_t bench_service_threads;
+static uint32_t bench_service_done;
+
+static inline uint32_t bench_service_now(void)
+{
+    return (uint32_t)(bench_now_ns() / 1000);
+}
+
+static void bench_service_cb(struct etimer_service_timer *timer, void *arg)
+{
+    __atomic_fetch_add(&bench_service_done, 1, __ATOMIC_RELAXED);
+}
+
+static void *bench_service_worker(void *arg)
+{
+    uint32_t self = (uint32_t)(uintptr_t)arg;
+    uint32_t per = BENCH_SERVICE_TIMERS / bench_service_threads;
+    uint32_t neighbour = (self + 1) % bench_service_threads;
+    uint32_t seed = self * 2654435761u + 1;
+    uint32_t i;
+
+    for (i = 0; i < per; i++)
+    {
+        seed = seed * 1103515245u + 12345;
+        etimer_service_start(&bench_svc, self, &bench_service_timers[self * per + i], self,
+                             bench_service_now() + (seed >> 8) % BENCH_SERVICE_SPREAD);
+
+        // cross-core cancel of every 8th timer
+        if (i % 8 == 7 && etimer_service_cancel(&bench_svc, self,
+                                                &bench_service_timers[neighbour * per + i]) == 0)
+        {
+            __atomic_fetch_add(&bench_service_done, 1, __ATOMIC_RELAXED);
+        }
+
+        if (i % BENCH_SERVICE_BATCH == 0)
+        {
+            etimer_service_poll(&bench_svc, self, bench_service_now(), BENCH_SERVICE_BATCH);
+        }
+    }
+
+    while (__atomic_load_n(&bench_service_done, __ATOMIC_RELAXED) < per * bench_service_threads)
+    {
+        etimer_service_poll(&bench_svc, self, bench_service_now(), BENCH_SERVICE_BATCH);
+    }
+
+    return NULL;
+}
+
+//
+// Baseline: one heap behind one mutex.
+//
+struct bench_global_timer
+{
+    uint32_t deadline;
+    uint32_t pos;
+};
+
+static pthread_mutex_t bench_global_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct bench_global_timer *bench_global_timers;
+static uint32_t *bench_global_heap;
+static uint32_t bench_global_size;
+
+#define BENCH_GLOBAL_NO_POS (~(uint32_t)0)
+
+static inline int bench_global_before(uint32_t a, uint32_t b)
+{
+    return etimer_past(bench_global_timers[a].deadline, bench_global_timers[b].deadline) &&
+           bench_global_timers[a].deadline != bench_global_timers[b].deadline;
+}
+
+static void bench_global_set(uint32_t pos, uint32_t id)
+{
+    bench_global_heap[pos] = id;
+    bench_global_timers[id].pos = pos;
+}
+
+static void bench_global_fix(uint32_t pos)
+{
+    uint32_t id = bench_global_heap[pos];
+
+    while (pos > 0 && bench_global_before(id, bench_global_heap[(pos - 1) / 2]))
+    {
+        bench_global_set(pos, bench_global_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    for (;;)
+    {
+        uint32_t child = pos * 2 + 1;
+        if (child >= bench_global_size)
+        {
+            break;
+        }
+        if (child + 1 < bench_global_size &&
+            bench_global_before(bench_global_heap[child + 1], bench_global_heap[child]))
+        {
+            child++;
+        }
+        if (!bench_global_before(bench_global_heap[child], id))
+        {
+            break;
+        }
+        bench_global_set(pos, bench_global_heap[child]);
+        pos = child;
+    }
+    bench_global_set(pos, id);
+}
+
+static void bench_global_remove(uint32_t id)
+{
+    uint32_t pos = bench_global_timers[id].pos;
+    uint32_t last = bench_global_heap[--bench_global_size];
+
+    bench_global_timers[id].pos = BENCH_GLOBAL_NO_POS;
+    if (last != id)
+    {
+        bench_global_set(pos, last);
+        bench_global_fix(pos);
+    }
+}
+
+static void *bench_global_worker(void *arg)
+{
+    uint32_t self = (uint32_t)(uintptr_t)arg;
+    uint32_t per = BENCH_SERVICE_TIMERS / bench_service_threads;
+    uint32_t neighbour = (self + 1) % bench_service_threads;
+    uint32_t seed = self * 2654435761u + 1;
+    uint32_t i;
+
+    for (i = 0;; i++)
+    {
+        if (i < per)
+        {
+            uint32_t id = self * per + i;
+            seed = seed * 1103515245u + 12345;
+            pthread_mutex_lock(&bench_global_lock);
+            bench_global_timers[id].deadline =
+                    bench_service_now() + (seed >> 8) % BENCH_SERVICE_SPREAD;
+            bench_global_heap[bench_global_size] = id;
+            bench_global_timers[id].pos = bench_global_size++;
+            bench_global_fix(bench_global_timers[id].pos);
+            pthread_mutex_unlock(&bench_global_lock);
+
+            if (i % 8 == 7)
+            {
+                id = neighbour * per + i;
+                pthread_mutex_lock(&bench_global_lock);
+                if (bench_global_timers[id].pos != BENCH_GLOBAL_NO_POS)
+                {
+                    bench_global_remove(id);
+                    __atomic_fetch_add(&bench_service_done, 1, __ATOMIC_RELAXED);
+                }
+                pthread_mutex_unlock(&bench_global_lock);
+            }
+            if (i % BENCH_SERVICE_BATCH != 0)
+            {
+                continue;
+            }
+        }
+        else if (__atomic_load_n(&bench_service_done, __ATOMIC_RELAXED) >=
+                 per * bench_service_threads)
+        {
+            break;
+        }
+
+        uint32_t now = bench_service_now();
+        uint32_t ran = 0;
+        pthread_mutex_lock(&bench_global_lock);
+        while (ran < BENCH_SERVICE_BATCH && bench_global_size &&
+               !etimer_past(now, bench_global_timers[bench_global_heap[0]].deadline))
+        {
+            bench_global_remove(bench_global_heap[0]);
+            ran++;
+        }
+        pthread_mutex_unlock(&bench_global_lock);
+        __atomic_fetch_add(&bench_service_done, ran, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static void bench_service_run(void *(*worker)(void *), uint32_t threads, const char *label)
+{
+    pthread_t tid[64];
+    char name[64];
+    uint64_t t0;
+    uint32_t i;
+
+    bench_service_threads = threads;
+    bench_service_done = 0;
+
+    t0 = bench_now_ns();
+    for (i = 0; i < threads; i++)
+    {
+        pthread_create(&tid[i], NULL, worker, (void *)(uintptr_t)i);
+    }
+    for (i = 0; i < threads; i++)
+    {
+        pthread_join(tid[i], NULL);
+    }
+
+    snprintf(name, sizeof(name), "%s, %2u threads", label, threads);
+    bench_report(name, BENCH_SERVICE_TIMERS / threads * threads, bench_now_ns() - t0);
+}
+
+void bench_service(void)
+{
+    uint32_t threads, i;
+
+    bench_service_timers = malloc(BENCH_SERVICE_TIMERS * sizeof(*bench_service_timers));
+    bench_global_timers = malloc(BENCH_SERVICE_TIMERS * sizeof(*bench_global_timers));
+    bench_global_heap = malloc(BENCH_SERVICE_TIMERS * sizeof(*bench_global_heap));
+
+    for (threads = 1; threads <= 64; threads *= 2)
+    {
+        for (i = 0; i < BENCH_SERVICE_TIMERS; i++)
+        {
+            bench_global_timers[i].pos = BENCH_GLOBAL_NO_POS;
+        }
+        bench_global_size = 0;
+        bench_service_run(bench_global_worker, threads, "global mutex heap");
+
+        etimer_service_init(&bench_svc, threads);
+        for (i = 0; i < BENCH_SERVICE_TIMERS; i++)
+        {
+            etimer_service_timer_init(&bench_service_timers[i], bench_service_cb, NULL);
+        }
+        bench_service_run(bench_service_worker, threads, "sharded service  ");
+        etimer_service_deinit(&bench_svc);
+    }
+
+    free(bench_service_timers);
+    free(bench_global_timers);
+    free(bench_global_heap);
+}
@@ -0,0 +1,251 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "etimer_shm.h"
+#include "etimer_timerfd.h"
+
+#define BENCH_SHM_NAME      "/etimer_bench_shm"
+#define BENCH_SHM_PROCS     4
+#define BENCH_SHM_TIMERS    4    /* per process and period */
+#define BENCH_SHM_PERIODS   300
+#define BENCH_SHM_PERIOD    1000 /* us */
+
+struct bench_shm_stats
+{
+    uint64_t wakeups;
+    uint64_t late_us;
+};
+
+static struct bench_shm_stats *bench_shm_stats;
+static uint32_t bench_shm_spread; /* us, the deadlines of a period are this close */
+
+static uint64_t bench_shm_cpu_ns(int who)
+{
+    struct rusage ru;
+
+    getrusage(who, &ru);
+    return ((uint64_t)ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000000u +
+           ((uint64_t)ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1000u;
+}
+
+static uint32_t bench_shm_deadline(uint32_t start, uint32_t period, uint32_t proc, uint32_t k)
+{
+    return start + (period + 1) * BENCH_SHM_PERIOD + (proc * 7 + k * 53) % bench_shm_spread;
+}
+
+/**
+ * @brief  Baseline: every process sleeps on its own deadlines.
+ */
+static void bench_shm_alone(uint32_t proc, uint32_t start)
+{
+    struct bench_shm_stats *stats = &bench_shm_stats[proc];
+    uint32_t p, k, deadline, now;
+    uint64_t target, now_ns;
+    struct timespec ts;
+
+    for (p = 0; p < BENCH_SHM_PERIODS; p++)
+    {
+        for (k = 0; k < BENCH_SHM_TIMERS; k++)
+        {
+            deadline = bench_shm_deadline(start, p, proc, k);
+            if (etimer_past(etimer_timerfd_now(), deadline))
+            {
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+                now_ns = (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+                target = etimer_timerfd_to_ns(now_ns, deadline);
+                ts.tv_sec = (time_t)(target / 1000000000u);
+                ts.tv_nsec = (long)(target % 1000000000u);
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+                stats->wakeups++;
+            }
+            now = etimer_timerfd_now();
+            stats->late_us += (uint32_t)etimer_sub(now, deadline);
+        }
+    }
+}
+
+/**
+ * @brief  Every process arms its timers in the table and sleeps until the dispatcher wakes it.
+ */
+static void bench_shm_shared(uint32_t proc, uint32_t start)
+{
+    struct bench_shm_stats *stats = &bench_shm_stats[proc];
+    uint32_t cookies[BENCH_SHM_TIMERS], p, k, got, now;
+    struct etimer_shm shm;
+    size_t n, i;
+
+    if (etimer_shm_open(&shm, BENCH_SHM_NAME) != 0)
+    {
+        exit(1);
+    }
+    // periodic timers armed a period ahead, as when each one rearms on expiry
+    for (p = 0; p <= BENCH_SHM_PERIODS; p++)
+    {
+        now = etimer_timerfd_now();
+        for (k = 0; p < BENCH_SHM_PERIODS && k < BENCH_SHM_TIMERS; k++)
+        {
+            uint32_t deadline = bench_shm_deadline(start, p, proc, k);
+            etimer_shm_arm(&shm, proc, deadline, deadline, now);
+        }
+        for (got = 0; p > 0 && got < BENCH_SHM_TIMERS; got += n)
+        {
+            n = etimer_shm_collect(&shm, proc, cookies, BENCH_SHM_TIMERS - got);
+            if (n == 0)
+            {
+                etimer_shm_wait(&shm, proc, 1000000);
+                stats->wakeups++;
+            }
+            now = etimer_timerfd_now();
+            for (i = 0; i < n; i++)
+            {
+                stats->late_us += (uint32_t)etimer_sub(now, cookies[i]);
+            }
+        }
+    }
+    etimer_shm_close(&shm);
+}
+
+static void bench_shm_case(const char *name, int shared)
+{
+    static struct etimer_shm_dispatcher disp;
+    uint64_t wakeups = 0, late = 0, cpu, total = (uint64_t)BENCH_SHM_PROCS * BENCH_SHM_TIMERS *
+                                                 BENCH_SHM_PERIODS;
+    uint32_t start, proc;
+    struct etimer_shm shm;
+    size_t fired = 0;
+    char line[96];
+
+    if (shared)
+    {
+        etimer_shm_unlink(BENCH_SHM_NAME);
+        if (etimer_shm_create(&shm, BENCH_SHM_NAME, 1024, BENCH_SHM_PROCS) != 0 ||
+            etimer_shm_dispatcher_init(&disp, &shm) != 0)
+        {
+            exit(1);
+        }
+    }
+
+    cpu = bench_shm_cpu_ns(RUSAGE_CHILDREN) + bench_shm_cpu_ns(RUSAGE_SELF);
+    start = etimer_timerfd_now();
+    for (proc = 0; proc < BENCH_SHM_PROCS; proc++)
+    {
+        if (fork() == 0)
+        {
+            shared ? bench_shm_shared(proc, start) : bench_shm_alone(proc, start);
+            _exit(0);
+        }
+    }
+    // the dispatcher runs in this process
+    while (shared && fired < total)
+    {
+        etimer_shm_dispatcher_sleep(&disp, etimer_timerfd_now());
+        fired += etimer_shm_dispatch(&disp, etimer_timerfd_now());
+    }
+    while (wait(NULL) > 0)
+    {
+    }
+    cpu = bench_shm_cpu_ns(RUSAGE_CHILDREN) + bench_shm_cpu_ns(RUSAGE_SELF) - cpu;
+
+    for (proc = 0; proc < BENCH_SHM_PROCS; proc++)
+    {
+        wakeups += bench_shm_stats[proc].wakeups;
+        late += bench_shm_stats[proc].late_us;
+        bench_shm_stats[proc].wakeups = 0;
+        bench_shm_stats[proc].late_us = 0;
+    }
+    if (shared)
+    {
+        snprintf(line, sizeof(line), "%s, dispatcher wakeups", name);
+        bench_report_value(line, disp.wakeups, "");
+        wakeups += disp.wakeups;
+        etimer_shm_dispatcher_deinit(&disp);
+        etimer_shm_close(&shm);
+        etimer_shm_unlink(BENCH_SHM_NAME);
+    }
+
+    snprintf(line, sizeof(line), "%s, wakeups", name);
+    bench_report_value(line, wakeups, "");
+    snprintf(line, sizeof(line), "%s, wakeups per timer", name);
+    bench_report_value(line, (double)wakeups / total, "");
+    snprintf(line, sizeof(line), "%s, cpu per timer", name);
+    bench_report_value(line, (double)cpu / total, "ns");
+    snprintf(line, sizeof(line), "%s, mean lateness", name);
+    bench_report_value(line, (double)late / total, "us");
+}
+
+/**
+ * @brief  Table operations alone, arm, dispatch and collect in one process without sleeping.
+ */
+static void bench_shm_ops(void)
+{
+    static struct etimer_shm_dispatcher disp;
+    static uint32_t cookies[1024];
+    struct etimer_shm shm;
+    uint32_t now = 0xFFFF0000, r, i, proc;
+    uint64_t t0, n = 0;
+
+    etimer_shm_unlink(BENCH_SHM_NAME);
+    if (etimer_shm_create(&shm, BENCH_SHM_NAME, 1024, BENCH_SHM_PROCS) != 0 ||
+        etimer_shm_dispatcher_init(&disp, &shm) != 0)
+    {
+        exit(1);
+    }
+    t0 = bench_now_ns();
+    for (r = 0; r < 1000; r++)
+    {
+        for (i = 0; i < 1024; i++)
+        {
+            etimer_shm_arm(&shm, i % BENCH_SHM_PROCS, now + 1 + bench_rand() % 1000, i, now);
+        }
+        now += 1000;
+        etimer_shm_dispatch(&disp, now);
+        for (proc = 0; proc < BENCH_SHM_PROCS; proc++)
+        {
+            n += etimer_shm_collect(&shm, proc, cookies, 1024);
+        }
+    }
+    bench_report("etimer_shm, arm + dispatch + collect", n, bench_now_ns() - t0);
+    etimer_shm_dispatcher_deinit(&disp);
+    etimer_shm_close(&shm);
+    etimer_shm_unlink(BENCH_SHM_NAME);
+}
+
+void bench_shm(void)
+{
+    bench_shm_stats = mmap(NULL, BENCH_SHM_PROCS * sizeof(*bench_shm_stats),
+                           PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (bench_shm_stats == MAP_FAILED)
+    {
+        exit(1);
+    }
+
+    bench_shm_ops();
+    for (bench_shm_spread = 20; bench_shm_spread <= 400; bench_shm_spread *= 20)
+    {
+        printf("(%u processes, %u timers each per %u us period within %u us, %u periods)\n",
+               BENCH_SHM_PROCS, BENCH_SHM_TIMERS, BENCH_SHM_PERIOD, bench_shm_spread,
+               BENCH_SHM_PERIODS);
+        bench_shm_case("per-process clock_nanosleep", 0);
+        bench_shm_case("etimer_shm, one dispatcher", 1);
+    }
+
+    munmap(bench_shm_stats, BENCH_SHM_PROCS * sizeof(*bench_shm_stats));
+}
+
+#else
+
+void bench_shm(void)
+{
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_compact.h"
+#include "etimer_snap.h"
+
+#define BENCH_SNAP_PATH    "bench_snap.bin"
+#define BENCH_SNAP_TIMERS  (1024u * 1024)
+#define BENCH_SNAP_HORIZON (1u << 24) /* 16 s of 1 us ticks */
+#define BENCH_SNAP_DOWN    (1u << 20) /* about 1 s down, 1 timer in 16 due on restart */
+
+static uint32_t *bench_snap_deadlines;
+static uint32_t *bench_snap_restored;
+static struct etimer_compact bench_snap_wheel;
+
+/**
+ * @brief  Timers not due must move by the clock change, the due ones must compare as passed.
+ */
+static uint32_t bench_snap_check(uint32_t before, uint32_t after, uint32_t *due)
+{
+    uint32_t shift = after - before - BENCH_SNAP_DOWN, errors = 0, i;
+
+    *due = 0;
+    for (i = 0; i < BENCH_SNAP_TIMERS; i++)
+    {
+        if (etimer_sub(bench_snap_deadlines[i], before) > (int32_t)BENCH_SNAP_DOWN)
+        {
+            errors += bench_snap_restored[i] != bench_snap_deadlines[i] + shift;
+        }
+        else
+        {
+            errors += etimer_sub(after, bench_snap_restored[i]) < 0;
+            (*due)++;
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief  Baseline: read the file into memory with fread, then rebase.
+ */
+static size_t bench_snap_fread(uint32_t now)
+{
+    struct etimer_snap_header header;
+    struct etimer_snap_record *records;
+    FILE *fp = fopen(BENCH_SNAP_PATH, "rb");
+    size_t due;
+
+    if (fp == NULL || fread(&header, sizeof(header), 1, fp) != 1)
+    {
+        exit(1);
+    }
+    records = malloc(header.count * sizeof(*records));
+    if (records == NULL || fread(records, sizeof(*records), header.count, fp) != header.count)
+    {
+        exit(1);
+    }
+    fclose(fp);
+    due = etimer_snap_restore(records, header.count, now, BENCH_SNAP_DOWN, header.max_value,
+                              bench_snap_restored);
+    free(records);
+    return due;
+}
+
+void bench_snap(void)
+{
+    struct etimer_snap_reader reader;
+    uint32_t before = 0xFFF00000, after = 0x12345678, due, errors, i;
+    uint64_t t0, ns;
+    size_t n;
+
+    bench_snap_deadlines = malloc(BENCH_SNAP_TIMERS * sizeof(*bench_snap_deadlines));
+    bench_snap_restored = malloc(BENCH_SNAP_TIMERS * sizeof(*bench_snap_restored));
+    for (i = 0; i < BENCH_SNAP_TIMERS; i++)
+    {
+        bench_snap_deadlines[i] = before + 1 + bench_rand() % (BENCH_SNAP_HORIZON - 1);
+    }
+
+    t0 = bench_now_ns();
+    if (etimer_snap_save(BENCH_SNAP_PATH, bench_snap_deadlines, NULL, BENCH_SNAP_TIMERS, before,
+                         ETIMER_MAX_VALUE, 0) != 0)
+    {
+        exit(1);
+    }
+    bench_report("save", BENCH_SNAP_TIMERS, bench_now_ns() - t0);
+    bench_report_value("file size per timer",
+                       (double)(sizeof(struct etimer_snap_header) +
+                                (uint64_t)BENCH_SNAP_TIMERS * sizeof(struct etimer_snap_record)) /
+                               BENCH_SNAP_TIMERS,
+                       "B");
+
+    t0 = bench_now_ns();
+    n = bench_snap_fread(after);
+    ns = bench_now_ns() - t0;
+    bench_report("fread and restore", BENCH_SNAP_TIMERS, ns);
+    bench_report_value("fread and restore, per 1M timers", (double)ns / BENCH_SNAP_TIMERS,
+                       "ms");
+
+    // mapping fresh, the pages are faulted in by the pass
+    t0 = bench_now_ns();
+    if (etimer_snap_open(&reader, BENCH_SNAP_PATH) != 0)
+    {
+        exit(1);
+    }
+    n = etimer_snap_restore(reader.records, reader.header->count, after, BENCH_SNAP_DOWN,
+                            reader.header->max_value, bench_snap_restored);
+    ns = bench_now_ns() - t0;
+    bench_report("mmap and restore", BENCH_SNAP_TIMERS, ns);
+    bench_report_value("mmap and restore, per 1M timers", (double)ns / BENCH_SNAP_TIMERS,
+                       "ms");
+
+    t0 = bench_now_ns();
+    n = etimer_snap_restore(reader.records, reader.header->count, after, BENCH_SNAP_DOWN,
+                            reader.header->max_value, bench_snap_restored);
+    bench_report("restore pass, mapped pages resident", BENCH_SNAP_TIMERS, bench_now_ns() - t0);
+    errors = bench_snap_check(before, after, &due);
+
+    // up to a running wheel, the due timers expire on the first poll
+    etimer_compact_init(&bench_snap_wheel, BENCH_SNAP_TIMERS, 256, 4096, after);
+    t0 = bench_now_ns();
+    n = etimer_snap_restore(reader.records, reader.header->count, after, BENCH_SNAP_DOWN,
+                            reader.header->max_value, bench_snap_restored);
+    for (i = 0; i < BENCH_SNAP_TIMERS; i++)
+    {
+        etimer_compact_add(&bench_snap_wheel, bench_snap_restored[i]);
+    }
+    bench_report("restore pass and etimer_compact_add", BENCH_SNAP_TIMERS, bench_now_ns() - t0);
+    etimer_compact_deinit(&bench_snap_wheel);
+    etimer_snap_close(&reader);
+
+    printf("(%zu due on restart, %u expected, %u errors)\n", n, due, errors);
+
+    remove(BENCH_SNAP_PATH);
+    free(bench_snap_deadlines);
+    free(bench_snap_restored);
+}
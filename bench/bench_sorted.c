@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_sorted.h"
+
+#define BENCH_SORTED_CYCLE (64u * 1024)
+#define BENCH_SORTED_MAX   (1024u * 1024)
+#define BENCH_SORTED_WORK  (4u * 1024 * 1024) /* timers per case */
+
+//
+// Baseline: an indexed binary heap, like the service shards, one insert or removal per timer.
+//
+static struct etimer_sorted_entry *bench_heap;
+static uint32_t *bench_heap_pos;
+static uint32_t bench_heap_size;
+
+static inline int bench_heap_before(uint32_t a, uint32_t b)
+{
+    return etimer_past(a, b) && a != b;
+}
+
+static inline void bench_heap_set(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    bench_heap[pos] = entry;
+    bench_heap_pos[entry.handle] = pos;
+}
+
+static void bench_heap_up(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    while (pos > 0 && bench_heap_before(entry.deadline, bench_heap[(pos - 1) / 2].deadline))
+    {
+        bench_heap_set(pos, bench_heap[(pos - 1) / 2]);
+        pos = (pos - 1) / 2;
+    }
+    bench_heap_set(pos, entry);
+}
+
+static void bench_heap_down(uint32_t pos, struct etimer_sorted_entry entry)
+{
+    for (;;)
+    {
+        uint32_t child = pos * 2 + 1;
+        if (child >= bench_heap_size)
+        {
+            break;
+        }
+        if (child + 1 < bench_heap_size &&
+            bench_heap_before(bench_heap[child + 1].deadline, bench_heap[child].deadline))
+        {
+            child++;
+        }
+        if (!bench_heap_before(bench_heap[child].deadline, entry.deadline))
+        {
+            break;
+        }
+        bench_heap_set(pos, bench_heap[child]);
+        pos = child;
+    }
+    bench_heap_set(pos, entry);
+}
+
+static void bench_heap_insert(struct etimer_sorted_entry entry)
+{
+    bench_heap_up(bench_heap_size++, entry);
+}
+
+static struct etimer_sorted_entry bench_heap_pop(void)
+{
+    struct etimer_sorted_entry top = bench_heap[0];
+
+    if (--bench_heap_size)
+    {
+        bench_heap_down(0, bench_heap[bench_heap_size]);
+    }
+    return top;
+}
+
+static void bench_heap_remove(uint32_t handle)
+{
+    uint32_t pos = bench_heap_pos[handle];
+    struct etimer_sorted_entry last = bench_heap[--bench_heap_size];
+
+    if (last.handle != handle)
+    {
+        bench_heap_up(pos, last);
+        bench_heap_down(bench_heap_pos[last.handle], last);
+    }
+}
+
+static void bench_sorted_fill(struct etimer_sorted_entry *batch, uint32_t first, size_t n,
+                              uint32_t now, uint32_t spread)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        batch[i].handle = first + (uint32_t)i;
+        batch[i].deadline = now + bench_rand() % spread;
+    }
+}
+
+static void bench_sorted_case(struct etimer_sorted *sorted, struct etimer_sorted_entry *batch,
+                              uint32_t *handles, size_t n, int burst)
+{
+    size_t cycle = n > BENCH_SORTED_CYCLE ? n : BENCH_SORTED_CYCLE;
+    size_t rounds = BENCH_SORTED_WORK / cycle;
+    uint64_t t_heap[3] = {0}, t_sorted[3] = {0}, t0;
+    const char *label = burst ? "burst " : "spread";
+    char name[64];
+    size_t r, i, got;
+
+    // Each cycle arms its timers n at a time, cancels every other one and lets the rest expire.
+    // A burst arrives one tick per timer and times out 1 s later, spread timers fall anywhere in
+    // the next second. Cycles start close to the wrap and cross it.
+    for (r = 0; r < rounds; r++)
+    {
+        uint32_t now = 0xFFFFFFFF - 500000 + (uint32_t)r * 0x400000;
+
+        for (i = 0; i < cycle; i += n)
+        {
+            if (burst)
+            {
+                bench_sorted_fill(batch + i, (uint32_t)i, n, now + (uint32_t)i + 1000000,
+                                  (uint32_t)n);
+            }
+            else
+            {
+                bench_sorted_fill(batch + i, (uint32_t)i, n, now, 1000000);
+            }
+        }
+        for (i = 0; i < cycle / 2; i++)
+        {
+            handles[i] = (uint32_t)i * 2;
+        }
+
+        t0 = bench_now_ns();
+        for (i = 0; i < cycle; i++)
+        {
+            bench_heap_insert(batch[i]);
+        }
+        t_heap[0] += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (i = 0; i < cycle / 2; i++)
+        {
+            bench_heap_remove(handles[i]);
+        }
+        t_heap[1] += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        while (bench_heap_size && etimer_past(bench_heap[0].deadline, now + 0x3FFFFF))
+        {
+            handles[cycle / 2] = bench_heap_pop().handle;
+        }
+        t_heap[2] += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (i = 0; i < cycle; i += n)
+        {
+            etimer_sorted_arm(sorted, burst ? now + (uint32_t)i : now, batch + i, n);
+        }
+        t_sorted[0] += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        for (i = 0; i < cycle / 2; i += n / 2)
+        {
+            etimer_sorted_cancel(sorted, handles + i, n / 2);
+        }
+        t_sorted[1] += bench_now_ns() - t0;
+
+        t0 = bench_now_ns();
+        do
+        {
+            got = etimer_sorted_expire(sorted, now + 0x3FFFFF, handles + cycle / 2, n);
+        } while (got == n);
+        t_sorted[2] += bench_now_ns() - t0;
+    }
+
+    snprintf(name, sizeof(name), "%s %7zu, heap insert", label, n);
+    bench_report(name, rounds * cycle, t_heap[0]);
+    snprintf(name, sizeof(name), "%s %7zu, batch arm", label, n);
+    bench_report(name, rounds * cycle, t_sorted[0]);
+    snprintf(name, sizeof(name), "%s %7zu, heap remove", label, n);
+    bench_report(name, rounds * cycle / 2, t_heap[1]);
+    snprintf(name, sizeof(name), "%s %7zu, batch cancel", label, n);
+    bench_report(name, rounds * cycle / 2, t_sorted[1]);
+    snprintf(name, sizeof(name), "%s %7zu, heap pop", label, n);
+    bench_report(name, rounds * cycle / 2, t_heap[2]);
+    snprintf(name, sizeof(name), "%s %7zu, batch expire", label, n);
+    bench_report(name, rounds * cycle / 2, t_sorted[2]);
+    snprintf(name, sizeof(name), "%s %7zu, heap total", label, n);
+    bench_report(name, rounds * cycle, t_heap[0] + t_heap[1] + t_heap[2]);
+    snprintf(name, sizeof(name), "%s %7zu, batch total", label, n);
+    bench_report(name, rounds * cycle, t_sorted[0] + t_sorted[1] + t_sorted[2]);
+}
+
+void bench_sorted(void)
+{
+    struct etimer_sorted sorted;
+    struct etimer_sorted_entry *batch = malloc(BENCH_SORTED_MAX * sizeof(*batch));
+    uint32_t *handles = malloc(2 * BENCH_SORTED_MAX * sizeof(*handles));
+    size_t n;
+
+    bench_heap = malloc(BENCH_SORTED_MAX * sizeof(*bench_heap));
+    bench_heap_pos = malloc(BENCH_SORTED_MAX * sizeof(*bench_heap_pos));
+    etimer_sorted_init(&sorted, BENCH_SORTED_MAX, ETIMER_MAX_VALUE);
+
+    for (n = 16; n <= BENCH_SORTED_MAX; n *= 4)
+    {
+        bench_sorted_case(&sorted, batch, handles, n, 1);
+        bench_sorted_case(&sorted, batch, handles, n, 0);
+    }
+
+    etimer_sorted_deinit(&sorted);
+    free(bench_heap);
+    free(bench_heap_pos);
+    free(batch);
+    free(handles);
+}
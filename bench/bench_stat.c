@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_stat.h"
+
+#define BENCH_STAT_N      4096
+#define BENCH_STAT_ROUNDS 4096
+
+void bench_stat(void)
+{
+    uint32_t *times = malloc(BENCH_STAT_N * sizeof(*times));
+    uint32_t now = bench_rand();
+    uint32_t sum = 0;
+    uint64_t t0;
+    size_t r, i;
+
+    for (i = 0; i < BENCH_STAT_N; i++)
+    {
+        times[i] = now + bench_rand() % 0x100000 - 0x80000;
+    }
+
+    // instrumentation compiled out, the plain primitives
+    t0 = bench_now_ns();
+    for (r = 0; r < BENCH_STAT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_STAT_N; i++)
+        {
+            sum += (etimer_past)(times[i], now);
+        }
+        __asm__ volatile("" : "+r"(now));
+    }
+    bench_report("etimer_past, disabled", BENCH_STAT_ROUNDS * BENCH_STAT_N, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (r = 0; r < BENCH_STAT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_STAT_N; i++)
+        {
+            sum += ETIMER_STAT_CALL("etimer_past", etimer_stat_past_raw, times[i], now,
+                                    ETIMER_MAX_VALUE_OVERFLOW);
+        }
+        __asm__ volatile("" : "+r"(now));
+    }
+    bench_report("etimer_past, enabled", BENCH_STAT_ROUNDS * BENCH_STAT_N, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (r = 0; r < BENCH_STAT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_STAT_N; i++)
+        {
+            sum += (etimer_add)(times[i], (int32_t)r);
+        }
+    }
+    bench_report("etimer_add, disabled", BENCH_STAT_ROUNDS * BENCH_STAT_N, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (r = 0; r < BENCH_STAT_ROUNDS; r++)
+    {
+        for (i = 0; i < BENCH_STAT_N; i++)
+        {
+            sum += ETIMER_STAT_CALL("etimer_add", etimer_stat_add_raw, times[i], (int32_t)r,
+                                    ETIMER_MAX_VALUE);
+        }
+    }
+    bench_report("etimer_add, enabled", BENCH_STAT_ROUNDS * BENCH_STAT_N, bench_now_ns() - t0);
+
+    etimer_stat_dump(stdout);
+    printf("(%u)\n", sum);
+    etimer_stat_reset();
+    free(times);
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_store.h"
+
+#define BENCH_STORE_TIMERS 100000
+#define BENCH_STORE_STEPS  1000
+
+void bench_store(void)
+{
+    uint32_t *deadlines = malloc(BENCH_STORE_TIMERS * sizeof(*deadlines));
+    uint32_t *handles = malloc(BENCH_STORE_TIMERS * sizeof(*handles));
+    struct etimer_store store;
+    uint32_t now = 0xFFFF0000;
+    uint64_t t0, worst = 0;
+    size_t i, n = 0;
+    int32_t ticks;
+    uint32_t s;
+
+    etimer_store_init(&store, BENCH_STORE_TIMERS, ETIMER_MAX_VALUE, now);
+    for (i = 0; i < BENCH_STORE_TIMERS; i++)
+    {
+        deadlines[i] = now + bench_rand() % 0x100000;
+        etimer_store_add(&store, deadlines[i]);
+    }
+
+    // baseline: etimer_add on every pending deadline
+    for (s = 0; s < BENCH_STORE_STEPS; s++)
+    {
+        ticks = (int32_t)(bench_rand() % 2001) - 1000;
+        t0 = bench_now_ns();
+        for (i = 0; i < BENCH_STORE_TIMERS; i++)
+        {
+            deadlines[i] = etimer_add(deadlines[i], ticks);
+        }
+        t0 = bench_now_ns() - t0;
+        worst = t0 > worst ? t0 : worst;
+    }
+    bench_report_value("step 100k timers, walk, worst", worst / 1000.0, "us");
+
+    worst = 0;
+    for (s = 0; s < BENCH_STORE_STEPS; s++)
+    {
+        ticks = (int32_t)(bench_rand() % 2001) - 1000;
+        t0 = bench_now_ns();
+        etimer_store_step(&store, ticks);
+        t0 = bench_now_ns() - t0;
+        worst = t0 > worst ? t0 : worst;
+    }
+    bench_report_value("step 100k timers, etimer_store, worst", worst / 1000.0, "us");
+
+    t0 = bench_now_ns();
+    for (s = 0; s < 100; s++)
+    {
+        n += etimer_store_expired(&store, etimer_store_get(&store, s), handles,
+                                  BENCH_STORE_TIMERS);
+    }
+    bench_report("expired scan, per timer", 100ull * BENCH_STORE_TIMERS, bench_now_ns() - t0);
+
+    t0 = bench_now_ns();
+    for (s = 0; s < 100; s++)
+    {
+        for (i = 0; i < BENCH_STORE_TIMERS; i++)
+        {
+            handles[i] = (uint32_t)i;
+        }
+        etimer_store_get_batch(&store, handles, BENCH_STORE_TIMERS, deadlines);
+    }
+    bench_report("get batch, per timer", 100ull * BENCH_STORE_TIMERS, bench_now_ns() - t0);
+
+    printf("(%zu %u)\n", n, deadlines[0]);
+    etimer_store_deinit(&store);
+    free(deadlines);
+    free(handles);
+}
@@ -0,0 +1,99 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "etimer_timerfd.h"
+
+#define BENCH_TIMERFD_WAKEUPS 200
+#define BENCH_TIMERFD_PERIOD  2000 /* us */
+
+static uint64_t bench_timerfd_cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void bench_timerfd_report(const char *label, uint64_t wall, uint64_t cpu, int64_t late_sum,
+                                 int32_t late_max)
+{
+    char name[64];
+
+    snprintf(name, sizeof(name), "%s, cpu usage", label);
+    bench_report_value(name, 100.0 * cpu / wall, "%");
+    snprintf(name, sizeof(name), "%s, mean lateness", label);
+    bench_report_value(name, (double)late_sum / BENCH_TIMERFD_WAKEUPS, "us");
+    snprintf(name, sizeof(name), "%s, max lateness", label);
+    bench_report_value(name, late_max, "us");
+}
+
+void bench_timerfd(void)
+{
+    struct etimer_timerfd tfd;
+    struct epoll_event ev;
+    uint64_t wall, cpu;
+    int64_t late_sum = 0;
+    int32_t late, late_max = 0;
+    uint32_t deadline;
+    int epfd, i;
+
+    // Busy polling etimer_past on the 32bit us clock.
+    deadline = etimer_timerfd_now();
+    wall = bench_now_ns();
+    cpu = bench_timerfd_cpu_ns();
+    for (i = 0; i < BENCH_TIMERFD_WAKEUPS; i++)
+    {
+        uint32_t now;
+        deadline = etimer_add(deadline, BENCH_TIMERFD_PERIOD);
+        while (etimer_past(now = etimer_timerfd_now(), deadline))
+        {
+        }
+        late = etimer_sub(now, deadline);
+        late_sum += late;
+        late_max = late > late_max ? late : late_max;
+    }
+    bench_timerfd_report("busy polling", bench_now_ns() - wall, bench_timerfd_cpu_ns() - cpu,
+                         late_sum, late_max);
+
+    // One timerfd for the next deadline, one epoll_wait per wakeup.
+    epfd = epoll_create1(0);
+    etimer_timerfd_init(&tfd, epfd, NULL);
+    late_sum = 0;
+    late_max = 0;
+    deadline = etimer_timerfd_now();
+    wall = bench_now_ns();
+    cpu = bench_timerfd_cpu_ns();
+    for (i = 0; i < BENCH_TIMERFD_WAKEUPS; i++)
+    {
+        deadline = etimer_add(deadline, BENCH_TIMERFD_PERIOD);
+        etimer_timerfd_arm(&tfd, deadline);
+        while (epoll_wait(epfd, &ev, 1, -1) != 1)
+        {
+        }
+        etimer_timerfd_ack(&tfd);
+        late = etimer_sub(etimer_timerfd_now(), deadline);
+        late_sum += late;
+        late_max = late > late_max ? late : late_max;
+    }
+    bench_timerfd_report("timerfd + epoll", bench_now_ns() - wall, bench_timerfd_cpu_ns() - cpu,
+                         late_sum, late_max);
+    printf("timerfd + epoll: %u timerfd_settime for %d wakeups\n", tfd.arm_count,
+           BENCH_TIMERFD_WAKEUPS);
+
+    etimer_timerfd_deinit(&tfd);
+    close(epfd);
+}
+
+#else
+
+void bench_timerfd(void)
+{
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "etimer_trace.h"
+
+#define BENCH_TRACE_PATH    "bench_trace.bin"
+#define BENCH_TRACE_RECORDS (8u * 1024 * 1024)
+#define BENCH_TRACE_WIDTH   (1024u * 32)
+
+static struct etimer_trace_writer bench_trace_writer;
+
+/**
+ * @brief  Baseline: stream the file with fread and extend every record until end.
+ */
+static uint64_t bench_trace_linear(uint64_t begin, uint64_t end)
+{
+    static struct etimer_trace_record buf[ETIMER_TRACE_BLOCK_RECORDS];
+    struct etimer_trace_header header;
+    uint64_t ext = 0, count = 0, seen = 0;
+    uint32_t last = 0;
+    FILE *fp = fopen(BENCH_TRACE_PATH, "rb");
+
+    if (fp == NULL || fread(&header, sizeof(header), 1, fp) != 1)
+    {
+        exit(1);
+    }
+
+    while (seen < header.record_count)
+    {
+        size_t i, n = fread(buf, sizeof(buf[0]), ETIMER_TRACE_BLOCK_RECORDS, fp);
+        if (n == 0)
+        {
+            break;
+        }
+        for (i = 0; i < n && seen < header.record_count; i++, seen++)
+        {
+            ext = seen ? ext + etimer_sub_raw(buf[i].time, last, header.overflow,
+                                              header.max_value)
+                       : buf[i].time;
+            last = buf[i].time;
+            if (ext >= end)
+            {
+                fclose(fp);
+                return count;
+            }
+            count += ext >= begin;
+        }
+    }
+
+    fclose(fp);
+    return count;
+}
+
+void bench_trace(void)
+{
+    struct etimer_trace_reader reader;
+    struct etimer_trace_range range;
+    uint32_t time = 0xF0000000;
+    uint64_t span, t0, sum_linear = 0, sum_index = 0;
+    uint32_t i, queries;
+
+    etimer_trace_writer_open(&bench_trace_writer, BENCH_TRACE_PATH, ETIMER_MAX_VALUE);
+    t0 = bench_now_ns();
+    for (i = 0; i < BENCH_TRACE_RECORDS; i++)
+    {
+        time += 1 + bench_rand() % 64;
+        etimer_trace_write(&bench_trace_writer, time, i);
+    }
+    etimer_trace_writer_close(&bench_trace_writer);
+    bench_report("trace write (per record)", BENCH_TRACE_RECORDS, bench_now_ns() - t0);
+
+    if (etimer_trace_reader_open(&reader, BENCH_TRACE_PATH) != 0)
+    {
+        printf("open %s failed\n", BENCH_TRACE_PATH);
+        return;
+    }
+    span = reader.index[reader.header->block_count - 1] - reader.index[0];
+
+    queries = 100;
+    t0 = bench_now_ns();
+    for (i = 0; i < queries; i++)
+    {
+        uint64_t begin = reader.index[0] + (uint64_t)bench_rand() * span / ETIMER_MAX_VALUE;
+        sum_linear += bench_trace_linear(begin, begin + BENCH_TRACE_WIDTH);
+    }
+    bench_report("trace range, fread linear scan", queries, bench_now_ns() - t0);
+
+    queries = 1000000;
+    t0 = bench_now_ns();
+    for (i = 0; i < queries; i++)
+    {
+        uint64_t begin = reader.index[0] + (uint64_t)bench_rand() * span / ETIMER_MAX_VALUE;
+        etimer_trace_find(&reader, begin, begin + BENCH_TRACE_WIDTH, &range);
+        sum_index += range.count;
+    }
+    bench_report("trace range, mmap index search", queries, bench_now_ns() - t0);
+
+    printf("records per query: linear %.1f, index %.1f\n", (double)sum_linear / 100,
+           (double)sum_index / queries);
+
+    etimer_trace_reader_close(&reader);
+    remove(BENCH_TRACE_PATH);
+}
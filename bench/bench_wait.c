@@ -0,0 +1,110 @@
+#ifdef __linux__
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "etimer_timerfd.h"
+#include "etimer_wait.h"
+
+#define BENCH_WAIT_COUNT   500
+#define BENCH_WAIT_MIN_GAP 200  /* us */
+#define BENCH_WAIT_MAX_GAP 2000 /* us */
+
+enum
+{
+    BENCH_WAIT_SPIN,
+    BENCH_WAIT_SLEEP,
+    BENCH_WAIT_HYBRID,
+};
+
+static int64_t bench_wait_late[BENCH_WAIT_COUNT];
+static struct etimer_wait bench_wait_state;
+
+static uint64_t bench_wait_clock(clockid_t id)
+{
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static int bench_wait_cmp(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief  ns returned after the start of the deadline microsecond.
+ */
+static int64_t bench_wait_one(int mode, uint32_t deadline)
+{
+    uint64_t now = bench_wait_clock(CLOCK_MONOTONIC), target;
+    struct timespec ts;
+
+    target = etimer_timerfd_to_ns(now, deadline);
+    switch (mode)
+    {
+    case BENCH_WAIT_SPIN:
+        // what the rig does today
+        while (etimer_past(etimer_timerfd_now(), deadline))
+        {
+        }
+        break;
+    case BENCH_WAIT_SLEEP:
+        ts.tv_sec = (time_t)(target / 1000000000u);
+        ts.tv_nsec = (long)(target % 1000000000u);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        break;
+    default:
+        return etimer_wait(&bench_wait_state, deadline);
+    }
+    return (int64_t)(bench_wait_clock(CLOCK_MONOTONIC) - target);
+}
+
+static void bench_wait_case(const char *name, int mode)
+{
+    uint64_t wall = bench_now_ns(), cpu = bench_wait_clock(CLOCK_THREAD_CPUTIME_ID);
+    uint32_t gap, i;
+    char line[96];
+
+    etimer_wait_init(&bench_wait_state);
+    for (i = 0; i < BENCH_WAIT_COUNT; i++)
+    {
+        gap = BENCH_WAIT_MIN_GAP + bench_rand() % (BENCH_WAIT_MAX_GAP - BENCH_WAIT_MIN_GAP);
+        bench_wait_late[i] = bench_wait_one(mode, etimer_add(etimer_timerfd_now(), gap));
+    }
+    cpu = bench_wait_clock(CLOCK_THREAD_CPUTIME_ID) - cpu;
+    wall = bench_now_ns() - wall;
+
+    qsort(bench_wait_late, BENCH_WAIT_COUNT, sizeof(bench_wait_late[0]), bench_wait_cmp);
+    snprintf(line, sizeof(line), "%s, lateness p50", name);
+    bench_report_value(line, bench_wait_late[BENCH_WAIT_COUNT / 2], "ns");
+    snprintf(line, sizeof(line), "%s, lateness p99", name);
+    bench_report_value(line, bench_wait_late[BENCH_WAIT_COUNT * 99 / 100], "ns");
+    snprintf(line, sizeof(line), "%s, lateness max", name);
+    bench_report_value(line, bench_wait_late[BENCH_WAIT_COUNT - 1], "ns");
+    snprintf(line, sizeof(line), "%s, cpu", name);
+    bench_report_value(line, 100.0 * cpu / wall, "%");
+}
+
+void bench_wait(void)
+{
+    bench_wait_case("spin on etimer_past", BENCH_WAIT_SPIN);
+    bench_wait_case("clock_nanosleep", BENCH_WAIT_SLEEP);
+    bench_wait_case("etimer_wait", BENCH_WAIT_HYBRID);
+    printf("(%u to %u us waits, etimer_wait margin settled at %u ns, %u of %u sleeps missed)\n",
+           BENCH_WAIT_MIN_GAP, BENCH_WAIT_MAX_GAP, bench_wait_state.margin,
+           bench_wait_state.misses, bench_wait_state.sleeps);
+}
+
+#else
+
+void bench_wait(void)
+{
+}
+
+#endif /* __linux__ */
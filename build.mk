@@ -1,3 +1,14 @@
 SRC		+= .
 
-INCLUDE	+= .
\ No newline at end of file
+INCLUDE	+= .
+
+LFLAGS	+= -lm -lrt
+
+# 'make TARGET=bench' builds the benchmark runner in bench/ instead of the main.c tests.
+ifeq ($(TARGET),bench)
+EXCLUDE	+= ./main.c
+OBJDIR	= $(OUTPUT_PATH)/obj_bench
+LFLAGS	+= -lpthread
+else
+EXCLUDE	+= $(wildcard ./bench/*.c)
+endif
@@ -115,4 +115,8 @@ static inline int32_t etimer_sub(uint32_t time1, uint32_t time2)
 }
 #endif /* __cplusplus */
 
+#ifdef ETIMER_STAT
+#include "etimer_stat.h"
+#endif /* ETIMER_STAT */
+
 #endif /* _ETIMER_H_ */
@@ -115,4 +115,8 @@ static inline int16_t etimer16_sub(uint16_t time1, uint16_t time2)
 }
 #endif /* __cplusplus */
 
+#ifdef ETIMER_STAT
+#include "etimer_stat.h"
+#endif /* ETIMER_STAT */
+
 #endif /* _ETIMER16_H_ */
@@ -0,0 +1,252 @@
+#include <errno.h>
+
+#include "etimer_bin.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Times binned per pass when counts are kept, the indexes stay in L1 until counted.
+#define ETIMER_BIN_BLOCK 256
+
+int etimer_bin_init(struct etimer_bin *bin, uint32_t width, uint32_t bins, uint32_t max_value)
+{
+    uint32_t log = 0;
+
+    if (width == 0 || bins == 0 || max_value == 0 || (max_value & (max_value + 1)) != 0 ||
+        (uint64_t)width * bins > (uint64_t)(max_value >> 1) + 1)
+    {
+        return -EINVAL;
+    }
+
+    // distances are below 2^31, so ceil(2^(31 + log) / width) with width <= 2^log is exact for
+    // all of them and fits 32 bits
+    while (log < 32 && (1ull << log) < width)
+    {
+        log++;
+    }
+    bin->max_value = max_value;
+    bin->width = width;
+    bin->bins = bins;
+    bin->span = width * bins;
+    bin->shift = 31 + log;
+    bin->magic = (uint32_t)(((1ull << bin->shift) + width - 1) / width);
+
+    return 0;
+}
+
+#if defined(__AVX2__)
+/**
+ * @brief  Bins of 8 distances from the base, ETIMER_BIN_NONE out of the window. The 32x32 bit
+ * products are taken on the even and the odd lanes apart.
+ */
+static inline __m256i etimer_bin_avx2(__m256i off, __m256i span, __m256i magic, __m128i shift,
+                                      __m256i *inside)
+{
+    __m256i sign = _mm256_set1_epi32((int32_t)0x80000000u);
+    __m256i even = _mm256_srl_epi64(_mm256_mul_epu32(off, magic), shift);
+    __m256i odd = _mm256_srl_epi64(_mm256_mul_epu32(_mm256_srli_epi64(off, 32), magic), shift);
+
+    // unsigned off < span, compared signed with the top bits flipped
+    *inside = _mm256_cmpgt_epi32(span, _mm256_xor_si256(off, sign));
+    return _mm256_or_si256(_mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA),
+                           _mm256_xor_si256(*inside, _mm256_set1_epi32(-1)));
+}
+
+static size_t etimer_bin_sum(__m256i acc)
+{
+    __m128i v = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+#elif defined(__SSE2__)
+/**
+ * @brief  Bins of 4 distances from the base, ETIMER_BIN_NONE out of the window.
+ */
+static inline __m128i etimer_bin_sse2(__m128i off, __m128i span, __m128i magic, __m128i shift,
+                                      __m128i *inside)
+{
+    __m128i sign = _mm_set1_epi32((int32_t)0x80000000u);
+    __m128i low = _mm_set_epi32(0, -1, 0, -1);
+    __m128i even = _mm_srl_epi64(_mm_mul_epu32(off, magic), shift);
+    __m128i odd = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(off, 32), magic), shift);
+
+    *inside = _mm_cmpgt_epi32(span, _mm_xor_si128(off, sign));
+    return _mm_or_si128(_mm_or_si128(_mm_and_si128(even, low), _mm_slli_epi64(odd, 32)),
+                        _mm_xor_si128(*inside, _mm_set1_epi32(-1)));
+}
+
+static size_t etimer_bin_sum(__m128i acc)
+{
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+    return (uint32_t)_mm_cvtsi128_si32(acc);
+}
+#endif
+
+static size_t etimer_bin_block(const struct etimer_bin *bin, const uint32_t *times, size_t n,
+                               uint32_t base, uint32_t *index)
+{
+    size_t inside = 0, i = 0;
+
+#if defined(__AVX2__)
+    {
+        __m256i vbase = _mm256_set1_epi32((int32_t)base);
+        __m256i vmax = _mm256_set1_epi32((int32_t)bin->max_value);
+        __m256i span = _mm256_set1_epi32((int32_t)(bin->span ^ 0x80000000u));
+        __m256i magic = _mm256_set1_epi32((int32_t)bin->magic);
+        __m128i shift = _mm_cvtsi32_si128((int)bin->shift);
+        __m256i acc = _mm256_setzero_si256(), in;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i off = _mm256_loadu_si256((const __m256i *)(times + i));
+            off = _mm256_and_si256(_mm256_sub_epi32(off, vbase), vmax);
+            _mm256_storeu_si256((__m256i *)(index + i),
+                                etimer_bin_avx2(off, span, magic, shift, &in));
+            acc = _mm256_sub_epi32(acc, in);
+        }
+        inside = etimer_bin_sum(acc);
+    }
+#elif defined(__SSE2__)
+    {
+        __m128i vbase = _mm_set1_epi32((int32_t)base);
+        __m128i vmax = _mm_set1_epi32((int32_t)bin->max_value);
+        __m128i span = _mm_set1_epi32((int32_t)(bin->span ^ 0x80000000u));
+        __m128i magic = _mm_set1_epi32((int32_t)bin->magic);
+        __m128i shift = _mm_cvtsi32_si128((int)bin->shift);
+        __m128i acc = _mm_setzero_si128(), in;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i off = _mm_loadu_si128((const __m128i *)(times + i));
+            off = _mm_and_si128(_mm_sub_epi32(off, vbase), vmax);
+            _mm_storeu_si128((__m128i *)(index + i),
+                             etimer_bin_sse2(off, span, magic, shift, &in));
+            acc = _mm_sub_epi32(acc, in);
+        }
+        inside = etimer_bin_sum(acc);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        index[i] = etimer_bin_one(bin, times[i], base);
+        inside += index[i] != ETIMER_BIN_NONE;
+    }
+
+    return inside;
+}
+
+static size_t etimer16_bin_block(const struct etimer_bin *bin, const uint16_t *times, size_t n,
+                                 uint32_t base, uint32_t *index)
+{
+    size_t inside = 0, i = 0;
+
+    // widened to 32-bit lanes, the distance may need all 16 bits
+#if defined(__AVX2__)
+    {
+        __m256i vbase = _mm256_set1_epi32((int32_t)base);
+        __m256i vmax = _mm256_set1_epi32((int32_t)bin->max_value);
+        __m256i span = _mm256_set1_epi32((int32_t)(bin->span ^ 0x80000000u));
+        __m256i magic = _mm256_set1_epi32((int32_t)bin->magic);
+        __m128i shift = _mm_cvtsi32_si128((int)bin->shift);
+        __m256i acc = _mm256_setzero_si256(), in;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i off = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(times + i)));
+            off = _mm256_and_si256(_mm256_sub_epi32(off, vbase), vmax);
+            _mm256_storeu_si256((__m256i *)(index + i),
+                                etimer_bin_avx2(off, span, magic, shift, &in));
+            acc = _mm256_sub_epi32(acc, in);
+        }
+        inside = etimer_bin_sum(acc);
+    }
+#elif defined(__SSE2__)
+    {
+        __m128i vbase = _mm_set1_epi32((int32_t)base);
+        __m128i vmax = _mm_set1_epi32((int32_t)bin->max_value);
+        __m128i span = _mm_set1_epi32((int32_t)(bin->span ^ 0x80000000u));
+        __m128i magic = _mm_set1_epi32((int32_t)bin->magic);
+        __m128i shift = _mm_cvtsi32_si128((int)bin->shift);
+        __m128i zero = _mm_setzero_si128();
+        __m128i acc = _mm_setzero_si128(), in;
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(times + i));
+            __m128i lo = _mm_and_si128(_mm_sub_epi32(_mm_unpacklo_epi16(v, zero), vbase), vmax);
+            __m128i hi = _mm_and_si128(_mm_sub_epi32(_mm_unpackhi_epi16(v, zero), vbase), vmax);
+            _mm_storeu_si128((__m128i *)(index + i),
+                             etimer_bin_sse2(lo, span, magic, shift, &in));
+            acc = _mm_sub_epi32(acc, in);
+            _mm_storeu_si128((__m128i *)(index + i + 4),
+                             etimer_bin_sse2(hi, span, magic, shift, &in));
+            acc = _mm_sub_epi32(acc, in);
+        }
+        inside = etimer_bin_sum(acc);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        index[i] = etimer_bin_one(bin, times[i], base);
+        inside += index[i] != ETIMER_BIN_NONE;
+    }
+
+    return inside;
+}
+
+static void etimer_bin_count(const uint32_t *index, size_t n, uint32_t *counts)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (index[i] != ETIMER_BIN_NONE)
+        {
+            counts[index[i]]++;
+        }
+    }
+}
+
+size_t etimer_bin_raw(const struct etimer_bin *bin, const uint32_t *times, size_t n,
+                      uint32_t base, uint32_t *index, uint32_t *counts)
+{
+    uint32_t block[ETIMER_BIN_BLOCK], *out;
+    size_t inside = 0, i, len;
+
+    for (i = 0; i < n; i += len)
+    {
+        len = n - i < ETIMER_BIN_BLOCK ? n - i : ETIMER_BIN_BLOCK;
+        out = index != NULL ? index + i : block;
+        inside += etimer_bin_block(bin, times + i, len, base, out);
+        if (counts != NULL)
+        {
+            etimer_bin_count(out, len, counts);
+        }
+    }
+
+    return inside;
+}
+
+size_t etimer16_bin_raw(const struct etimer_bin *bin, const uint16_t *times, size_t n,
+                        uint16_t base, uint32_t *index, uint32_t *counts)
+{
+    uint32_t block[ETIMER_BIN_BLOCK], *out;
+    size_t inside = 0, i, len;
+
+    for (i = 0; i < n; i += len)
+    {
+        len = n - i < ETIMER_BIN_BLOCK ? n - i : ETIMER_BIN_BLOCK;
+        out = index != NULL ? index + i : block;
+        inside += etimer16_bin_block(bin, times + i, len, base, out);
+        if (counts != NULL)
+        {
+            etimer_bin_count(out, len, counts);
+        }
+    }
+
+    return inside;
+}
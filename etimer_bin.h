@@ -0,0 +1,97 @@
+#ifndef _ETIMER_BIN_H_
+#define _ETIMER_BIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Timestamps mapped to fixed-width bins of a window starting at a base time, for activity
+ * histograms. A time is in the window when etimer_sub_raw(time, base) is 0 to bins * width - 1
+ * and its bin is that distance divided by the width; other times, before the base or past the
+ * window wherever they sit relative to the wrap, get ETIMER_BIN_NONE. The window may span up to
+ * half the domain.
+ *
+ * The division is a multiply by a reciprocal computed once per binner, exact for every distance
+ * in the window. The batch functions use AVX2 or SSE2 when the compiler targets them and
+ * etimer_bin_one() for the remainder, their results are identical.
+ */
+
+#define ETIMER_BIN_NONE (~(uint32_t)0)
+
+struct etimer_bin
+{
+    uint32_t max_value;
+    uint32_t width;
+    uint32_t bins;
+    uint32_t span;  /* bins * width */
+    uint32_t magic; /* ceil(2^shift / width) */
+    uint32_t shift;
+};
+
+/**
+ * @brief  Set up a binner.
+ * @param[out] bin: Binner.
+ * @param[in]  width: Bin width in ticks.
+ * @param[in]  bins: Number of bins.
+ * @param[in]  max_value: Max time value of the domain, max_value + 1 a power of 2. Pass 0xFFFF
+ * for etimer16 times, ETIMER16_MAX_VALUE promotes to an all ones int.
+ * @return 0 on success, -EINVAL for a zero size, a window over half the domain or a bad max_value.
+ */
+int etimer_bin_init(struct etimer_bin *bin, uint32_t width, uint32_t bins, uint32_t max_value);
+
+/**
+ * @brief  Bin of one time, branch free apart from the window check.
+ * @param[in]  bin: Binner.
+ * @param[in]  time: Time, 0 to max_value.
+ * @param[in]  base: Start of the window.
+ * @return bin index, ETIMER_BIN_NONE out of the window.
+ */
+static inline uint32_t etimer_bin_one(const struct etimer_bin *bin, uint32_t time, uint32_t base)
+{
+    uint32_t off = (time - base) & bin->max_value;
+
+    if (off >= bin->span)
+    {
+        return ETIMER_BIN_NONE;
+    }
+    return (uint32_t)(((uint64_t)off * bin->magic) >> bin->shift);
+}
+
+/**
+ * @brief  Bin n times held in 32 bits.
+ * @param[in]  bin: Binner.
+ * @param[in]  times: Times, 0 to max_value.
+ * @param[in]  n: Number of times.
+ * @param[in]  base: Start of the window.
+ * @param[out] index: Bin of each time, ETIMER_BIN_NONE out of the window, may be NULL.
+ * @param[in,out] counts: bins counters incremented per time in the window, may be NULL.
+ * @return number of times in the window.
+ */
+size_t etimer_bin_raw(const struct etimer_bin *bin, const uint32_t *times, size_t n,
+                      uint32_t base, uint32_t *index, uint32_t *counts);
+
+/**
+ * @brief  Bin n times held in 16 bits.
+ * @param[in]  bin: Binner, max_value up to 0xFFFF.
+ * @param[in]  times: Times, 0 to max_value.
+ * @param[in]  n: Number of times.
+ * @param[in]  base: Start of the window.
+ * @param[out] index: Bin of each time, ETIMER_BIN_NONE out of the window, may be NULL.
+ * @param[in,out] counts: bins counters incremented per time in the window, may be NULL.
+ * @return number of times in the window.
+ */
+size_t etimer16_bin_raw(const struct etimer_bin *bin, const uint16_t *times, size_t n,
+                        uint16_t base, uint32_t *index, uint32_t *counts);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_BIN_H_ */
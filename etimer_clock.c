@@ -0,0 +1,25 @@
+#include <errno.h>
+
+#include "etimer_clock.h"
+
+int etimer_clock_init(struct etimer_clock *clock, uint32_t max_value, uint32_t (*read)(void),
+                      int (*pending)(void), void (*clear)(void))
+{
+    if (max_value == 0 || (max_value & (max_value + 1)) != 0)
+    {
+        return -EINVAL;
+    }
+
+    clock->read = read;
+    clock->pending = pending;
+    clock->clear = clear;
+    clock->max_value = max_value;
+    clock->shift = 0;
+    while (clock->shift < 32 && (max_value >> clock->shift) != 0)
+    {
+        clock->shift++;
+    }
+    clock->seq = 0;
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#ifndef _ETIMER_CLOCK_H_
+#define _ETIMER_CLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * 32-bit time in the etimer domain from a narrow hardware counter and a software overflow count,
+ * read without masking interrupts. The overflow handler bumps a sequence before and after
+ * clearing the overflow flag, and the overflow count is half the sequence rounded up. A reader
+ * interrupting the handler therefore sees a count that already includes the overflow being
+ * handled and never waits for the handler. A reader interrupted by the handler sees the sequence
+ * move and reads again, which happens at most once per overflow.
+ *
+ * An overflow the handler has not serviced yet, because interrupts are held off or the reader
+ * runs at a higher priority, is caught through the pending callback reporting the hardware
+ * overflow flag. Without one, reads are exact only where the overflow interrupt is taken as soon
+ * as the counter wraps. Either way the handler must run within one period of the counter.
+ */
+
+struct etimer_clock
+{
+    uint32_t (*read)(void); /* hardware counter, 0 to max_value */
+    int (*pending)(void);   /* resulting 1 means the overflow flag is raised, may be NULL */
+    void (*clear)(void);    /* clear the overflow flag, may be NULL */
+    uint32_t max_value;
+    uint32_t shift; /* bits of the hardware counter */
+    uint32_t seq;   /* twice the overflow count, odd inside the overflow handler */
+};
+
+/**
+ * @brief  Set up a composite clock starting at overflow count 0.
+ * @param[out] clock: Composite clock.
+ * @param[in]  max_value: Max value of the hardware counter, max_value + 1 a power of 2.
+ * @param[in]  read: Read the hardware counter.
+ * @param[in]  pending: Read the hardware overflow flag, or NULL.
+ * @param[in]  clear: Clear the hardware overflow flag, or NULL.
+ * @return 0 on success, -EINVAL if max_value + 1 is not a power of 2.
+ */
+int etimer_clock_init(struct etimer_clock *clock, uint32_t max_value, uint32_t (*read)(void),
+                      int (*pending)(void), void (*clear)(void));
+
+/**
+ * @brief  Account one hardware overflow, called from the overflow interrupt only. Clears the
+ * overflow flag through the clear callback.
+ * @param[in]  clock: Composite clock.
+ */
+static inline void etimer_clock_overflow(struct etimer_clock *clock)
+{
+    __atomic_store_n(&clock->seq, clock->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (clock->clear != NULL)
+    {
+        clock->clear();
+    }
+    __atomic_store_n(&clock->seq, clock->seq + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief  Read the composite time, from any context including interrupts.
+ * @param[in]  clock: Composite clock.
+ * @return current time, wrapping at 2^32 like ETIMER_MAX_VALUE.
+ */
+static inline uint32_t etimer_clock_read(struct etimer_clock *clock)
+{
+    uint32_t seq, hw, epoch;
+
+    do
+    {
+        seq = __atomic_load_n(&clock->seq, __ATOMIC_ACQUIRE);
+        hw = clock->read();
+        epoch = (seq + 1) >> 1;
+        if ((seq & 1) == 0 && clock->pending != NULL && clock->pending())
+        {
+            // wrapped and not handled yet, the first read may predate the wrap
+            hw = clock->read();
+            epoch++;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while (__atomic_load_n(&clock->seq, __ATOMIC_RELAXED) != seq);
+
+    return (uint32_t)(((uint64_t)epoch << clock->shift) | hw);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_CLOCK_H_ */
@@ -0,0 +1,340 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_compact.h"
+
+#define ETIMER_COMPACT_MIN_CAP 4
+
+/**
+ * @brief  Double the room of a pair of parallel arrays, the handles and their times.
+ */
+static int etimer_compact_grow(void **first, size_t first_size, uint32_t **handles, uint32_t *cap)
+{
+    uint32_t next = *cap ? *cap * 2 : ETIMER_COMPACT_MIN_CAP;
+    void *a = realloc(*first, (size_t)next * first_size);
+    uint32_t *b;
+
+    if (a == NULL)
+    {
+        return -ENOMEM;
+    }
+    *first = a;
+    b = realloc(*handles, (size_t)next * sizeof(*b));
+    if (b == NULL)
+    {
+        return -ENOMEM;
+    }
+    *handles = b;
+    *cap = next;
+    return 0;
+}
+
+/**
+ * @brief  Put a timer in the bucket of its deadline, or in the far list beyond the horizon.
+ */
+static int etimer_compact_insert(struct etimer_compact *compact, uint32_t handle,
+                                 uint32_t deadline)
+{
+    uint32_t horizon = (compact->mask + 1) << compact->shift;
+    int32_t rel = etimer_sub(deadline, compact->cursor);
+    struct etimer_compact_bucket *bucket;
+    uint32_t slot;
+
+    if (rel < 0)
+    {
+        deadline = compact->cursor;
+        rel = 0;
+    }
+
+    if ((uint32_t)rel >= horizon)
+    {
+        if (compact->far_count == compact->far_cap &&
+            etimer_compact_grow((void **)&compact->far_deadlines, sizeof(uint32_t),
+                                &compact->far_handles, &compact->far_cap) != 0)
+        {
+            return -ENOMEM;
+        }
+        compact->far_deadlines[compact->far_count] = deadline;
+        compact->far_handles[compact->far_count] = handle;
+        compact->where[handle] = (uint16_t)(compact->mask + 1);
+        compact->pos[handle] = compact->far_count++;
+        return 0;
+    }
+
+    slot = (deadline >> compact->shift) & compact->mask;
+    bucket = &compact->buckets[slot];
+    if (bucket->count == bucket->cap &&
+        etimer_compact_grow((void **)&bucket->offs, sizeof(uint16_t), &bucket->handles,
+                            &bucket->cap) != 0)
+    {
+        return -ENOMEM;
+    }
+    if (bucket->count == 0)
+    {
+        bucket->base = deadline & ~((1u << compact->shift) - 1);
+    }
+    bucket->offs[bucket->count] = (uint16_t)deadline;
+    bucket->handles[bucket->count] = handle;
+    compact->where[handle] = (uint16_t)slot;
+    compact->pos[handle] = bucket->count++;
+    compact->wheel_count++;
+    return 0;
+}
+
+/**
+ * @brief  Move the far timers now within the horizon into the wheel, every half lap.
+ */
+static void etimer_compact_refill(struct etimer_compact *compact)
+{
+    uint32_t horizon = (compact->mask + 1) << compact->shift;
+    uint32_t i = 0, handle, deadline, last;
+
+    while (i < compact->far_count)
+    {
+        deadline = compact->far_deadlines[i];
+        if (etimer_sub(deadline, compact->cursor) < (int32_t)horizon)
+        {
+            handle = compact->far_handles[i];
+            last = --compact->far_count;
+            compact->far_deadlines[i] = compact->far_deadlines[last];
+            compact->far_handles[i] = compact->far_handles[last];
+            compact->pos[compact->far_handles[i]] = i;
+            // room in the wheel was there before, only a failed grow can refuse it
+            if (etimer_compact_insert(compact, handle, deadline) != 0)
+            {
+                compact->far_deadlines[compact->far_count] = deadline;
+                compact->far_handles[compact->far_count] = handle;
+                compact->pos[handle] = compact->far_count++;
+                return;
+            }
+            continue;
+        }
+        i++;
+    }
+}
+
+int etimer_compact_init(struct etimer_compact *compact, uint32_t capacity, uint32_t granule,
+                        uint32_t slots, uint32_t now)
+{
+    uint32_t count = 2, i;
+
+    memset(compact, 0, sizeof(*compact));
+    if (granule == 0 || granule > 0x8000 || slots == 0 || slots > 0x4000 ||
+        capacity == ETIMER_COMPACT_NONE)
+    {
+        return -EINVAL;
+    }
+    while ((1u << compact->shift) < granule)
+    {
+        compact->shift++;
+    }
+    while (count < slots)
+    {
+        count <<= 1;
+    }
+    // deadlines up to the horizon and the overflow apart stay ordered
+    if (((uint64_t)count << compact->shift) > ETIMER_MAX_VALUE_OVERFLOW / 2)
+    {
+        return -EINVAL;
+    }
+
+    compact->buckets = calloc(count, sizeof(*compact->buckets));
+    compact->where = malloc((size_t)capacity * sizeof(*compact->where));
+    compact->pos = malloc((size_t)capacity * sizeof(*compact->pos));
+    if (compact->buckets == NULL || (capacity && (compact->where == NULL || compact->pos == NULL)))
+    {
+        etimer_compact_deinit(compact);
+        return -ENOMEM;
+    }
+
+    // lowest handles first
+    for (i = 0; i < capacity; i++)
+    {
+        compact->where[i] = ETIMER_COMPACT_FREE;
+        compact->pos[i] = i + 1 < capacity ? i + 1 : ETIMER_COMPACT_NONE;
+    }
+    compact->free_head = capacity ? 0 : ETIMER_COMPACT_NONE;
+    compact->mask = count - 1;
+    compact->cursor = now & ~((1u << compact->shift) - 1);
+    compact->capacity = capacity;
+
+    return 0;
+}
+
+void etimer_compact_deinit(struct etimer_compact *compact)
+{
+    uint32_t i;
+
+    if (compact->buckets != NULL)
+    {
+        for (i = 0; i <= compact->mask; i++)
+        {
+            free(compact->buckets[i].offs);
+            free(compact->buckets[i].handles);
+        }
+    }
+    free(compact->buckets);
+    free(compact->far_deadlines);
+    free(compact->far_handles);
+    free(compact->where);
+    free(compact->pos);
+    memset(compact, 0, sizeof(*compact));
+}
+
+uint32_t etimer_compact_add(struct etimer_compact *compact, uint32_t deadline)
+{
+    uint32_t handle = compact->free_head;
+
+    if (handle == ETIMER_COMPACT_NONE)
+    {
+        return ETIMER_COMPACT_NONE;
+    }
+
+    compact->free_head = compact->pos[handle];
+    if (etimer_compact_insert(compact, handle, deadline) != 0)
+    {
+        compact->pos[handle] = compact->free_head;
+        compact->free_head = handle;
+        return ETIMER_COMPACT_NONE;
+    }
+    compact->count++;
+
+    return handle;
+}
+
+static void etimer_compact_free(struct etimer_compact *compact, uint32_t handle)
+{
+    compact->where[handle] = ETIMER_COMPACT_FREE;
+    compact->pos[handle] = compact->free_head;
+    compact->free_head = handle;
+    compact->count--;
+}
+
+int etimer_compact_cancel(struct etimer_compact *compact, uint32_t handle)
+{
+    uint32_t where, pos, last;
+    struct etimer_compact_bucket *bucket;
+
+    if (handle >= compact->capacity || compact->where[handle] == ETIMER_COMPACT_FREE)
+    {
+        return -EINVAL;
+    }
+
+    where = compact->where[handle];
+    pos = compact->pos[handle];
+    if (where > compact->mask)
+    {
+        last = --compact->far_count;
+        compact->far_deadlines[pos] = compact->far_deadlines[last];
+        compact->far_handles[pos] = compact->far_handles[last];
+        compact->pos[compact->far_handles[pos]] = pos;
+    }
+    else
+    {
+        bucket = &compact->buckets[where];
+        last = --bucket->count;
+        bucket->offs[pos] = bucket->offs[last];
+        bucket->handles[pos] = bucket->handles[last];
+        compact->pos[bucket->handles[pos]] = pos;
+        compact->wheel_count--;
+    }
+    etimer_compact_free(compact, handle);
+
+    return 0;
+}
+
+size_t etimer_compact_expire(struct etimer_compact *compact, uint32_t now, uint32_t *handles,
+                             size_t max)
+{
+    uint32_t granule = 1u << compact->shift, half = (compact->mask + 1) / 2;
+    struct etimer_compact_bucket *bucket;
+    uint16_t now16 = (uint16_t)now;
+    uint32_t handle, last, i;
+    size_t n = 0;
+
+    while (n < max)
+    {
+        // nothing in the wheel, skip to the bucket of now
+        if (compact->wheel_count == 0 && etimer_sub(now, compact->cursor) >= (int32_t)granule)
+        {
+            compact->cursor = now & ~(granule - 1);
+            etimer_compact_refill(compact);
+        }
+
+        bucket = &compact->buckets[(compact->cursor >> compact->shift) & compact->mask];
+        if (etimer_sub(now, compact->cursor + granule - 1) >= 0)
+        {
+            // the whole window has passed
+            while (bucket->count && n < max)
+            {
+                handle = bucket->handles[--bucket->count];
+                compact->wheel_count--;
+                etimer_compact_free(compact, handle);
+                handles[n++] = handle;
+            }
+            if (bucket->count)
+            {
+                break;
+            }
+            compact->cursor += granule;
+            if (((compact->cursor >> compact->shift) & (half - 1)) == 0)
+            {
+                etimer_compact_refill(compact);
+            }
+            continue;
+        }
+
+        if (etimer_sub(now, compact->cursor) < 0)
+        {
+            break;
+        }
+        // now is inside the window, the low halves compare like the deadlines
+        for (i = 0; i < bucket->count && n < max;)
+        {
+            if (etimer16_sub(bucket->offs[i], now16) > 0)
+            {
+                i++;
+                continue;
+            }
+            handle = bucket->handles[i];
+            last = --bucket->count;
+            bucket->offs[i] = bucket->offs[last];
+            bucket->handles[i] = bucket->handles[last];
+            compact->pos[bucket->handles[i]] = i;
+            compact->wheel_count--;
+            etimer_compact_free(compact, handle);
+            handles[n++] = handle;
+        }
+        break;
+    }
+
+    return n;
+}
+
+uint32_t etimer_compact_deadline(const struct etimer_compact *compact, uint32_t handle)
+{
+    const struct etimer_compact_bucket *bucket;
+    uint32_t where = compact->where[handle], pos = compact->pos[handle];
+
+    if (where > compact->mask)
+    {
+        return compact->far_deadlines[pos];
+    }
+    bucket = &compact->buckets[where];
+    return bucket->base + (uint16_t)(bucket->offs[pos] - (uint16_t)bucket->base);
+}
+
+size_t etimer_compact_memory(const struct etimer_compact *compact)
+{
+    size_t bytes = (size_t)(compact->mask + 1) * sizeof(*compact->buckets);
+    uint32_t i;
+
+    for (i = 0; i <= compact->mask; i++)
+    {
+        bytes += (size_t)compact->buckets[i].cap * (sizeof(uint16_t) + sizeof(uint32_t));
+    }
+    bytes += (size_t)compact->far_cap * 2 * sizeof(uint32_t);
+    bytes += (size_t)compact->capacity * (sizeof(*compact->where) + sizeof(*compact->pos));
+    return bytes;
+}
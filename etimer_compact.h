@@ -0,0 +1,121 @@
+#ifndef _ETIMER_COMPACT_H_
+#define _ETIMER_COMPACT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Compact timing wheel for millions of pending timers. Each bucket keeps the 32-bit base of its
+ * window and dense arrays of the 16-bit low halves of its deadlines and of the handles; a window
+ * spans at most half the etimer16 range, so within it etimer16_sub() orders the low halves like
+ * the full deadlines. Handles are 32-bit indexes into a structure of arrays pool holding the
+ * bucket and the position of each timer, 12 bytes per timer in all.
+ *
+ * A bucket whose window has fully passed expires whole without a comparison, only the bucket of
+ * now compares its offsets. Timers beyond the slots * granule horizon wait in a far list holding
+ * full deadlines and enter the wheel every half lap.
+ */
+
+#define ETIMER_COMPACT_NONE (~(uint32_t)0)
+#define ETIMER_COMPACT_FREE 0xFFFF /* bucket of a free handle */
+
+struct etimer_compact_bucket
+{
+    uint16_t *offs;    /* low halves of the deadlines */
+    uint32_t *handles;
+    uint32_t base;     /* start of the window */
+    uint32_t count;
+    uint32_t cap;
+};
+
+struct etimer_compact
+{
+    struct etimer_compact_bucket *buckets;
+    uint32_t *far_deadlines;
+    uint32_t *far_handles;
+    uint32_t far_count;
+    uint32_t far_cap;
+    uint16_t *where; /* per handle: bucket, slots for the far list, or ETIMER_COMPACT_FREE */
+    uint32_t *pos;   /* per handle: index in its bucket, or next free handle */
+    uint32_t mask;   /* slots - 1 */
+    uint32_t shift;  /* granule is 1 << shift ticks */
+    uint32_t cursor; /* start of the window of the first bucket not passed */
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t wheel_count; /* timers in the buckets, the far list excluded */
+    uint32_t free_head;
+};
+
+/**
+ * @brief  Allocate the wheel and the handle pool, buckets grow on demand.
+ * @param[out] compact: Wheel.
+ * @param[in]  capacity: Max number of pending timers.
+ * @param[in]  granule: Bucket width in ticks, rounded up to a power of 2 up to 0x8000.
+ * @param[in]  slots: Number of buckets, rounded up to a power of 2, 2 to 0x4000.
+ * @param[in]  now: Current absolute time.
+ * @return 0 on success, -EINVAL for bad sizes, -ENOMEM on failure.
+ */
+int etimer_compact_init(struct etimer_compact *compact, uint32_t capacity, uint32_t granule,
+                        uint32_t slots, uint32_t now);
+
+/**
+ * @brief  Free the wheel.
+ * @param[in]  compact: Wheel.
+ */
+void etimer_compact_deinit(struct etimer_compact *compact);
+
+/**
+ * @brief  Start a timer. A deadline already passed expires at the next etimer_compact_expire().
+ * @param[in]  compact: Wheel.
+ * @param[in]  deadline: Absolute deadline, less than ETIMER_MAX_VALUE_OVERFLOW ahead.
+ * @return handle, ETIMER_COMPACT_NONE if full or out of memory.
+ */
+uint32_t etimer_compact_add(struct etimer_compact *compact, uint32_t deadline);
+
+/**
+ * @brief  Stop a pending timer, its handle may be reused.
+ * @param[in]  compact: Wheel.
+ * @param[in]  handle: Handle returned by etimer_compact_add().
+ * @return 0 on success, -EINVAL if the timer is not pending.
+ */
+int etimer_compact_cancel(struct etimer_compact *compact, uint32_t handle);
+
+/**
+ * @brief  Take the timers whose deadline is not after now, expired handles may be reused. When
+ * handles fills up, the next call resumes where this one stopped.
+ * @param[in]  compact: Wheel.
+ * @param[in]  now: Current absolute time, called at least once per ETIMER_MAX_VALUE_OVERFLOW.
+ * @param[out] handles: Expired timers.
+ * @param[in]  max: Size of handles.
+ * @return number of handles written.
+ */
+size_t etimer_compact_expire(struct etimer_compact *compact, uint32_t now, uint32_t *handles,
+                             size_t max);
+
+/**
+ * @brief  Full deadline of a pending timer, rebuilt from its bucket base and offset.
+ * @param[in]  compact: Wheel.
+ * @param[in]  handle: Pending timer.
+ * @return absolute deadline, later than requested by at most the time it was already passed.
+ */
+uint32_t etimer_compact_deadline(const struct etimer_compact *compact, uint32_t handle);
+
+/**
+ * @brief  Bytes allocated, spare room of the buckets included.
+ * @param[in]  compact: Wheel.
+ * @return bytes.
+ */
+size_t etimer_compact_memory(const struct etimer_compact *compact);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_COMPACT_H_ */
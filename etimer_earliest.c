@@ -0,0 +1,175 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "etimer_earliest.h"
+
+#define ETIMER_EARLIEST_SET (1ull << 32)
+
+/**
+ * @brief  Deadline relative to now, those due for long are raised to -ETIMER_EARLIEST_PIN.
+ */
+static inline int32_t etimer_earliest_rel(uint32_t deadline, uint32_t now)
+{
+    int32_t rel = etimer_sub(deadline, now);
+
+    return rel < -(int32_t)ETIMER_EARLIEST_PIN ? -(int32_t)ETIMER_EARLIEST_PIN : rel;
+}
+
+/**
+ * @brief  Load the register, pinning a deadline due for long before it ages into the future.
+ * @return resulting 1 means a deadline is held, rel is then relative to now.
+ */
+static int etimer_earliest_load(struct etimer_earliest *reg, uint32_t now, uint64_t *word,
+                                int32_t *rel)
+{
+    uint64_t pinned = ETIMER_EARLIEST_SET | (uint32_t)(now - ETIMER_EARLIEST_PIN);
+
+    *word = __atomic_load_n(&reg->word, __ATOMIC_ACQUIRE);
+    for (;;)
+    {
+        if (*word == ETIMER_EARLIEST_EMPTY)
+        {
+            return 0;
+        }
+        *rel = etimer_sub((uint32_t)*word, now);
+        if (*rel >= -(int32_t)ETIMER_EARLIEST_PIN)
+        {
+            return 1;
+        }
+        if (__atomic_compare_exchange_n(&reg->word, word, pinned, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            *word = pinned;
+            *rel = -(int32_t)ETIMER_EARLIEST_PIN;
+            return 1;
+        }
+    }
+}
+
+int etimer_earliest_update(struct etimer_earliest *reg, uint32_t deadline, uint32_t now)
+{
+    int32_t rel = etimer_earliest_rel(deadline, now), held;
+    uint64_t word = ETIMER_EARLIEST_SET | (uint32_t)(now + rel), expected;
+
+    for (;;)
+    {
+        if (etimer_earliest_load(reg, now, &expected, &held) && rel >= held)
+        {
+            return 0;
+        }
+        if (__atomic_compare_exchange_n(&reg->word, &expected, word, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE))
+        {
+            return 1;
+        }
+    }
+}
+
+int etimer_earliest_get(struct etimer_earliest *reg, uint32_t now, uint32_t *deadline)
+{
+    uint64_t word;
+    int32_t rel;
+
+    if (!etimer_earliest_load(reg, now, &word, &rel))
+    {
+        return 0;
+    }
+    *deadline = (uint32_t)word;
+    return 1;
+}
+
+int etimer_earliest_take(struct etimer_earliest *reg, uint32_t now, uint32_t *deadline)
+{
+    uint64_t word = __atomic_exchange_n(&reg->word, ETIMER_EARLIEST_EMPTY, __ATOMIC_ACQ_REL);
+
+    if (word == ETIMER_EARLIEST_EMPTY)
+    {
+        return 0;
+    }
+    *deadline = now + etimer_earliest_rel((uint32_t)word, now);
+    return 1;
+}
+
+int etimer_earliest_shards_init(struct etimer_earliest_shards *set, uint32_t count)
+{
+    uint32_t i;
+
+    set->shards = NULL;
+    set->count = 0;
+    if (count == 0)
+    {
+        return -EINVAL;
+    }
+
+    if (posix_memalign((void **)&set->shards, 64, (size_t)count * sizeof(*set->shards)) != 0)
+    {
+        set->shards = NULL;
+        return -ENOMEM;
+    }
+    for (i = 0; i < count; i++)
+    {
+        etimer_earliest_init(&set->shards[i]);
+    }
+    set->count = count;
+
+    return 0;
+}
+
+void etimer_earliest_shards_deinit(struct etimer_earliest_shards *set)
+{
+    free(set->shards);
+    set->shards = NULL;
+    set->count = 0;
+}
+
+int etimer_earliest_shards_get(struct etimer_earliest_shards *set, uint32_t now,
+                               uint32_t *deadline)
+{
+    int32_t best = 0, rel;
+    uint64_t word;
+    uint32_t i;
+    int found = 0;
+
+    // every shard is visited, which also pins the idle ones
+    for (i = 0; i < set->count; i++)
+    {
+        if (etimer_earliest_load(&set->shards[i], now, &word, &rel) && (!found || rel < best))
+        {
+            best = rel;
+            found = 1;
+        }
+    }
+    if (found)
+    {
+        *deadline = now + best;
+    }
+    return found;
+}
+
+int etimer_earliest_shards_take(struct etimer_earliest_shards *set, uint32_t now,
+                                uint32_t *deadline)
+{
+    int32_t best = 0, rel;
+    uint32_t i, taken;
+    int found = 0;
+
+    for (i = 0; i < set->count; i++)
+    {
+        if (etimer_earliest_take(&set->shards[i], now, &taken))
+        {
+            rel = etimer_sub(taken, now);
+            if (!found || rel < best)
+            {
+                best = rel;
+                found = 1;
+            }
+        }
+    }
+    if (found)
+    {
+        *deadline = now + best;
+    }
+    return found;
+}
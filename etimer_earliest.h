@@ -0,0 +1,129 @@
+#ifndef _ETIMER_EARLIEST_H_
+#define _ETIMER_EARLIEST_H_
+
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Lock-free register holding the earliest of the deadlines published by many threads, so that one
+ * idle thread can sleep until the global minimum. An update is stored only when it is earlier
+ * than the held deadline relative to the caller's now, most updates are thus a single load.
+ *
+ * A held deadline ages as now moves on, and one left due for more than ETIMER_MAX_VALUE_OVERFLOW
+ * would compare as far ahead. Any access seeing it due by more than ETIMER_EARLIEST_PIN pins it
+ * to now - ETIMER_EARLIEST_PIN, so it stays due as long as the register is accessed at least
+ * once per ETIMER_EARLIEST_PIN ticks. Cap the idle sleep there when nothing else wakes it.
+ */
+
+#define ETIMER_EARLIEST_PIN   (ETIMER_MAX_VALUE_OVERFLOW / 2)
+#define ETIMER_EARLIEST_EMPTY 0ull /* deadline held in the low half, bit 32 set */
+
+struct etimer_earliest
+{
+    uint64_t word __attribute__((aligned(64)));
+};
+
+/**
+ * Sharded register, updates go to the caller's shard and readers take the minimum of all shards.
+ */
+struct etimer_earliest_shards
+{
+    struct etimer_earliest *shards;
+    uint32_t count;
+};
+
+/**
+ * @brief  Empty the register.
+ * @param[out] reg: Register.
+ */
+static inline void etimer_earliest_init(struct etimer_earliest *reg)
+{
+    __atomic_store_n(&reg->word, ETIMER_EARLIEST_EMPTY, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief  Publish a deadline, kept if earlier than the one held. Any thread.
+ * @param[in]  reg: Register.
+ * @param[in]  deadline: Absolute deadline.
+ * @param[in]  now: Current absolute time.
+ * @return resulting 1 means the deadline was stored.
+ */
+int etimer_earliest_update(struct etimer_earliest *reg, uint32_t deadline, uint32_t now);
+
+/**
+ * @brief  Read the earliest deadline, pinning it when due for long.
+ * @param[in]  reg: Register.
+ * @param[in]  now: Current absolute time.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a deadline is held.
+ */
+int etimer_earliest_get(struct etimer_earliest *reg, uint32_t now, uint32_t *deadline);
+
+/**
+ * @brief  Take the earliest deadline and empty the register, the publishers must then publish
+ * their next deadline again.
+ * @param[in]  reg: Register.
+ * @param[in]  now: Current absolute time.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a deadline was held.
+ */
+int etimer_earliest_take(struct etimer_earliest *reg, uint32_t now, uint32_t *deadline);
+
+/**
+ * @brief  Allocate count empty shards, one cache line each.
+ * @param[out] set: Sharded register.
+ * @param[in]  count: Number of shards, usually one per publishing thread.
+ * @return 0 on success, -EINVAL for no shard, -ENOMEM on failure.
+ */
+int etimer_earliest_shards_init(struct etimer_earliest_shards *set, uint32_t count);
+
+/**
+ * @brief  Free the shards.
+ * @param[in]  set: Sharded register.
+ */
+void etimer_earliest_shards_deinit(struct etimer_earliest_shards *set);
+
+/**
+ * @brief  Publish a deadline to a shard.
+ * @param[in]  set: Sharded register.
+ * @param[in]  shard: Shard of the calling thread, taken modulo the shard count.
+ * @param[in]  deadline: Absolute deadline.
+ * @param[in]  now: Current absolute time.
+ * @return resulting 1 means the deadline was stored.
+ */
+static inline int etimer_earliest_shards_update(struct etimer_earliest_shards *set,
+                                                uint32_t shard, uint32_t deadline, uint32_t now)
+{
+    return etimer_earliest_update(&set->shards[shard % set->count], deadline, now);
+}
+
+/**
+ * @brief  Read the earliest deadline of all shards.
+ * @param[in]  set: Sharded register.
+ * @param[in]  now: Current absolute time.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a deadline is held.
+ */
+int etimer_earliest_shards_get(struct etimer_earliest_shards *set, uint32_t now,
+                               uint32_t *deadline);
+
+/**
+ * @brief  Take the earliest deadline of all shards and empty them.
+ * @param[in]  set: Sharded register.
+ * @param[in]  now: Current absolute time.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a deadline was held.
+ */
+int etimer_earliest_shards_take(struct etimer_earliest_shards *set, uint32_t now,
+                                uint32_t *deadline);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_EARLIEST_H_ */
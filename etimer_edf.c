@@ -0,0 +1,325 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_edf.h"
+
+/**
+ * @brief  Time relative to the latest decision, sign extended from the bits of the domain. Same
+ * as etimer_sub_raw() with an overflow of max_value / 2.
+ */
+static inline int32_t etimer_edf_rel(const struct etimer_edf *edf, uint32_t time)
+{
+    return (int32_t)((time - edf->now) << edf->shift) >> edf->shift;
+}
+
+static inline void etimer_edf_heap_set(struct etimer_edf_heap *heap, uint32_t pos,
+                                       struct etimer_edf_entry entry)
+{
+    heap->entries[pos] = entry;
+    entry.task->pos = pos;
+}
+
+static void etimer_edf_sift_up(const struct etimer_edf *edf, struct etimer_edf_heap *heap,
+                               uint32_t pos, struct etimer_edf_entry entry)
+{
+    int32_t key = etimer_edf_rel(edf, entry.key);
+
+    while (pos > 0)
+    {
+        uint32_t parent = (pos - 1) / 2;
+        if (key >= etimer_edf_rel(edf, heap->entries[parent].key))
+        {
+            break;
+        }
+        etimer_edf_heap_set(heap, pos, heap->entries[parent]);
+        pos = parent;
+    }
+    etimer_edf_heap_set(heap, pos, entry);
+}
+
+static void etimer_edf_sift_down(const struct etimer_edf *edf, struct etimer_edf_heap *heap,
+                                 uint32_t pos, struct etimer_edf_entry entry)
+{
+    int32_t key = etimer_edf_rel(edf, entry.key);
+    int32_t child_key, right_key;
+    uint32_t child;
+
+    while ((child = pos * 2 + 1) < heap->size)
+    {
+        child_key = etimer_edf_rel(edf, heap->entries[child].key);
+        if (child + 1 < heap->size)
+        {
+            right_key = etimer_edf_rel(edf, heap->entries[child + 1].key);
+            if (right_key < child_key)
+            {
+                child++;
+                child_key = right_key;
+            }
+        }
+        if (child_key >= key)
+        {
+            break;
+        }
+        etimer_edf_heap_set(heap, pos, heap->entries[child]);
+        pos = child;
+    }
+    etimer_edf_heap_set(heap, pos, entry);
+}
+
+static void etimer_edf_heap_remove(const struct etimer_edf *edf, struct etimer_edf_heap *heap,
+                                   uint32_t pos)
+{
+    struct etimer_edf_entry last = heap->entries[--heap->size];
+
+    if (pos == heap->size)
+    {
+        return;
+    }
+    if (pos > 0 && etimer_edf_rel(edf, last.key) <
+                           etimer_edf_rel(edf, heap->entries[(pos - 1) / 2].key))
+    {
+        etimer_edf_sift_up(edf, heap, pos, last);
+    }
+    else
+    {
+        etimer_edf_sift_down(edf, heap, pos, last);
+    }
+}
+
+/**
+ * @brief  Queue the task for its current release, ready now or sleeping until then. The task
+ * replaces the entry at pos of the heap it leaves, the top in the common case, which saves a
+ * removal.
+ */
+static void etimer_edf_queue(struct etimer_edf *edf, struct etimer_edf_task *task,
+                             struct etimer_edf_heap *from, uint32_t pos)
+{
+    struct etimer_edf_heap *to;
+    struct etimer_edf_entry entry;
+
+    if (etimer_edf_rel(edf, task->release) <= 0)
+    {
+        task->due = (task->release + task->deadline) & edf->max_value;
+        task->state = ETIMER_EDF_READY;
+        to = &edf->ready;
+        entry.key = task->due;
+    }
+    else
+    {
+        task->state = ETIMER_EDF_SLEEP;
+        to = &edf->sleep;
+        entry.key = task->release;
+    }
+    entry.task = task;
+
+    if (from == to && pos == 0)
+    {
+        // keys only grow, the top sinks
+        etimer_edf_sift_down(edf, to, 0, entry);
+        return;
+    }
+    if (from != NULL)
+    {
+        etimer_edf_heap_remove(edf, from, pos);
+    }
+    etimer_edf_sift_up(edf, to, to->size++, entry);
+}
+
+/**
+ * @brief  Move the time of the latest decision to now. Time only moves forward, a now slightly
+ * behind is a stale reading and ignored. A now behind by more than the longest period is a poll
+ * gap of over half the range that wrapped: the keys from before it are meaningless, so every
+ * task is released now, a ready job due just before now to count its miss.
+ */
+static void etimer_edf_sync(struct etimer_edf *edf, uint32_t now)
+{
+    int32_t step = etimer_edf_rel(edf, now);
+    uint32_t i;
+
+    if (step > 0)
+    {
+        edf->now = now;
+        return;
+    }
+    if (step >= -(int32_t)(edf->overflow / 2))
+    {
+        return;
+    }
+
+    // equal keys, both heaps stay valid
+    edf->now = now;
+    for (i = 0; i < edf->ready.size; i++)
+    {
+        struct etimer_edf_task *task = edf->ready.entries[i].task;
+        task->release = now;
+        task->due = (now - 1) & edf->max_value;
+        edf->ready.entries[i].key = task->due;
+    }
+    for (i = 0; i < edf->sleep.size; i++)
+    {
+        edf->sleep.entries[i].task->release = now;
+        edf->sleep.entries[i].key = now;
+    }
+}
+
+int etimer_edf_init(struct etimer_edf *edf, uint32_t capacity, uint32_t max_value,
+                    uint32_t permille, uint32_t now)
+{
+    memset(edf, 0, sizeof(*edf));
+    if (max_value == 0 || (max_value & (max_value + 1)) != 0)
+    {
+        return -EINVAL;
+    }
+
+    edf->ready.entries = malloc((size_t)capacity * sizeof(*edf->ready.entries));
+    edf->sleep.entries = malloc((size_t)capacity * sizeof(*edf->sleep.entries));
+    if (edf->ready.entries == NULL || edf->sleep.entries == NULL)
+    {
+        etimer_edf_deinit(edf);
+        return -ENOMEM;
+    }
+
+    edf->capacity = capacity;
+    edf->density_cap = ((uint64_t)permille << 32) / 1000;
+    edf->now = now;
+    edf->max_value = max_value;
+    edf->overflow = max_value >> 1;
+    while (((max_value << edf->shift) & 0x80000000u) == 0)
+    {
+        edf->shift++;
+    }
+
+    return 0;
+}
+
+void etimer_edf_deinit(struct etimer_edf *edf)
+{
+    free(edf->ready.entries);
+    free(edf->sleep.entries);
+    memset(edf, 0, sizeof(*edf));
+}
+
+void etimer_edf_task_init(struct etimer_edf_task *task, uint32_t period, uint32_t budget,
+                          uint32_t deadline, etimer_edf_fn_t fn, void *arg)
+{
+    memset(task, 0, sizeof(*task));
+    task->period = period;
+    task->budget = budget;
+    task->deadline = deadline;
+    task->state = ETIMER_EDF_IDLE;
+    task->fn = fn;
+    task->arg = arg;
+}
+
+int etimer_edf_admit(struct etimer_edf *edf, struct etimer_edf_task *task, uint32_t now)
+{
+    uint32_t window = task->deadline < task->period ? task->deadline : task->period;
+
+    if (task->state != ETIMER_EDF_IDLE)
+    {
+        return -EBUSY;
+    }
+    // half the overflow is left for jobs completing late
+    if (task->budget == 0 || task->budget > task->deadline || task->period == 0 ||
+        task->period > edf->overflow / 2 || task->deadline > edf->overflow / 2)
+    {
+        return -EINVAL;
+    }
+    if (edf->ready.size + edf->sleep.size == edf->capacity)
+    {
+        return -ENOSPC;
+    }
+
+    task->density = (((uint64_t)task->budget << 32) + window - 1) / window;
+    if (edf->density + task->density > edf->density_cap)
+    {
+        return -EBUSY;
+    }
+    edf->density += task->density;
+
+    etimer_edf_sync(edf, now);
+    task->release = now;
+    task->jobs = 0;
+    task->misses = 0;
+    task->late_max = 0;
+    etimer_edf_queue(edf, task, NULL, 0);
+
+    return 0;
+}
+
+void etimer_edf_remove(struct etimer_edf *edf, struct etimer_edf_task *task)
+{
+    if (task->state == ETIMER_EDF_IDLE)
+    {
+        return;
+    }
+
+    etimer_edf_heap_remove(edf, task->state == ETIMER_EDF_READY ? &edf->ready : &edf->sleep,
+                           task->pos);
+    edf->density -= task->density;
+    task->state = ETIMER_EDF_IDLE;
+}
+
+struct etimer_edf_task *etimer_edf_next(struct etimer_edf *edf, uint32_t now)
+{
+    struct etimer_edf_task *task;
+
+    // time only moves forward, the heap order holds for any later reference
+    etimer_edf_sync(edf, now);
+
+    while (edf->sleep.size && etimer_edf_rel(edf, edf->sleep.entries[0].key) <= 0)
+    {
+        task = edf->sleep.entries[0].task;
+        etimer_edf_queue(edf, task, &edf->sleep, 0);
+    }
+
+    return edf->ready.size ? edf->ready.entries[0].task : NULL;
+}
+
+void etimer_edf_done(struct etimer_edf *edf, struct etimer_edf_task *task, uint32_t now)
+{
+    int32_t late;
+
+    etimer_edf_sync(edf, now);
+
+    // positive after the deadline, the miss is measured against the completion
+    late = -etimer_edf_rel(edf, task->due);
+    task->jobs++;
+    edf->jobs++;
+    if (late > 0)
+    {
+        task->misses++;
+        edf->misses++;
+    }
+    task->late_max = late > task->late_max ? late : task->late_max;
+    edf->late_max = late > edf->late_max ? late : edf->late_max;
+
+    task->release = (task->release + task->period) & edf->max_value;
+    etimer_edf_queue(edf, task, &edf->ready, task->pos);
+}
+
+int etimer_edf_wakeup(const struct etimer_edf *edf, uint32_t *release)
+{
+    if (edf->sleep.size == 0)
+    {
+        return 0;
+    }
+
+    *release = edf->sleep.entries[0].key;
+    return 1;
+}
+
+int etimer_edf_run(struct etimer_edf *edf, uint32_t (*clock)(void))
+{
+    struct etimer_edf_task *task = etimer_edf_next(edf, clock());
+
+    if (task == NULL)
+    {
+        return 0;
+    }
+
+    task->fn(task, task->arg);
+    etimer_edf_done(edf, task, clock());
+    return 1;
+}
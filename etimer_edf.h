@@ -0,0 +1,172 @@
+#ifndef _ETIMER_EDF_H_
+#define _ETIMER_EDF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Cooperative earliest deadline first scheduler for periodic tasks. Each job is released at the
+ * start of its period and due a relative deadline later; the ready job with the earliest
+ * deadline runs to completion, then the task sleeps until its next release.
+ *
+ * Both queues are binary heaps ordered by deadline, or release, relative to the time of the
+ * latest scheduling decision rather than by comparing two deadlines with each other. A job that
+ * is already late then still sorts before one due far ahead, even when the two deadlines are
+ * more than half the range apart, as long as each is within the overflow of now. Admission caps
+ * the summed density budget / min(deadline, period) of the tasks, which keeps EDF free of
+ * misses up to 100% when deadlines equal periods.
+ *
+ * Any etimer domain works: ETIMER_MAX_VALUE, 0xFFFF for etimer16 times, or a narrower _raw
+ * counter whose max_value + 1 is a power of 2.
+ *
+ * Polls should be less than half the range apart. A gap of half to three quarters of the range
+ * is detected and restarts every task at the next call, counting the interrupted jobs as
+ * missed. A longer gap looks like a stale reading: decisions wait until the clock passes the
+ * time of the latest one again.
+ */
+
+#define ETIMER_EDF_IDLE    0 /* not admitted */
+#define ETIMER_EDF_SLEEP   1 /* waiting for its next release */
+#define ETIMER_EDF_READY   2 /* released, job not done */
+
+struct etimer_edf_task;
+
+typedef void (*etimer_edf_fn_t)(struct etimer_edf_task *task, void *arg);
+
+struct etimer_edf_task
+{
+    uint32_t period;   /* ticks between releases */
+    uint32_t budget;   /* worst case ticks of a job */
+    uint32_t deadline; /* ticks from release to due */
+    uint32_t release;  /* absolute release of the current job */
+    uint32_t due;      /* absolute deadline of the current job */
+    uint32_t pos;      /* in the ready or sleep heap */
+    uint32_t state;    /* ETIMER_EDF_xxx */
+    uint32_t jobs;
+    uint32_t misses;
+    int32_t late_max; /* worst completion after due, ticks */
+    uint64_t density; /* admitted share of the processor, 32-bit fraction */
+    etimer_edf_fn_t fn;
+    void *arg;
+};
+
+struct etimer_edf_entry
+{
+    uint32_t key; /* due in the ready heap, release in the sleep heap */
+    struct etimer_edf_task *task;
+};
+
+struct etimer_edf_heap
+{
+    struct etimer_edf_entry *entries;
+    uint32_t size;
+};
+
+struct etimer_edf
+{
+    struct etimer_edf_heap ready; /* by due */
+    struct etimer_edf_heap sleep; /* by release */
+    uint32_t capacity;
+    uint64_t density;     /* admitted total, 32-bit fraction */
+    uint64_t density_cap; /* 32-bit fraction */
+    uint32_t now;         /* time of the latest decision */
+    uint32_t max_value;
+    uint32_t overflow;
+    uint32_t shift; /* 32 minus the bits of the domain */
+    uint32_t jobs;
+    uint32_t misses;
+    int32_t late_max;
+};
+
+/**
+ * @brief  Allocate room for capacity tasks.
+ * @param[out] edf: Scheduler.
+ * @param[in]  capacity: Max number of admitted tasks.
+ * @param[in]  max_value: Max time value of the domain, max_value + 1 a power of 2.
+ * @param[in]  permille: Admission cap of the summed density, 1000 for a full processor.
+ * @param[in]  now: Current absolute time.
+ * @return 0 on success, -EINVAL for a bad max_value, -ENOMEM on failure.
+ */
+int etimer_edf_init(struct etimer_edf *edf, uint32_t capacity, uint32_t max_value,
+                    uint32_t permille, uint32_t now);
+
+/**
+ * @brief  Free the scheduler, tasks are left as they are.
+ * @param[in]  edf: Scheduler.
+ */
+void etimer_edf_deinit(struct etimer_edf *edf);
+
+/**
+ * @brief  Describe a task, must be done before admission.
+ * @param[out] task: Task.
+ * @param[in]  period: Ticks between releases.
+ * @param[in]  budget: Worst case ticks of one job.
+ * @param[in]  deadline: Ticks from release to due.
+ * @param[in]  fn: Job function, run by etimer_edf_run().
+ * @param[in]  arg: Job argument.
+ */
+void etimer_edf_task_init(struct etimer_edf_task *task, uint32_t period, uint32_t budget,
+                          uint32_t deadline, etimer_edf_fn_t fn, void *arg);
+
+/**
+ * @brief  Admit a task, its first job is released now.
+ * @param[in]  edf: Scheduler.
+ * @param[in]  task: Idle task.
+ * @param[in]  now: Current absolute time.
+ * @return 0 on success, -EINVAL for a budget beyond the deadline or a period or deadline beyond
+ * half the overflow, -ENOSPC when full, -EBUSY when the task is already admitted or the density
+ * cap would be exceeded.
+ */
+int etimer_edf_admit(struct etimer_edf *edf, struct etimer_edf_task *task, uint32_t now);
+
+/**
+ * @brief  Withdraw a task and give back its density.
+ * @param[in]  edf: Scheduler.
+ * @param[in]  task: Admitted task.
+ */
+void etimer_edf_remove(struct etimer_edf *edf, struct etimer_edf_task *task);
+
+/**
+ * @brief  Release the jobs due to start and pick the one to run.
+ * @param[in]  edf: Scheduler.
+ * @param[in]  now: Current absolute time.
+ * @return ready task with the earliest deadline, NULL if none.
+ */
+struct etimer_edf_task *etimer_edf_next(struct etimer_edf *edf, uint32_t now);
+
+/**
+ * @brief  Complete the job of the task returned by etimer_edf_next(), accounting a miss when
+ * it finishes after its deadline, and schedule its next release.
+ * @param[in]  edf: Scheduler.
+ * @param[in]  task: Ready task.
+ * @param[in]  now: Completion time.
+ */
+void etimer_edf_done(struct etimer_edf *edf, struct etimer_edf_task *task, uint32_t now);
+
+/**
+ * @brief  Earliest upcoming release, for sleeping while nothing is ready.
+ * @param[in]  edf: Scheduler.
+ * @param[out] release: Absolute time of the release.
+ * @return resulting 1 means a task is sleeping.
+ */
+int etimer_edf_wakeup(const struct etimer_edf *edf, uint32_t *release);
+
+/**
+ * @brief  Run one job: pick the earliest deadline, call its function, complete it.
+ * @param[in]  edf: Scheduler.
+ * @param[in]  clock: Reads the current absolute time.
+ * @return resulting 1 means a job ran.
+ */
+int etimer_edf_run(struct etimer_edf *edf, uint32_t (*clock)(void));
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_EDF_H_ */
@@ -0,0 +1,189 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_idle.h"
+
+static void etimer_idle_unlink(struct etimer_idle *idle, uint32_t handle)
+{
+    uint32_t prev = idle->conns[handle].prev, next = idle->conns[handle].next;
+
+    if (prev & ETIMER_IDLE_HEAD)
+    {
+        idle->slots[prev & ~ETIMER_IDLE_HEAD] = next;
+    }
+    else
+    {
+        idle->conns[prev].next = next;
+    }
+    if (next != ETIMER_IDLE_NONE)
+    {
+        idle->conns[next].prev = prev;
+    }
+}
+
+/**
+ * @brief  Put a connection in the slot of its deadline, or of the cursor if that is passed.
+ */
+static void etimer_idle_arm(struct etimer_idle *idle, uint32_t handle, uint32_t deadline)
+{
+    uint32_t slot, head;
+
+    if (etimer_sub(deadline, idle->cursor) < 0)
+    {
+        deadline = idle->cursor;
+    }
+    slot = (deadline >> idle->shift) & idle->mask;
+    head = idle->slots[slot];
+
+    idle->conns[handle].next = head;
+    idle->conns[handle].prev = ETIMER_IDLE_HEAD | slot;
+    if (head != ETIMER_IDLE_NONE)
+    {
+        idle->conns[head].prev = handle;
+    }
+    idle->slots[slot] = handle;
+}
+
+int etimer_idle_init(struct etimer_idle *idle, uint32_t capacity, uint32_t timeout,
+                     uint32_t granule, uint32_t now)
+{
+    uint32_t count = 4, i;
+
+    memset(idle, 0, sizeof(*idle));
+    if (capacity >= ETIMER_IDLE_HEAD || timeout == 0 ||
+        timeout >= ETIMER_MAX_VALUE_OVERFLOW / 2 || granule > timeout)
+    {
+        return -EINVAL;
+    }
+
+    while ((1u << idle->shift) < granule)
+    {
+        idle->shift++;
+    }
+    // deadlines up to a timeout ahead of a passed slot never wrap onto it
+    while (count < (timeout >> idle->shift) + 3)
+    {
+        count <<= 1;
+    }
+    if (((uint64_t)count << idle->shift) > ETIMER_MAX_VALUE_OVERFLOW)
+    {
+        return -EINVAL;
+    }
+
+    idle->conns = malloc((size_t)capacity * sizeof(*idle->conns));
+    idle->slots = malloc((size_t)count * sizeof(*idle->slots));
+    if ((capacity && idle->conns == NULL) || idle->slots == NULL)
+    {
+        etimer_idle_deinit(idle);
+        return -ENOMEM;
+    }
+
+    memset(idle->slots, 0xFF, (size_t)count * sizeof(*idle->slots));
+    // lowest handles first
+    for (i = 0; i < capacity; i++)
+    {
+        idle->conns[i].last = 0;
+        idle->conns[i].next = i + 1 < capacity ? i + 1 : ETIMER_IDLE_NONE;
+        idle->conns[i].prev = ETIMER_IDLE_NONE;
+    }
+    idle->free_head = capacity ? 0 : ETIMER_IDLE_NONE;
+    idle->mask = count - 1;
+    idle->timeout = timeout;
+    idle->cursor = now & ~((1u << idle->shift) - 1);
+    idle->capacity = capacity;
+
+    return 0;
+}
+
+void etimer_idle_deinit(struct etimer_idle *idle)
+{
+    free(idle->conns);
+    free(idle->slots);
+    memset(idle, 0, sizeof(*idle));
+}
+
+uint32_t etimer_idle_add(struct etimer_idle *idle, uint32_t now)
+{
+    uint32_t handle = idle->free_head;
+
+    if (handle == ETIMER_IDLE_NONE)
+    {
+        return ETIMER_IDLE_NONE;
+    }
+
+    idle->free_head = idle->conns[handle].next;
+    idle->conns[handle].last = now;
+    etimer_idle_arm(idle, handle, now + idle->timeout);
+    idle->count++;
+
+    return handle;
+}
+
+static void etimer_idle_free(struct etimer_idle *idle, uint32_t handle)
+{
+    idle->conns[handle].prev = ETIMER_IDLE_NONE;
+    idle->conns[handle].next = idle->free_head;
+    idle->free_head = handle;
+    idle->count--;
+}
+
+void etimer_idle_remove(struct etimer_idle *idle, uint32_t handle)
+{
+    if (idle->conns[handle].prev == ETIMER_IDLE_NONE)
+    {
+        return;
+    }
+
+    etimer_idle_unlink(idle, handle);
+    etimer_idle_free(idle, handle);
+}
+
+size_t etimer_idle_expire(struct etimer_idle *idle, uint32_t now, uint32_t *handles, size_t max)
+{
+    uint32_t granule = 1u << idle->shift, span = (idle->mask + 1) << idle->shift;
+    uint32_t slot, handle, list, stopped = 0;
+    size_t n = 0;
+
+    // after a long pause one lap visits every slot
+    if (etimer_sub(now, idle->cursor) >= (int32_t)span)
+    {
+        idle->cursor = ((now >> idle->shift) - idle->mask) << idle->shift;
+    }
+
+    while (!stopped && n < max && etimer_sub(now, idle->cursor + granule - 1) >= 0)
+    {
+        // detached, a connection due a lap later may land in the same slot again
+        slot = (idle->cursor >> idle->shift) & idle->mask;
+        list = idle->slots[slot];
+        idle->slots[slot] = ETIMER_IDLE_NONE;
+
+        while (list != ETIMER_IDLE_NONE)
+        {
+            handle = list;
+            list = idle->conns[handle].next;
+            if (n == max)
+            {
+                etimer_idle_arm(idle, handle, idle->cursor);
+                stopped = 1;
+                continue;
+            }
+            if (etimer_sub(now, idle->conns[handle].last) >= (int32_t)idle->timeout)
+            {
+                etimer_idle_free(idle, handle);
+                handles[n++] = handle;
+            }
+            else
+            {
+                etimer_idle_arm(idle, handle, idle->conns[handle].last + idle->timeout);
+            }
+        }
+
+        if (!stopped)
+        {
+            idle->cursor += granule;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,132 @@
+#ifndef _ETIMER_IDLE_H_
+#define _ETIMER_IDLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Idle timeouts for many connections sharing one timeout. Activity only stores the wrapped time
+ * of the last activity, the timer itself is not moved. Each connection sits in a coarse wheel
+ * slot for the deadline it had when last checked; when the slot is passed, etimer_sub() of now
+ * and the last activity decides between expiring the connection and moving it to the slot of
+ * its current deadline. A busy connection is thus looked at about once per timeout, whatever
+ * its packet rate.
+ *
+ * A connection expires at most one granule plus the poll interval after its deadline. The wheel
+ * spans the timeout, so etimer_idle_expire() must run at least every overflow / 2 ticks for the
+ * wrapped activity times to stay comparable with now.
+ */
+
+#define ETIMER_IDLE_NONE (~(uint32_t)0)
+#define ETIMER_IDLE_HEAD 0x80000000u /* prev of a first entry, or-ed with the slot */
+
+struct etimer_idle_conn
+{
+    uint32_t last; /* last activity */
+    uint32_t next; /* in the slot, or in the free list */
+    uint32_t prev; /* in the slot, ETIMER_IDLE_HEAD | slot first, ETIMER_IDLE_NONE if free */
+};
+
+struct etimer_idle
+{
+    struct etimer_idle_conn *conns; /* one cache line per check */
+    uint32_t *slots;
+    uint32_t mask;  /* slots - 1 */
+    uint32_t shift; /* granule is 1 << shift ticks */
+    uint32_t timeout;
+    uint32_t cursor; /* start of the first slot not yet passed */
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t free_head;
+};
+
+/**
+ * @brief  Allocate room for capacity connections.
+ * @param[out] idle: Idle tracker.
+ * @param[in]  capacity: Max number of connections, below ETIMER_IDLE_HEAD.
+ * @param[in]  timeout: Idle ticks before expiry, below ETIMER_MAX_VALUE_OVERFLOW / 2.
+ * @param[in]  granule: Slot width in ticks, rounded up to a power of 2.
+ * @param[in]  now: Current absolute time.
+ * @return 0 on success, -EINVAL for bad sizes, -ENOMEM on failure.
+ */
+int etimer_idle_init(struct etimer_idle *idle, uint32_t capacity, uint32_t timeout,
+                     uint32_t granule, uint32_t now);
+
+/**
+ * @brief  Free the tracker.
+ * @param[in]  idle: Idle tracker.
+ */
+void etimer_idle_deinit(struct etimer_idle *idle);
+
+/**
+ * @brief  Start tracking a connection, active now.
+ * @param[in]  idle: Idle tracker.
+ * @param[in]  now: Current absolute time.
+ * @return handle, ETIMER_IDLE_NONE if full.
+ */
+uint32_t etimer_idle_add(struct etimer_idle *idle, uint32_t now);
+
+/**
+ * @brief  Stop tracking a connection, its handle may be reused.
+ * @param[in]  idle: Idle tracker.
+ * @param[in]  handle: Handle returned by etimer_idle_add().
+ */
+void etimer_idle_remove(struct etimer_idle *idle, uint32_t handle);
+
+/**
+ * @brief  Record activity on a connection, a single store.
+ * @param[in]  idle: Idle tracker.
+ * @param[in]  handle: Handle.
+ * @param[in]  now: Current absolute time.
+ */
+static inline void etimer_idle_touch(struct etimer_idle *idle, uint32_t handle, uint32_t now)
+{
+    idle->conns[handle].last = now;
+}
+
+/**
+ * @brief  Ticks since the last activity of a connection.
+ * @param[in]  idle: Idle tracker.
+ * @param[in]  handle: Handle.
+ * @param[in]  now: Current absolute time.
+ * @return idle ticks.
+ */
+static inline int32_t etimer_idle_ticks(const struct etimer_idle *idle, uint32_t handle,
+                                        uint32_t now)
+{
+    return etimer_sub(now, idle->conns[handle].last);
+}
+
+/**
+ * @brief  Check the slots passed by now, collect the connections idle for the timeout and move
+ * the others to the slot of their current deadline. Collected handles are removed and may be
+ * reused. When handles fills up, the next call resumes where this one stopped.
+ * @param[in]  idle: Idle tracker.
+ * @param[in]  now: Current absolute time.
+ * @param[out] handles: Expired handles.
+ * @param[in]  max: Size of handles.
+ * @return number of handles written.
+ */
+size_t etimer_idle_expire(struct etimer_idle *idle, uint32_t now, uint32_t *handles, size_t max);
+
+/**
+ * @brief  Time at which the next slot is passed, for arming the coarse timer.
+ * @param[in]  idle: Idle tracker.
+ * @return absolute time.
+ */
+static inline uint32_t etimer_idle_wakeup(const struct etimer_idle *idle)
+{
+    return idle->cursor + (1u << idle->shift) - 1;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_IDLE_H_ */
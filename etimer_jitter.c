@@ -0,0 +1,322 @@
+#include <math.h>
+#include <string.h>
+
+#include "etimer_jitter.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline void etimer_jitter_outlier(struct etimer_jitter *jitter, uint64_t index)
+{
+    if (jitter->outlier_count < jitter->outlier_cap)
+    {
+        jitter->outliers[jitter->outlier_count] = index;
+    }
+    jitter->outlier_count++;
+}
+
+static inline void etimer_jitter_add(struct etimer_jitter *jitter, int32_t delta, uint64_t index)
+{
+    // wraps like the vector lanes for absurd intervals
+    int32_t err = (int32_t)((uint32_t)delta - jitter->period);
+    int32_t tol = (int32_t)jitter->tolerance;
+
+    jitter->min = delta < jitter->min ? delta : jitter->min;
+    jitter->max = delta > jitter->max ? delta : jitter->max;
+    jitter->sum_err += err;
+    jitter->sumsq_err += (double)err * err;
+    if (err > tol || err < -tol)
+    {
+        etimer_jitter_outlier(jitter, index);
+    }
+}
+
+// Running statistics live in vector registers for a whole feed, outliers are rare so their lanes
+// are searched only when a compare hits.
+#if defined(__AVX2__)
+#define ETIMER_JITTER_LANES 8
+
+struct etimer_jitter_vec
+{
+    __m256i min, max, sum, period, tol, ntol;
+    __m256d sumsq;
+};
+
+static inline void etimer_jitter_vec_init(struct etimer_jitter_vec *v,
+                                          const struct etimer_jitter *jitter)
+{
+    v->min = _mm256_set1_epi32(INT32_MAX);
+    v->max = _mm256_set1_epi32(INT32_MIN);
+    v->sum = _mm256_setzero_si256();
+    v->sumsq = _mm256_setzero_pd();
+    v->period = _mm256_set1_epi32((int32_t)jitter->period);
+    v->tol = _mm256_set1_epi32((int32_t)jitter->tolerance);
+    v->ntol = _mm256_set1_epi32(-(int32_t)jitter->tolerance);
+}
+
+static inline void etimer_jitter_vec_add(struct etimer_jitter *jitter, struct etimer_jitter_vec *v,
+                                         __m256i delta, uint64_t index)
+{
+    __m256i err = _mm256_sub_epi32(delta, v->period);
+    __m128i lo = _mm256_castsi256_si128(err);
+    __m128i hi = _mm256_extracti128_si256(err, 1);
+    __m256d dlo = _mm256_cvtepi32_pd(lo);
+    __m256d dhi = _mm256_cvtepi32_pd(hi);
+    __m256i out =
+            _mm256_or_si256(_mm256_cmpgt_epi32(err, v->tol), _mm256_cmpgt_epi32(v->ntol, err));
+
+    v->min = _mm256_min_epi32(v->min, delta);
+    v->max = _mm256_max_epi32(v->max, delta);
+    v->sum = _mm256_add_epi64(v->sum, _mm256_add_epi64(_mm256_cvtepi32_epi64(lo),
+                                                       _mm256_cvtepi32_epi64(hi)));
+    v->sumsq = _mm256_add_pd(v->sumsq,
+                             _mm256_add_pd(_mm256_mul_pd(dlo, dlo), _mm256_mul_pd(dhi, dhi)));
+
+    if (_mm256_movemask_epi8(out))
+    {
+        uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(out));
+        for (int k = 0; k < ETIMER_JITTER_LANES; k++)
+        {
+            if (mask & (1u << k))
+            {
+                etimer_jitter_outlier(jitter, index + k);
+            }
+        }
+    }
+}
+
+static inline void etimer_jitter_vec_flush(struct etimer_jitter *jitter,
+                                           const struct etimer_jitter_vec *v)
+{
+    int32_t min[8], max[8];
+    int64_t sum[4];
+    double sumsq[4];
+
+    _mm256_storeu_si256((__m256i *)min, v->min);
+    _mm256_storeu_si256((__m256i *)max, v->max);
+    _mm256_storeu_si256((__m256i *)sum, v->sum);
+    _mm256_storeu_pd(sumsq, v->sumsq);
+    for (int k = 0; k < 8; k++)
+    {
+        jitter->min = min[k] < jitter->min ? min[k] : jitter->min;
+        jitter->max = max[k] > jitter->max ? max[k] : jitter->max;
+    }
+    for (int k = 0; k < 4; k++)
+    {
+        jitter->sum_err += sum[k];
+        jitter->sumsq_err += sumsq[k];
+    }
+}
+
+static inline __m256i etimer_jitter_delta(const uint32_t *times)
+{
+    return _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)times),
+                            _mm256_loadu_si256((const __m256i *)(times - 1)));
+}
+
+static inline void etimer16_jitter_vec8(struct etimer_jitter *jitter, struct etimer_jitter_vec *v,
+                                        const uint16_t *times, uint64_t index)
+{
+    __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)times),
+                              _mm_loadu_si128((const __m128i *)(times - 1)));
+    etimer_jitter_vec_add(jitter, v, _mm256_cvtepi16_epi32(d), index);
+}
+#elif defined(__SSE2__)
+#define ETIMER_JITTER_LANES 4
+
+struct etimer_jitter_vec
+{
+    __m128i min, max, sum, period, tol, ntol;
+    __m128d sumsq;
+};
+
+static inline void etimer_jitter_vec_init(struct etimer_jitter_vec *v,
+                                          const struct etimer_jitter *jitter)
+{
+    v->min = _mm_set1_epi32(INT32_MAX);
+    v->max = _mm_set1_epi32(INT32_MIN);
+    v->sum = _mm_setzero_si128();
+    v->sumsq = _mm_setzero_pd();
+    v->period = _mm_set1_epi32((int32_t)jitter->period);
+    v->tol = _mm_set1_epi32((int32_t)jitter->tolerance);
+    v->ntol = _mm_set1_epi32(-(int32_t)jitter->tolerance);
+}
+
+static inline void etimer_jitter_vec_add(struct etimer_jitter *jitter, struct etimer_jitter_vec *v,
+                                         __m128i delta, uint64_t index)
+{
+    // SSE2 has no 32-bit min/max or sign extension, both are built from compares
+    __m128i err = _mm_sub_epi32(delta, v->period);
+    __m128i sign = _mm_srai_epi32(err, 31);
+    __m128d dlo = _mm_cvtepi32_pd(err);
+    __m128d dhi = _mm_cvtepi32_pd(_mm_shuffle_epi32(err, _MM_SHUFFLE(1, 0, 3, 2)));
+    __m128i lt = _mm_cmplt_epi32(delta, v->min);
+    __m128i gt = _mm_cmpgt_epi32(delta, v->max);
+    __m128i out = _mm_or_si128(_mm_cmpgt_epi32(err, v->tol), _mm_cmplt_epi32(err, v->ntol));
+
+    v->min = _mm_or_si128(_mm_and_si128(lt, delta), _mm_andnot_si128(lt, v->min));
+    v->max = _mm_or_si128(_mm_and_si128(gt, delta), _mm_andnot_si128(gt, v->max));
+    v->sum = _mm_add_epi64(v->sum, _mm_add_epi64(_mm_unpacklo_epi32(err, sign),
+                                                 _mm_unpackhi_epi32(err, sign)));
+    v->sumsq = _mm_add_pd(v->sumsq, _mm_add_pd(_mm_mul_pd(dlo, dlo), _mm_mul_pd(dhi, dhi)));
+
+    if (_mm_movemask_epi8(out))
+    {
+        uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(out));
+        for (int k = 0; k < ETIMER_JITTER_LANES; k++)
+        {
+            if (mask & (1u << k))
+            {
+                etimer_jitter_outlier(jitter, index + k);
+            }
+        }
+    }
+}
+
+static inline void etimer_jitter_vec_flush(struct etimer_jitter *jitter,
+                                           const struct etimer_jitter_vec *v)
+{
+    int32_t min[4], max[4];
+    int64_t sum[2];
+    double sumsq[2];
+
+    _mm_storeu_si128((__m128i *)min, v->min);
+    _mm_storeu_si128((__m128i *)max, v->max);
+    _mm_storeu_si128((__m128i *)sum, v->sum);
+    _mm_storeu_pd(sumsq, v->sumsq);
+    for (int k = 0; k < 4; k++)
+    {
+        jitter->min = min[k] < jitter->min ? min[k] : jitter->min;
+        jitter->max = max[k] > jitter->max ? max[k] : jitter->max;
+    }
+    for (int k = 0; k < 2; k++)
+    {
+        jitter->sum_err += sum[k];
+        jitter->sumsq_err += sumsq[k];
+    }
+}
+
+static inline __m128i etimer_jitter_delta(const uint32_t *times)
+{
+    return _mm_sub_epi32(_mm_loadu_si128((const __m128i *)times),
+                         _mm_loadu_si128((const __m128i *)(times - 1)));
+}
+
+static inline void etimer16_jitter_vec8(struct etimer_jitter *jitter, struct etimer_jitter_vec *v,
+                                        const uint16_t *times, uint64_t index)
+{
+    __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)times),
+                              _mm_loadu_si128((const __m128i *)(times - 1)));
+    etimer_jitter_vec_add(jitter, v, _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16), index);
+    etimer_jitter_vec_add(jitter, v, _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16), index + 4);
+}
+#endif
+
+void etimer_jitter_init(struct etimer_jitter *jitter, uint32_t period, uint32_t tolerance,
+                        uint64_t *outliers, size_t outlier_cap)
+{
+    memset(jitter, 0, sizeof(*jitter));
+    jitter->period = period;
+    jitter->tolerance = tolerance;
+    jitter->outliers = outliers;
+    jitter->outlier_cap = outliers ? outlier_cap : 0;
+    jitter->min = INT32_MAX;
+    jitter->max = INT32_MIN;
+}
+
+void etimer_jitter_feed(struct etimer_jitter *jitter, const uint32_t *times, size_t n)
+{
+    size_t i = 1;
+
+    if (n == 0)
+    {
+        return;
+    }
+    if (jitter->samples)
+    {
+        etimer_jitter_add(jitter, etimer_sub(times[0], jitter->last), jitter->samples);
+    }
+
+#if defined(ETIMER_JITTER_LANES)
+    if (n > ETIMER_JITTER_LANES)
+    {
+        struct etimer_jitter_vec v;
+        etimer_jitter_vec_init(&v, jitter);
+        for (; i + ETIMER_JITTER_LANES <= n; i += ETIMER_JITTER_LANES)
+        {
+            etimer_jitter_vec_add(jitter, &v, etimer_jitter_delta(times + i), jitter->samples + i);
+        }
+        etimer_jitter_vec_flush(jitter, &v);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        etimer_jitter_add(jitter, etimer_sub(times[i], times[i - 1]), jitter->samples + i);
+    }
+
+    jitter->last = times[n - 1];
+    jitter->samples += n;
+}
+
+void etimer16_jitter_feed(struct etimer_jitter *jitter, const uint16_t *times, size_t n)
+{
+    size_t i = 1;
+
+    if (n == 0)
+    {
+        return;
+    }
+    if (jitter->samples)
+    {
+        etimer_jitter_add(jitter, etimer16_sub(times[0], (uint16_t)jitter->last),
+                          jitter->samples);
+    }
+
+#if defined(ETIMER_JITTER_LANES)
+    if (n > 8)
+    {
+        struct etimer_jitter_vec v;
+        etimer_jitter_vec_init(&v, jitter);
+        for (; i + 8 <= n; i += 8)
+        {
+            etimer16_jitter_vec8(jitter, &v, times + i, jitter->samples + i);
+        }
+        etimer_jitter_vec_flush(jitter, &v);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        etimer_jitter_add(jitter, etimer16_sub(times[i], times[i - 1]), jitter->samples + i);
+    }
+
+    jitter->last = times[n - 1];
+    jitter->samples += n;
+}
+
+void etimer_jitter_result(const struct etimer_jitter *jitter, struct etimer_jitter_result *result)
+{
+    uint64_t intervals = jitter->samples ? jitter->samples - 1 : 0;
+    double mean_err, var;
+
+    memset(result, 0, sizeof(*result));
+    result->outliers = jitter->outlier_count;
+    if (intervals == 0)
+    {
+        return;
+    }
+
+    mean_err = (double)jitter->sum_err / intervals;
+    var = jitter->sumsq_err / intervals - mean_err * mean_err;
+    result->intervals = intervals;
+    result->min = jitter->min;
+    result->max = jitter->max;
+    result->mean_err = mean_err;
+    result->mean = jitter->period + mean_err;
+    result->stddev = var > 0 ? sqrt(var) : 0;
+    result->rms_err = sqrt(jitter->sumsq_err / intervals);
+}
@@ -0,0 +1,88 @@
+#ifndef _ETIMER_JITTER_H_
+#define _ETIMER_JITTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Streaming inter-arrival analyzer over captured wrapped timestamps. Chunks are fed in capture
+ * order, the interval between the last timestamp of a chunk and the first of the next one is
+ * counted too. Intervals are etimer_sub()/etimer16_sub() of neighbours, the period error is the
+ * interval minus the expected period. An analyzer takes either 32-bit or 16-bit timestamps, not
+ * both.
+ */
+
+struct etimer_jitter
+{
+    uint32_t period;
+    uint32_t tolerance;
+    uint64_t *outliers;
+    size_t outlier_cap;
+    uint64_t outlier_count;
+    uint64_t samples;
+    uint32_t last;
+    int32_t min;
+    int32_t max;
+    int64_t sum_err;
+    double sumsq_err;
+};
+
+struct etimer_jitter_result
+{
+    uint64_t intervals;
+    int32_t min;       /* shortest interval */
+    int32_t max;       /* longest interval */
+    double mean;       /* mean interval */
+    double stddev;     /* of the interval */
+    double mean_err;   /* mean - period */
+    double rms_err;    /* root mean square of the period error */
+    uint64_t outliers; /* all of them, also those beyond outlier_cap */
+};
+
+/**
+ * @brief  Reset an analyzer.
+ * @param[out] jitter: Analyzer.
+ * @param[in]  period: Expected interval.
+ * @param[in]  tolerance: Intervals whose period error is beyond +/- tolerance are outliers.
+ * @param[out] outliers: Sample indices of outliers, counted from the first timestamp fed. The
+ * index is that of the later timestamp of the interval. May be NULL.
+ * @param[in]  outlier_cap: Size of outliers.
+ */
+void etimer_jitter_init(struct etimer_jitter *jitter, uint32_t period, uint32_t tolerance,
+                        uint64_t *outliers, size_t outlier_cap);
+
+/**
+ * @brief  Feed a chunk of 32-bit timestamps.
+ * @param[in]  jitter: Analyzer.
+ * @param[in]  times: Timestamps in capture order.
+ * @param[in]  n: Number of timestamps.
+ */
+void etimer_jitter_feed(struct etimer_jitter *jitter, const uint32_t *times, size_t n);
+
+/**
+ * @brief  Feed a chunk of 16-bit timestamps.
+ * @param[in]  jitter: Analyzer, period and tolerance below ETIMER16_MAX_VALUE_OVERFLOW.
+ * @param[in]  times: Timestamps in capture order.
+ * @param[in]  n: Number of timestamps.
+ */
+void etimer16_jitter_feed(struct etimer_jitter *jitter, const uint16_t *times, size_t n);
+
+/**
+ * @brief  Statistics of everything fed so far.
+ * @param[in]  jitter: Analyzer.
+ * @param[out] result: Statistics, all zero without intervals.
+ */
+void etimer_jitter_result(const struct etimer_jitter *jitter, struct etimer_jitter_result *result);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_JITTER_H_ */
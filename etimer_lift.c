@@ -0,0 +1,130 @@
+#include <errno.h>
+
+#include "etimer_lift.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief  Bits dropped when the narrow domain is sign extended from the top of a word.
+ * @return shift, -EINVAL if max_value + 1 is not a power of 2.
+ */
+static int etimer_lift_shift(uint32_t max_value, uint32_t bits)
+{
+    int shift = 0;
+
+    if (max_value == 0 || (max_value & (max_value + 1)) != 0)
+    {
+        return -EINVAL;
+    }
+    while (((max_value << shift) >> (bits - 1)) == 0)
+    {
+        shift++;
+    }
+    return shift;
+}
+
+int etimer_lift_raw(const uint32_t *narrow, size_t n, uint32_t ref, uint32_t max_value,
+                    uint32_t *out)
+{
+    int shift = etimer_lift_shift(max_value, 32);
+    size_t i = 0;
+
+    if (shift < 0)
+    {
+        return shift;
+    }
+
+    // ref + ((narrow - ref) sign extended from the narrow width)
+#if defined(__AVX2__)
+    {
+        __m256i vref = _mm256_set1_epi32((int32_t)ref);
+        __m128i count = _mm_cvtsi32_si128(shift);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(narrow + i));
+            __m256i d = _mm256_sll_epi32(_mm256_sub_epi32(v, vref), count);
+            d = _mm256_sra_epi32(d, count);
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(d, vref));
+        }
+    }
+#elif defined(__SSE2__)
+    {
+        __m128i vref = _mm_set1_epi32((int32_t)ref);
+        __m128i count = _mm_cvtsi32_si128(shift);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(narrow + i));
+            __m128i d = _mm_sll_epi32(_mm_sub_epi32(v, vref), count);
+            d = _mm_sra_epi32(d, count);
+            _mm_storeu_si128((__m128i *)(out + i), _mm_add_epi32(d, vref));
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        out[i] = etimer_lift_one(narrow[i], ref, max_value);
+    }
+
+    return 0;
+}
+
+int etimer16_lift_raw(const uint16_t *narrow, size_t n, uint32_t ref, uint16_t max_value,
+                      uint32_t *out)
+{
+    int shift = etimer_lift_shift(max_value, 16);
+    size_t i = 0;
+
+    if (shift < 0)
+    {
+        return shift;
+    }
+
+    // differences are taken in 16-bit lanes, twice the lanes of a 32-bit subtraction, then
+    // widened with their sign
+#if defined(__AVX2__)
+    {
+        __m256i vref = _mm256_set1_epi32((int32_t)ref);
+        __m256i vref16 = _mm256_set1_epi16((int16_t)ref);
+        __m128i count = _mm_cvtsi32_si128(shift);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(narrow + i));
+            __m256i d = _mm256_sll_epi16(_mm256_sub_epi16(v, vref16), count);
+            d = _mm256_sra_epi16(d, count);
+            __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(d));
+            __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(d, 1));
+            _mm256_storeu_si256((__m256i *)(out + i), _mm256_add_epi32(lo, vref));
+            _mm256_storeu_si256((__m256i *)(out + i + 8), _mm256_add_epi32(hi, vref));
+        }
+    }
+#elif defined(__SSE2__)
+    {
+        __m128i vref = _mm_set1_epi32((int32_t)ref);
+        __m128i vref16 = _mm_set1_epi16((int16_t)ref);
+        __m128i count = _mm_cvtsi32_si128(shift);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(narrow + i));
+            __m128i d = _mm_sll_epi16(_mm_sub_epi16(v, vref16), count);
+            d = _mm_sra_epi16(d, count);
+            // SSE2 has no sign extension, duplicate each lane and shift the copy down
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(d, d), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(d, d), 16);
+            _mm_storeu_si128((__m128i *)(out + i), _mm_add_epi32(lo, vref));
+            _mm_storeu_si128((__m128i *)(out + i + 4), _mm_add_epi32(hi, vref));
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        out[i] = etimer_lift_one(narrow[i], ref, max_value);
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef _ETIMER_LIFT_H_
+#define _ETIMER_LIFT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Timestamps truncated to a narrow _raw domain, such as the 16-bit times of etimer16 carried in
+ * packet headers, are lifted to the 32-bit etimer domain as the candidate nearest to a 32-bit
+ * reference: the reference plus etimer_sub_raw(narrow, reference) with an overflow of
+ * max_value / 2. A narrow time exactly half the range away, where etimer_sub_raw() depends on
+ * which raw value is larger, is always taken as past like etimer_sub() does.
+ *
+ * The batch functions use AVX2 or SSE2 when the compiler targets them and etimer_lift_one()
+ * for the remainder, their results are identical.
+ */
+
+/**
+ * @brief  Lift one narrow timestamp, branch free.
+ * @param[in]  narrow: Time in the narrow domain, 0 to max_value.
+ * @param[in]  ref: Reference time in the etimer domain.
+ * @param[in]  max_value: Max time value of the narrow domain, max_value + 1 a power of 2. Pass
+ * 0xFFFF for etimer16 times, ETIMER16_MAX_VALUE promotes to an all ones int.
+ * @return time in the etimer domain nearest to ref.
+ */
+static inline uint32_t etimer_lift_one(uint32_t narrow, uint32_t ref, uint32_t max_value)
+{
+    uint32_t diff = (narrow - ref) & max_value;
+
+    // max_value + 1 is 0 for the full domain, where diff is already signed
+    return ref + diff - ((diff > (max_value >> 1)) ? max_value + 1 : 0);
+}
+
+/**
+ * @brief  Lift n narrow timestamps held in 32 bits.
+ * @param[in]  narrow: Times in the narrow domain, 0 to max_value.
+ * @param[in]  n: Number of times.
+ * @param[in]  ref: Reference time in the etimer domain.
+ * @param[in]  max_value: Max time value of the narrow domain.
+ * @param[out] out: Times in the etimer domain, may be the narrow array itself.
+ * @return 0 on success, -EINVAL if max_value + 1 is not a power of 2.
+ */
+int etimer_lift_raw(const uint32_t *narrow, size_t n, uint32_t ref, uint32_t max_value,
+                    uint32_t *out);
+
+/**
+ * @brief  Lift n narrow timestamps held in 16 bits.
+ * @param[in]  narrow: Times in the narrow domain, 0 to max_value.
+ * @param[in]  n: Number of times.
+ * @param[in]  ref: Reference time in the etimer domain.
+ * @param[in]  max_value: Max time value of the narrow domain, up to ETIMER16_MAX_VALUE.
+ * @param[out] out: Times in the etimer domain.
+ * @return 0 on success, -EINVAL if max_value + 1 is not a power of 2.
+ */
+int etimer16_lift_raw(const uint16_t *narrow, size_t n, uint32_t ref, uint16_t max_value,
+                      uint32_t *out);
+
+/**
+ * @brief  Lift n etimer16 timestamps.
+ * @param[in]  narrow: Times in the etimer16 domain.
+ * @param[in]  n: Number of times.
+ * @param[in]  ref: Reference time in the etimer domain.
+ * @param[out] out: Times in the etimer domain.
+ */
+static inline void etimer16_lift(const uint16_t *narrow, size_t n, uint32_t ref, uint32_t *out)
+{
+    etimer16_lift_raw(narrow, n, ref, ETIMER16_MAX_VALUE, out);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_LIFT_H_ */
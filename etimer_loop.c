@@ -0,0 +1,158 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_loop.h"
+
+static inline int etimer_loop_before(const struct etimer_co *a, const struct etimer_co *b)
+{
+    return etimer_sub(a->deadline, b->deadline) < 0;
+}
+
+static void etimer_loop_push(struct etimer_loop *loop, struct etimer_co *co)
+{
+    uint32_t pos = loop->heap_size++;
+
+    while (pos > 0 && etimer_loop_before(co, loop->heap[(pos - 1) / 2]))
+    {
+        loop->heap[pos] = loop->heap[(pos - 1) / 2];
+        pos = (pos - 1) / 2;
+    }
+    loop->heap[pos] = co;
+}
+
+static struct etimer_co *etimer_loop_pop(struct etimer_loop *loop)
+{
+    struct etimer_co *top = loop->heap[0];
+    struct etimer_co *last = loop->heap[--loop->heap_size];
+    uint32_t pos = 0;
+
+    for (;;)
+    {
+        uint32_t child = pos * 2 + 1;
+        if (child >= loop->heap_size)
+        {
+            break;
+        }
+        if (child + 1 < loop->heap_size &&
+            etimer_loop_before(loop->heap[child + 1], loop->heap[child]))
+        {
+            child++;
+        }
+        if (!etimer_loop_before(loop->heap[child], last))
+        {
+            break;
+        }
+        loop->heap[pos] = loop->heap[child];
+        pos = child;
+    }
+    loop->heap[pos] = last;
+
+    return top;
+}
+
+int etimer_loop_init(struct etimer_loop *loop, size_t frame_size, uint32_t frame_count,
+                     uint32_t now)
+{
+    uint32_t i;
+
+    memset(loop, 0, sizeof(*loop));
+
+    // Keep every frame pointer aligned, a pool larger than size_t is bad input.
+    if (frame_size > SIZE_MAX - sizeof(void *))
+    {
+        return -EINVAL;
+    }
+    frame_size = (frame_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+    if (frame_size < sizeof(struct etimer_co))
+    {
+        frame_size = sizeof(struct etimer_co);
+    }
+    if (frame_count && frame_size > SIZE_MAX / frame_count)
+    {
+        return -EINVAL;
+    }
+
+    loop->pool = malloc(frame_size * frame_count);
+    loop->heap = malloc(sizeof(*loop->heap) * frame_count);
+    if (loop->pool == NULL || loop->heap == NULL)
+    {
+        etimer_loop_deinit(loop);
+        return -ENOMEM;
+    }
+
+    loop->now = now;
+    loop->frame_size = frame_size;
+    loop->frame_count = frame_count;
+    for (i = frame_count; i > 0; i--)
+    {
+        struct etimer_co *co = (struct etimer_co *)((char *)loop->pool + (i - 1) * frame_size);
+        co->next = loop->free_list;
+        loop->free_list = co;
+    }
+
+    return 0;
+}
+
+void etimer_loop_deinit(struct etimer_loop *loop)
+{
+    free(loop->pool);
+    free(loop->heap);
+    memset(loop, 0, sizeof(*loop));
+}
+
+struct etimer_co *etimer_loop_spawn(struct etimer_loop *loop, etimer_co_fn_t fn)
+{
+    struct etimer_co *co = loop->free_list;
+
+    if (co == NULL)
+    {
+        return NULL;
+    }
+    loop->free_list = co->next;
+
+    memset(co, 0, loop->frame_size);
+    co->loop = loop;
+    co->fn = fn;
+    co->deadline = loop->now;
+    etimer_loop_push(loop, co);
+    loop->spawned++;
+
+    return co;
+}
+
+uint32_t etimer_loop_run(struct etimer_loop *loop, uint32_t now)
+{
+    uint32_t resumed = 0;
+
+    loop->now = now;
+    while (loop->heap_size && etimer_sub(loop->heap[0]->deadline, now) <= 0)
+    {
+        struct etimer_co *co = etimer_loop_pop(loop);
+
+        resumed++;
+        if (co->fn(co) == ETIMER_CO_WAIT)
+        {
+            etimer_loop_push(loop, co);
+        }
+        else
+        {
+            co->next = loop->free_list;
+            loop->free_list = co;
+        }
+    }
+    loop->resumed += resumed;
+
+    return resumed;
+}
+
+int etimer_loop_next(const struct etimer_loop *loop, uint32_t *deadline)
+{
+    if (loop->heap_size == 0)
+    {
+        return 0;
+    }
+
+    *deadline = loop->heap[0]->deadline;
+    return 1;
+}
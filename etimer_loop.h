@@ -0,0 +1,145 @@
+#ifndef _ETIMER_LOOP_H_
+#define _ETIMER_LOOP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Single threaded event loop running stackless coroutines that sleep until wrapped deadlines.
+ * A coroutine frame is a user struct whose first member is struct etimer_co, its fields hold
+ * the state that must survive a sleep. Frames come from a fixed pool allocated once at init.
+ *
+ *   struct blink
+ *   {
+ *       struct etimer_co co;
+ *       int i;
+ *   };
+ *
+ *   static int blink_fn(struct etimer_co *co)
+ *   {
+ *       struct blink *b = (struct blink *)co;
+ *       ETIMER_CO_BEGIN(co);
+ *       for (b->i = 0; b->i < 10; b->i++)
+ *       {
+ *           led_toggle();
+ *           ETIMER_CO_SLEEP_FOR(co, 500);
+ *       }
+ *       ETIMER_CO_END(co);
+ *   }
+ *
+ * Locals of the coroutine function do not survive a sleep, and only one ETIMER_CO_* await may be
+ * used per source line.
+ */
+
+#define ETIMER_CO_WAIT 0
+#define ETIMER_CO_DONE 1
+
+struct etimer_co;
+struct etimer_loop;
+
+typedef int (*etimer_co_fn_t)(struct etimer_co *co);
+
+struct etimer_co
+{
+    struct etimer_loop *loop;
+    etimer_co_fn_t fn;
+    uint32_t deadline;
+    uint32_t line;
+    struct etimer_co *next; /* free list */
+};
+
+struct etimer_loop
+{
+    uint32_t now;
+    struct etimer_co **heap;
+    uint32_t heap_size;
+    void *pool;
+    struct etimer_co *free_list;
+    size_t frame_size;
+    uint32_t frame_count;
+    uint32_t spawned; /* statistics */
+    uint32_t resumed;
+};
+
+#define ETIMER_CO_BEGIN(co)                                                                        \
+    switch ((co)->line)                                                                            \
+    {                                                                                              \
+    case 0:
+
+#define ETIMER_CO_END(co)                                                                          \
+    }                                                                                              \
+    (co)->line = 0;                                                                                \
+    return ETIMER_CO_DONE
+
+/**
+ * @brief  Suspend the coroutine until the absolute time t.
+ */
+#define ETIMER_CO_SLEEP_UNTIL(co, t)                                                               \
+    do                                                                                             \
+    {                                                                                              \
+        (co)->deadline = (t);                                                                      \
+        (co)->line = __LINE__;                                                                     \
+        return ETIMER_CO_WAIT;                                                                     \
+    case __LINE__:;                                                                                \
+    } while (0)
+
+/**
+ * @brief  Suspend the coroutine for ticks from the loop's current time.
+ */
+#define ETIMER_CO_SLEEP_FOR(co, ticks)                                                             \
+    ETIMER_CO_SLEEP_UNTIL(co, etimer_add((co)->loop->now, ticks))
+
+/**
+ * @brief  Allocate the frame pool and the deadline heap.
+ * @param[out] loop: Loop.
+ * @param[in]  frame_size: Size of the largest coroutine frame struct.
+ * @param[in]  frame_count: Max number of live coroutines.
+ * @param[in]  now: Current absolute time.
+ * @return 0 on success, -EINVAL if the pool size overflows size_t, -ENOMEM on failure.
+ */
+int etimer_loop_init(struct etimer_loop *loop, size_t frame_size, uint32_t frame_count,
+                     uint32_t now);
+
+/**
+ * @brief  Free the pool, live coroutines are dropped.
+ * @param[in]  loop: Loop.
+ */
+void etimer_loop_deinit(struct etimer_loop *loop);
+
+/**
+ * @brief  Take a zeroed frame from the pool and schedule fn to start at the loop's current time.
+ * @param[in]  loop: Loop.
+ * @param[in]  fn: Coroutine function.
+ * @return frame, cast to the user struct, NULL if the pool is exhausted.
+ */
+struct etimer_co *etimer_loop_spawn(struct etimer_loop *loop, etimer_co_fn_t fn);
+
+/**
+ * @brief  Resume, in deadline order, every coroutine whose deadline is not after now, including
+ * ones that sleep again until a time not after now. Finished coroutines return their frame to the
+ * pool.
+ * @param[in]  loop: Loop.
+ * @param[in]  now: Current absolute time.
+ * @return number of resumes.
+ */
+uint32_t etimer_loop_run(struct etimer_loop *loop, uint32_t now);
+
+/**
+ * @brief  Earliest deadline of the sleeping coroutines.
+ * @param[in]  loop: Loop.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a coroutine is alive.
+ */
+int etimer_loop_next(const struct etimer_loop *loop, uint32_t *deadline);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_LOOP_H_ */
@@ -0,0 +1,212 @@
+#include "etimer_min.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Deadlines are reduced in chunks small enough to stay in L1, the index is only searched in a
+// chunk that improves on the best value so far.
+#define ETIMER_MIN_CHUNK 1024
+
+static inline uint32_t etimer_min_key(uint32_t deadline, uint32_t base, uint32_t range)
+{
+    return deadline - base + (deadline < base ? range : 0);
+}
+
+static inline uint16_t etimer16_min_key(uint16_t deadline, uint16_t base, uint16_t range)
+{
+    return (uint16_t)(deadline - base + (deadline < base ? range : 0));
+}
+
+static uint32_t etimer_min_chunk(const uint32_t *deadlines, size_t n, uint32_t base,
+                                 uint32_t range)
+{
+    uint32_t m = ~(uint32_t)0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    if (n >= 8)
+    {
+        uint32_t lanes[8];
+        __m256i vbase = _mm256_set1_epi32(base);
+        __m256i vrange = _mm256_set1_epi32(range);
+        __m256i vm = _mm256_set1_epi32(-1);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(deadlines + i));
+            __m256i ge = _mm256_cmpeq_epi32(_mm256_max_epu32(v, vbase), v);
+            __m256i k = _mm256_sub_epi32(v, vbase);
+            k = _mm256_add_epi32(k, _mm256_andnot_si256(ge, vrange));
+            vm = _mm256_min_epu32(vm, k);
+        }
+        _mm256_storeu_si256((__m256i *)lanes, vm);
+        for (size_t j = 0; j < 8; j++)
+        {
+            m = lanes[j] < m ? lanes[j] : m;
+        }
+    }
+#elif defined(__SSE2__)
+    if (n >= 4)
+    {
+        // SSE2 only has signed compares, work on values biased by 0x80000000.
+        uint32_t lanes[4];
+        __m128i bias = _mm_set1_epi32((int32_t)0x80000000);
+        __m128i vbase = _mm_set1_epi32(base);
+        __m128i vbase_b = _mm_xor_si128(vbase, bias);
+        __m128i vrange = _mm_set1_epi32(range);
+        __m128i vm = _mm_set1_epi32(0x7FFFFFFF);
+        for (; i + 4 <= n; i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(deadlines + i));
+            __m128i lt = _mm_cmpgt_epi32(vbase_b, _mm_xor_si128(v, bias));
+            __m128i k = _mm_sub_epi32(v, vbase);
+            k = _mm_xor_si128(_mm_add_epi32(k, _mm_and_si128(lt, vrange)), bias);
+            __m128i c = _mm_cmplt_epi32(k, vm);
+            vm = _mm_or_si128(_mm_and_si128(c, k), _mm_andnot_si128(c, vm));
+        }
+        _mm_storeu_si128((__m128i *)lanes, _mm_xor_si128(vm, bias));
+        for (size_t j = 0; j < 4; j++)
+        {
+            m = lanes[j] < m ? lanes[j] : m;
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        uint32_t k = etimer_min_key(deadlines[i], base, range);
+        m = k < m ? k : m;
+    }
+
+    return m;
+}
+
+static uint16_t etimer16_min_chunk(const uint16_t *deadlines, size_t n, uint16_t base,
+                                   uint16_t range)
+{
+    uint16_t m = ~(uint16_t)0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    if (n >= 16)
+    {
+        uint16_t lanes[16];
+        __m256i vbase = _mm256_set1_epi16((int16_t)base);
+        __m256i vrange = _mm256_set1_epi16((int16_t)range);
+        __m256i vm = _mm256_set1_epi16(-1);
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(deadlines + i));
+            __m256i ge = _mm256_cmpeq_epi16(_mm256_max_epu16(v, vbase), v);
+            __m256i k = _mm256_sub_epi16(v, vbase);
+            k = _mm256_add_epi16(k, _mm256_andnot_si256(ge, vrange));
+            vm = _mm256_min_epu16(vm, k);
+        }
+        _mm256_storeu_si256((__m256i *)lanes, vm);
+        for (size_t j = 0; j < 16; j++)
+        {
+            m = lanes[j] < m ? lanes[j] : m;
+        }
+    }
+#elif defined(__SSE2__)
+    if (n >= 8)
+    {
+        // SSE2 only has signed 16bit min, work on values biased by 0x8000.
+        uint16_t lanes[8];
+        __m128i bias = _mm_set1_epi16((int16_t)0x8000);
+        __m128i vbase = _mm_set1_epi16((int16_t)base);
+        __m128i vbase_b = _mm_xor_si128(vbase, bias);
+        __m128i vrange = _mm_set1_epi16((int16_t)range);
+        __m128i vm = _mm_set1_epi16(0x7FFF);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(deadlines + i));
+            __m128i lt = _mm_cmpgt_epi16(vbase_b, _mm_xor_si128(v, bias));
+            __m128i k = _mm_sub_epi16(v, vbase);
+            k = _mm_xor_si128(_mm_add_epi16(k, _mm_and_si128(lt, vrange)), bias);
+            vm = _mm_min_epi16(vm, k);
+        }
+        _mm_storeu_si128((__m128i *)lanes, _mm_xor_si128(vm, bias));
+        for (size_t j = 0; j < 8; j++)
+        {
+            m = lanes[j] < m ? lanes[j] : m;
+        }
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        uint16_t k = etimer16_min_key(deadlines[i], base, range);
+        m = k < m ? k : m;
+    }
+
+    return m;
+}
+
+size_t etimer_min_raw(const uint32_t *deadlines, size_t n, uint32_t now, uint32_t overflow,
+                      uint32_t max_value, uint32_t *value)
+{
+    uint32_t range = max_value + 1;
+    uint32_t base = now - overflow + (now < overflow ? range : 0);
+    uint32_t best_key = 0;
+    size_t best = n;
+    size_t pos;
+
+    for (pos = 0; pos < n; pos += ETIMER_MIN_CHUNK)
+    {
+        size_t len = n - pos < ETIMER_MIN_CHUNK ? n - pos : ETIMER_MIN_CHUNK;
+        uint32_t m = etimer_min_chunk(deadlines + pos, len, base, range);
+        if (best == n || m < best_key)
+        {
+            size_t i = pos;
+            while (etimer_min_key(deadlines[i], base, range) != m)
+            {
+                i++;
+            }
+            best = i;
+            best_key = m;
+        }
+    }
+
+    if (best < n)
+    {
+        *value = deadlines[best];
+    }
+
+    return best;
+}
+
+size_t etimer16_min_raw(const uint16_t *deadlines, size_t n, uint16_t now, uint16_t overflow,
+                        uint16_t max_value, uint16_t *value)
+{
+    uint16_t range = max_value + 1;
+    uint16_t base = now - overflow + (now < overflow ? range : 0);
+    uint16_t best_key = 0;
+    size_t best = n;
+    size_t pos;
+
+    for (pos = 0; pos < n; pos += ETIMER_MIN_CHUNK)
+    {
+        size_t len = n - pos < ETIMER_MIN_CHUNK ? n - pos : ETIMER_MIN_CHUNK;
+        uint16_t m = etimer16_min_chunk(deadlines + pos, len, base, range);
+        if (best == n || m < best_key)
+        {
+            size_t i = pos;
+            while (etimer16_min_key(deadlines[i], base, range) != m)
+            {
+                i++;
+            }
+            best = i;
+            best_key = m;
+        }
+    }
+
+    if (best < n)
+    {
+        *value = deadlines[best];
+    }
+
+    return best;
+}
@@ -0,0 +1,80 @@
+#ifndef _ETIMER_MIN_H_
+#define _ETIMER_MIN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * The soonest deadline is searched relative to now: every deadline is rebased onto
+ * base = now - overflow, so the window [now - overflow, now - overflow + max_value] maps onto
+ * [0, max_value] and a plain unsigned min applies. Deadlines up to overflow in the past sort
+ * before all future deadlines, same window as etimer_past(deadline, now).
+ */
+
+/**
+ * @brief  Find the soonest of n deadlines with maxvalue/overflow check.
+ * @param[in]  deadlines: Absolute times expressed in internal time units.
+ * @param[in]  n: Number of deadlines.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  overflow: Overflow time value.
+ * @param[in]  max_value: Max time value.
+ * @param[out] value: Soonest deadline, untouched if n is 0.
+ * @return index of the first soonest deadline, n if n is 0.
+ */
+size_t etimer_min_raw(const uint32_t *deadlines, size_t n, uint32_t now, uint32_t overflow,
+                      uint32_t max_value, uint32_t *value);
+
+/**
+ * @brief  Find the soonest of n deadlines.
+ * @param[in]  deadlines: Absolute times expressed in internal time units.
+ * @param[in]  n: Number of deadlines.
+ * @param[in]  now: Current absolute time.
+ * @param[out] value: Soonest deadline, untouched if n is 0.
+ * @return index of the first soonest deadline, n if n is 0.
+ */
+static inline size_t etimer_min(const uint32_t *deadlines, size_t n, uint32_t now,
+                                uint32_t *value)
+{
+    return etimer_min_raw(deadlines, n, now, ETIMER_MAX_VALUE_OVERFLOW, ETIMER_MAX_VALUE, value);
+}
+
+/**
+ * @brief  Find the soonest of n 16bit deadlines with maxvalue/overflow check.
+ * @param[in]  deadlines: Absolute times expressed in internal time units.
+ * @param[in]  n: Number of deadlines.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  overflow: Overflow time value.
+ * @param[in]  max_value: Max time value.
+ * @param[out] value: Soonest deadline, untouched if n is 0.
+ * @return index of the first soonest deadline, n if n is 0.
+ */
+size_t etimer16_min_raw(const uint16_t *deadlines, size_t n, uint16_t now, uint16_t overflow,
+                        uint16_t max_value, uint16_t *value);
+
+/**
+ * @brief  Find the soonest of n 16bit deadlines.
+ * @param[in]  deadlines: Absolute times expressed in internal time units.
+ * @param[in]  n: Number of deadlines.
+ * @param[in]  now: Current absolute time.
+ * @param[out] value: Soonest deadline, untouched if n is 0.
+ * @return index of the first soonest deadline, n if n is 0.
+ */
+static inline size_t etimer16_min(const uint16_t *deadlines, size_t n, uint16_t now,
+                                  uint16_t *value)
+{
+    return etimer16_min_raw(deadlines, n, now, ETIMER16_MAX_VALUE_OVERFLOW, ETIMER16_MAX_VALUE,
+                            value);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_MIN_H_ */
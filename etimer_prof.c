@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "etimer_prof.h"
+
+__thread struct etimer_prof_thread *etimer_prof_tls;
+etimer_prof_read_t etimer_prof_read = etimer_prof_default_read;
+uint32_t etimer_prof_max_value = ETIMER_MAX_VALUE;
+
+static void *etimer_prof_sections[ETIMER_PROF_MAX_SECTIONS];
+static struct etimer_registry etimer_prof_registry =
+        ETIMER_REGISTRY_INIT(etimer_prof_sections, sizeof(struct etimer_prof_thread));
+
+uint32_t etimer_prof_default_read(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+#endif
+}
+
+void etimer_prof_set_clock(etimer_prof_read_t read, uint32_t max_value)
+{
+    etimer_prof_read = read ? read : etimer_prof_default_read;
+    etimer_prof_max_value = read ? max_value : ETIMER_MAX_VALUE;
+}
+
+uint32_t etimer_prof_register(struct etimer_prof_section *section)
+{
+    return etimer_registry_add(&etimer_prof_registry, &section->id, section);
+}
+
+int etimer_prof_thread_init(void)
+{
+    if (etimer_prof_tls != NULL)
+    {
+        return 0;
+    }
+
+    etimer_prof_tls = etimer_registry_table_new(&etimer_prof_registry);
+    return etimer_prof_tls != NULL ? 0 : -ENOMEM;
+}
+
+size_t etimer_prof_snapshot(struct etimer_prof_report *reports, size_t max)
+{
+    uint32_t count = etimer_registry_count(&etimer_prof_registry);
+    struct etimer_prof_thread *thread;
+    uint32_t id;
+
+    for (id = 1; id < count && id - 1 < max; id++)
+    {
+        struct etimer_prof_report *report = &reports[id - 1];
+
+        memset(report, 0, sizeof(*report));
+        report->name = ((struct etimer_prof_section *)etimer_prof_sections[id])->name;
+        for (thread = etimer_registry_tables(&etimer_prof_registry); thread != NULL;
+             thread = (struct etimer_prof_thread *)thread->link.next)
+        {
+            const struct etimer_prof_stat *stat = &thread->stats[id];
+            if (stat->count == 0)
+            {
+                continue;
+            }
+            if (report->stat.count == 0 || stat->min < report->stat.min)
+            {
+                report->stat.min = stat->min;
+            }
+            if (stat->max > report->stat.max)
+            {
+                report->stat.max = stat->max;
+            }
+            report->stat.count += stat->count;
+            report->stat.sum += stat->sum;
+            report->stat.sumsq += stat->sumsq;
+        }
+    }
+
+    return count - 1;
+}
+
+static int etimer_prof_cmp(const void *a, const void *b)
+{
+    const struct etimer_prof_report *ra = a;
+    const struct etimer_prof_report *rb = b;
+
+    return ra->stat.sum < rb->stat.sum ? 1 : ra->stat.sum > rb->stat.sum ? -1 : 0;
+}
+
+void etimer_prof_report(FILE *fp)
+{
+    struct etimer_prof_report *reports = malloc(ETIMER_PROF_MAX_SECTIONS * sizeof(*reports));
+    uint64_t total = 0;
+    size_t count, n;
+
+    if (reports == NULL)
+    {
+        return;
+    }
+
+    count = etimer_prof_snapshot(reports, ETIMER_PROF_MAX_SECTIONS);
+    qsort(reports, count, sizeof(*reports), etimer_prof_cmp);
+    for (n = 0; n < count; n++)
+    {
+        total += reports[n].stat.sum;
+    }
+
+    fprintf(fp, "%6s %14s %10s %12s %12s %10s %10s  %s\n", "%", "total", "count", "mean", "stddev",
+            "min", "max", "section");
+    for (n = 0; n < count; n++)
+    {
+        const struct etimer_prof_stat *stat = &reports[n].stat;
+        double mean = stat->count ? (double)stat->sum / stat->count : 0;
+        double var = stat->count ? stat->sumsq / stat->count - mean * mean : 0;
+
+        fprintf(fp, "%6.2f %14llu %10llu %12.1f %12.1f %10u %10u  %s\n",
+                total ? 100.0 * stat->sum / total : 0, (unsigned long long)stat->sum,
+                (unsigned long long)stat->count, mean, var > 0 ? sqrt(var) : 0, stat->min,
+                stat->max, reports[n].name);
+    }
+
+    free(reports);
+}
+
+void etimer_prof_reset(void)
+{
+    etimer_registry_reset(&etimer_prof_registry);
+}
+
+uint32_t etimer_prof_overhead(uint32_t rounds)
+{
+    // a private section and table, kept out of the report
+    struct etimer_prof_thread *saved = etimer_prof_tls;
+    struct etimer_prof_thread *scratch = calloc(1, sizeof(*scratch));
+    struct etimer_prof_section section = {"overhead", 1};
+    uint32_t begin, end, i;
+
+    if (scratch == NULL || rounds == 0)
+    {
+        free(scratch);
+        return 0;
+    }
+
+    etimer_prof_tls = scratch;
+    begin = etimer_prof_read();
+    for (i = 0; i < rounds; i++)
+    {
+        etimer_prof_add(&section, etimer_prof_read(), etimer_prof_read());
+    }
+    end = etimer_prof_read();
+    etimer_prof_tls = saved;
+    free(scratch);
+
+    return (uint32_t)etimer_sub_raw(end, begin, etimer_prof_max_value >> 1,
+                                    etimer_prof_max_value) /
+           rounds;
+}
@@ -0,0 +1,193 @@
+#ifndef _ETIMER_PROF_H_
+#define _ETIMER_PROF_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "etimer.h"
+#include "etimer_registry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Section profiler on a wrapped counter. By default the counter is the TSC truncated to 32 bits
+ * (CLOCK_MONOTONIC ns where there is no TSC), etimer_prof_set_clock() selects any other etimer
+ * domain. Elapsed time is etimer_sub_raw(end, begin), so a section must be shorter than the
+ * overflow of the domain.
+ *
+ *   ETIMER_PROF_BEGIN(parse);
+ *   parse(buf);
+ *   ETIMER_PROF_END(parse);
+ *
+ *   {
+ *       ETIMER_PROF_SCOPE(flush); // ends when leaving the block
+ *       flush();
+ *   }
+ *
+ * Statistics go to a fixed per-thread table, allocated once per thread on first use or by
+ * etimer_prof_thread_init() ahead of the measured code.
+ */
+
+#define ETIMER_PROF_MAX_SECTIONS 128
+
+typedef uint32_t (*etimer_prof_read_t)(void);
+
+struct etimer_prof_section
+{
+    const char *name;
+    uint32_t id; /* 0 until registered */
+};
+
+struct etimer_prof_stat
+{
+    uint64_t count;
+    uint64_t sum;
+    double sumsq;
+    uint32_t min;
+    uint32_t max;
+};
+
+struct etimer_prof_thread
+{
+    struct etimer_registry_table link;
+    struct etimer_prof_stat stats[ETIMER_PROF_MAX_SECTIONS];
+};
+
+struct etimer_prof_report
+{
+    const char *name;
+    struct etimer_prof_stat stat; /* summed over threads */
+};
+
+struct etimer_prof_scope
+{
+    struct etimer_prof_section *section;
+    uint32_t begin;
+};
+
+extern __thread struct etimer_prof_thread *etimer_prof_tls;
+extern etimer_prof_read_t etimer_prof_read;
+extern uint32_t etimer_prof_max_value;
+
+uint32_t etimer_prof_register(struct etimer_prof_section *section);
+
+/**
+ * @brief  Allocate the calling thread's table.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+int etimer_prof_thread_init(void);
+
+/**
+ * @brief  Select the counter, must be done before any section is measured.
+ * @param[in]  read: Counter read function, NULL restores the default.
+ * @param[in]  max_value: Max value of the counter, overflow is max_value / 2.
+ */
+void etimer_prof_set_clock(etimer_prof_read_t read, uint32_t max_value);
+
+/**
+ * @brief  Read the default counter.
+ * @return TSC or CLOCK_MONOTONIC ns truncated to 32 bits.
+ */
+uint32_t etimer_prof_default_read(void);
+
+/**
+ * @brief  Add one measurement to a section.
+ * @param[in]  section: Section.
+ * @param[in]  begin: Counter value at the start of the section.
+ * @param[in]  end: Counter value at the end of the section.
+ */
+static inline void etimer_prof_add(struct etimer_prof_section *section, uint32_t begin,
+                                   uint32_t end)
+{
+    struct etimer_prof_thread *thread = etimer_prof_tls;
+    struct etimer_prof_stat *stat;
+    uint32_t id = __atomic_load_n(&section->id, __ATOMIC_RELAXED);
+    int32_t diff = etimer_sub_raw(end, begin, etimer_prof_max_value >> 1, etimer_prof_max_value);
+    uint32_t elapsed = diff > 0 ? (uint32_t)diff : 0;
+
+    if (__builtin_expect(id == 0, 0))
+    {
+        id = etimer_prof_register(section);
+    }
+    if (__builtin_expect(thread == NULL, 0))
+    {
+        etimer_prof_thread_init();
+        thread = etimer_prof_tls;
+    }
+    if (id >= ETIMER_PROF_MAX_SECTIONS || thread == NULL)
+    {
+        return;
+    }
+
+    stat = &thread->stats[id];
+    if (stat->count == 0 || elapsed < stat->min)
+    {
+        stat->min = elapsed;
+    }
+    if (elapsed > stat->max)
+    {
+        stat->max = elapsed;
+    }
+    stat->count++;
+    stat->sum += elapsed;
+    stat->sumsq += (double)elapsed * elapsed;
+}
+
+static inline void etimer_prof_scope_end(struct etimer_prof_scope *scope)
+{
+    etimer_prof_add(scope->section, scope->begin, etimer_prof_read());
+}
+
+#define ETIMER_PROF_BEGIN(name) uint32_t etimer_prof_begin_##name = etimer_prof_read()
+
+#define ETIMER_PROF_END(name)                                                                      \
+    do                                                                                             \
+    {                                                                                              \
+        uint32_t etimer_prof_end_ = etimer_prof_read();                                            \
+        static struct etimer_prof_section etimer_prof_section_ = {#name, 0};                       \
+        etimer_prof_add(&etimer_prof_section_, etimer_prof_begin_##name, etimer_prof_end_);        \
+    } while (0)
+
+/**
+ * @brief  Measure from here to the end of the enclosing block, needs gcc/clang cleanup attribute.
+ */
+#define ETIMER_PROF_SCOPE(name)                                                                    \
+    static struct etimer_prof_section etimer_prof_section_##name = {#name, 0};                     \
+    struct etimer_prof_scope etimer_prof_scope_##name                                              \
+            __attribute__((cleanup(etimer_prof_scope_end))) = {&etimer_prof_section_##name,        \
+                                                               etimer_prof_read()}
+
+/**
+ * @brief  Sum the tables of all threads per section.
+ * @param[out] reports: Output array.
+ * @param[in]  max: Size of reports.
+ * @return number of sections, may be larger than max.
+ */
+size_t etimer_prof_snapshot(struct etimer_prof_report *reports, size_t max);
+
+/**
+ * @brief  Print a flat profile, one line per section sorted by total time.
+ * @param[in]  fp: Output stream.
+ */
+void etimer_prof_report(FILE *fp);
+
+/**
+ * @brief  Clear the tables of all threads. Racy against threads still measuring.
+ */
+void etimer_prof_reset(void);
+
+/**
+ * @brief  Cost of the profiler itself, measured over back to back empty sections.
+ * @param[in]  rounds: Number of empty sections to measure.
+ * @return mean counter ticks per section, counter reads and bookkeeping included.
+ */
+uint32_t etimer_prof_overhead(uint32_t rounds);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_PROF_H_ */
@@ -0,0 +1,79 @@
+#include <errno.h>
+#include <stdlib.h>
+
+#include "etimer_queue.h"
+
+int etimer_queue_init(struct etimer_queue *queue, uint32_t size)
+{
+    if (size == 0 || (size & (size - 1)) != 0 || size > 0x40000000u)
+    {
+        return -EINVAL;
+    }
+
+    queue->slots = calloc(size, sizeof(*queue->slots));
+    if (queue->slots == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    queue->mask = size - 1;
+    queue->space = (int32_t)size;
+    queue->tail = 0;
+    queue->head = 0;
+
+    return 0;
+}
+
+void etimer_queue_deinit(struct etimer_queue *queue)
+{
+    free(queue->slots);
+    queue->slots = NULL;
+}
+
+int etimer_queue_push(struct etimer_queue *queue, uint32_t op, uint32_t handle,
+                      uint32_t deadline)
+{
+    struct etimer_queue_slot *slot;
+    uint32_t pos;
+
+    // Reserving space first guarantees the claimed slot was consumed a lap ago: every position
+    // up to pos holds a reservation, and the consumer returns them in order.
+    if (__atomic_sub_fetch(&queue->space, 1, __ATOMIC_ACQUIRE) < 0)
+    {
+        __atomic_add_fetch(&queue->space, 1, __ATOMIC_RELAXED);
+        return -EAGAIN;
+    }
+
+    pos = __atomic_fetch_add(&queue->tail, 1, __ATOMIC_RELAXED);
+    slot = &queue->slots[pos & queue->mask];
+    slot->req.op = op;
+    slot->req.handle = handle;
+    slot->req.deadline = deadline;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+size_t etimer_queue_drain(struct etimer_queue *queue, struct etimer_queue_req *reqs, size_t max)
+{
+    uint32_t pos = queue->head;
+    size_t n;
+
+    for (n = 0; n < max; n++, pos++)
+    {
+        struct etimer_queue_slot *slot = &queue->slots[pos & queue->mask];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1)
+        {
+            break;
+        }
+        reqs[n] = slot->req;
+    }
+
+    if (n)
+    {
+        queue->head = pos;
+        __atomic_add_fetch(&queue->space, (int32_t)n, __ATOMIC_RELEASE);
+    }
+
+    return n;
+}
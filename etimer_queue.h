@@ -0,0 +1,86 @@
+#ifndef _ETIMER_QUEUE_H_
+#define _ETIMER_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Bounded multi producer, single consumer queue of timer requests, for arming and cancelling from
+ * interrupt or signal context without the scheduler's lock. Pushing is wait-free: one atomic
+ * decrement reserves space, one fetch-add claims a slot, one store publishes it, none of them
+ * retries. A producer interrupted between claim and publish only delays the consumer, which
+ * stops its batch at the first unpublished slot and picks it up on the next drain.
+ *
+ * Needs lock-free 32-bit atomics on the target.
+ */
+
+#define ETIMER_QUEUE_ARM    0
+#define ETIMER_QUEUE_CANCEL 1
+
+struct etimer_queue_req
+{
+    uint32_t op; /* ETIMER_QUEUE_xxx or user defined */
+    uint32_t handle;
+    uint32_t deadline;
+};
+
+struct etimer_queue_slot
+{
+    uint32_t seq; /* position + 1 once published */
+    struct etimer_queue_req req;
+};
+
+struct etimer_queue
+{
+    struct etimer_queue_slot *slots;
+    uint32_t mask;
+    int32_t space __attribute__((aligned(64)));
+    uint32_t tail __attribute__((aligned(64)));
+    uint32_t head __attribute__((aligned(64))); /* consumer only */
+};
+
+/**
+ * @brief  Allocate a queue.
+ * @param[out] queue: Queue.
+ * @param[in]  size: Number of slots, power of 2.
+ * @return 0 on success, -EINVAL if size is not a power of 2, -ENOMEM.
+ */
+int etimer_queue_init(struct etimer_queue *queue, uint32_t size);
+
+/**
+ * @brief  Free the queue, requests still queued are dropped.
+ * @param[in]  queue: Queue.
+ */
+void etimer_queue_deinit(struct etimer_queue *queue);
+
+/**
+ * @brief  Post a request, wait-free and safe from interrupt or signal context.
+ * @param[in]  queue: Queue.
+ * @param[in]  op: Operation.
+ * @param[in]  handle: Timer handle of the scheduler.
+ * @param[in]  deadline: Absolute expiry time, ignored by ETIMER_QUEUE_CANCEL.
+ * @return 0 on success, -EAGAIN if the queue is full.
+ */
+int etimer_queue_push(struct etimer_queue *queue, uint32_t op, uint32_t handle,
+                      uint32_t deadline);
+
+/**
+ * @brief  Take published requests in post order, consumer only.
+ * @param[in]  queue: Queue.
+ * @param[out] reqs: Requests.
+ * @param[in]  max: Size of reqs.
+ * @return number of requests taken.
+ */
+size_t etimer_queue_drain(struct etimer_queue *queue, struct etimer_queue_req *reqs, size_t max);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_QUEUE_H_ */
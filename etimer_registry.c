@@ -0,0 +1,56 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_registry.h"
+
+uint32_t etimer_registry_add(struct etimer_registry *registry, uint32_t *id, void *entry)
+{
+    uint32_t tmp;
+
+    while (__atomic_test_and_set(&registry->lock, __ATOMIC_ACQUIRE))
+    {
+    }
+
+    tmp = __atomic_load_n(id, __ATOMIC_RELAXED);
+    if (tmp == 0)
+    {
+        tmp = registry->count;
+        if (tmp < registry->max)
+        {
+            registry->entries[tmp] = entry;
+            __atomic_store_n(&registry->count, tmp + 1, __ATOMIC_RELEASE);
+        }
+        __atomic_store_n(id, tmp, __ATOMIC_RELAXED);
+    }
+
+    __atomic_clear(&registry->lock, __ATOMIC_RELEASE);
+    return tmp;
+}
+
+void *etimer_registry_table_new(struct etimer_registry *registry)
+{
+    struct etimer_registry_table *table = calloc(1, registry->table_size);
+
+    if (table == NULL)
+    {
+        return NULL;
+    }
+
+    table->next = __atomic_load_n(&registry->tables, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&registry->tables, &table->next, table, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+    }
+
+    return table;
+}
+
+void etimer_registry_reset(struct etimer_registry *registry)
+{
+    struct etimer_registry_table *table;
+
+    for (table = etimer_registry_tables(registry); table != NULL; table = table->next)
+    {
+        memset(table + 1, 0, registry->table_size - sizeof(*table));
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef _ETIMER_REGISTRY_H_
+#define _ETIMER_REGISTRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Internal scaffolding shared by etimer_stat and etimer_prof: a registry handing out small ids
+ * to static call sites or sections, and the list of per-thread tables indexed by those ids.
+ * Ids start at 1, 0 marks an entry not registered yet. Tables are never freed, so the counts of
+ * exited threads stay in the reports.
+ */
+
+struct etimer_registry_table
+{
+    struct etimer_registry_table *next;
+};
+
+struct etimer_registry
+{
+    void **entries;     /* indexed by id */
+    uint32_t max;       /* ids below max are valid */
+    size_t table_size;  /* bytes of one per-thread table, starting with its link */
+    uint32_t count;     /* next id */
+    struct etimer_registry_table *tables;
+    char lock;
+};
+
+#define ETIMER_REGISTRY_INIT(entries, table_size)                                                  \
+    {(void **)(entries), sizeof(entries) / sizeof((entries)[0]), (table_size), 1, NULL, 0}
+
+/**
+ * @brief  Give an entry its id, once.
+ * @param[in]  registry: Registry.
+ * @param[in]  id: Id field of the entry, 0 until registered.
+ * @param[in]  entry: Entry, kept for the reports.
+ * @return id, max or more when the registry is full.
+ */
+uint32_t etimer_registry_add(struct etimer_registry *registry, uint32_t *id, void *entry);
+
+/**
+ * @brief  Allocate a zeroed table for the calling thread and link it.
+ * @param[in]  registry: Registry.
+ * @return table, NULL on failure.
+ */
+void *etimer_registry_table_new(struct etimer_registry *registry);
+
+/**
+ * @brief  Zero every table after its link. Racy against threads still recording.
+ * @param[in]  registry: Registry.
+ */
+void etimer_registry_reset(struct etimer_registry *registry);
+
+/**
+ * @brief  Number of ids handed out, plus 1.
+ */
+static inline uint32_t etimer_registry_count(const struct etimer_registry *registry)
+{
+    return __atomic_load_n(&registry->count, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief  First table of the list, follow next for the others.
+ */
+static inline void *etimer_registry_tables(const struct etimer_registry *registry)
+{
+    return __atomic_load_n(&registry->tables, __ATOMIC_ACQUIRE);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_REGISTRY_H_ */
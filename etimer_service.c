@@ -0,0 +1,658 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_service.h"
+
+enum
+{
+    ETIMER_SERVICE_STATE_IDLE,
+    ETIMER_SERVICE_STATE_PENDING,
+    ETIMER_SERVICE_STATE_READY,
+    ETIMER_SERVICE_STATE_RUNNING,
+    ETIMER_SERVICE_STATE_CANCELLED,
+};
+
+enum
+{
+    ETIMER_SERVICE_OP_ADD,
+    ETIMER_SERVICE_OP_CANCEL,
+};
+
+#define ETIMER_SERVICE_NO_POS     (~(uint32_t)0)
+#define ETIMER_SERVICE_STATE_BITS 3
+#define ETIMER_SERVICE_STATE_MASK ((1u << ETIMER_SERVICE_STATE_BITS) - 1)
+
+static inline uint32_t etimer_service_load(const struct etimer_service_timer *timer)
+{
+    return __atomic_load_n(&timer->state, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief  Same generation as word, other state.
+ */
+static inline uint32_t etimer_service_with(uint32_t word, uint32_t state)
+{
+    return (word & ~ETIMER_SERVICE_STATE_MASK) | state;
+}
+
+static int etimer_service_cas(struct etimer_service_timer *timer, uint32_t from, uint32_t to)
+{
+    return __atomic_compare_exchange_n(&timer->state, &from, to, 0, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+
+//
+// Heap, owner only
+//
+static inline int etimer_service_before(const struct etimer_service_timer *a,
+                                        const struct etimer_service_timer *b)
+{
+    return etimer_sub(a->deadline, b->deadline) < 0;
+}
+
+static void etimer_service_heap_set(struct etimer_service_shard *shard, uint32_t pos,
+                                    struct etimer_service_timer *timer)
+{
+    shard->heap[pos] = timer;
+    timer->heap_pos = pos;
+}
+
+static void etimer_service_sift_up(struct etimer_service_shard *shard, uint32_t pos)
+{
+    struct etimer_service_timer *timer = shard->heap[pos];
+
+    while (pos > 0)
+    {
+        uint32_t parent = (pos - 1) / 2;
+        if (!etimer_service_before(timer, shard->heap[parent]))
+        {
+            break;
+        }
+        etimer_service_heap_set(shard, pos, shard->heap[parent]);
+        pos = parent;
+    }
+    etimer_service_heap_set(shard, pos, timer);
+}
+
+static void etimer_service_sift_down(struct etimer_service_shard *shard, uint32_t pos)
+{
+    struct etimer_service_timer *timer = shard->heap[pos];
+
+    for (;;)
+    {
+        uint32_t child = pos * 2 + 1;
+        if (child >= shard->heap_size)
+        {
+            break;
+        }
+        if (child + 1 < shard->heap_size &&
+            etimer_service_before(shard->heap[child + 1], shard->heap[child]))
+        {
+            child++;
+        }
+        if (!etimer_service_before(shard->heap[child], timer))
+        {
+            break;
+        }
+        etimer_service_heap_set(shard, pos, shard->heap[child]);
+        pos = child;
+    }
+    etimer_service_heap_set(shard, pos, timer);
+}
+
+/**
+ * @brief  Make room for count more timers.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+static int etimer_service_heap_reserve(struct etimer_service_shard *shard, uint32_t count)
+{
+    uint32_t cap = shard->heap_cap ? shard->heap_cap : 256;
+    struct etimer_service_timer **heap;
+
+    if (shard->heap_size + count <= shard->heap_cap)
+    {
+        return 0;
+    }
+    while (cap < shard->heap_size + count)
+    {
+        cap *= 2;
+    }
+    heap = realloc(shard->heap, cap * sizeof(*heap));
+    if (heap == NULL)
+    {
+        return -ENOMEM;
+    }
+    shard->heap = heap;
+    shard->heap_cap = cap;
+
+    return 0;
+}
+
+static int etimer_service_heap_push(struct etimer_service_shard *shard,
+                                    struct etimer_service_timer *timer)
+{
+    if (etimer_service_heap_reserve(shard, 1) != 0)
+    {
+        return -ENOMEM;
+    }
+
+    shard->heap[shard->heap_size] = timer;
+    etimer_service_sift_up(shard, shard->heap_size++);
+
+    return 0;
+}
+
+static void etimer_service_heap_remove(struct etimer_service_shard *shard,
+                                       struct etimer_service_timer *timer)
+{
+    uint32_t pos = timer->heap_pos;
+    struct etimer_service_timer *last = shard->heap[--shard->heap_size];
+
+    timer->heap_pos = ETIMER_SERVICE_NO_POS;
+    if (last == timer)
+    {
+        return;
+    }
+
+    etimer_service_heap_set(shard, pos, last);
+    if (pos > 0 && etimer_service_before(last, shard->heap[(pos - 1) / 2]))
+    {
+        etimer_service_sift_up(shard, pos);
+    }
+    else
+    {
+        etimer_service_sift_down(shard, pos);
+    }
+}
+
+//
+// Inbox, bounded MPSC ring with per cell sequence numbers
+//
+static int etimer_service_post(struct etimer_service_shard *shard, uint32_t op,
+                               struct etimer_service_timer *timer, uint32_t state,
+                               uint32_t deadline)
+{
+    uint32_t pos = __atomic_load_n(&shard->inbox_tail, __ATOMIC_RELAXED);
+
+    for (;;)
+    {
+        struct etimer_service_msg *msg = &shard->inbox[pos & (ETIMER_SERVICE_INBOX_SIZE - 1)];
+        int32_t dif = (int32_t)(__atomic_load_n(&msg->seq, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0)
+        {
+            if (__atomic_compare_exchange_n(&shard->inbox_tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                msg->op = op;
+                msg->state = state;
+                msg->deadline = deadline;
+                msg->timer = timer;
+                __atomic_store_n(&msg->seq, pos + 1, __ATOMIC_RELEASE);
+                return 0;
+            }
+        }
+        else if (dif < 0)
+        {
+            return -EAGAIN;
+        }
+        else
+        {
+            pos = __atomic_load_n(&shard->inbox_tail, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief  Apply at most one inbox worth of messages. The heap is grown for all of them first, so
+ * an ADD is never dropped once posted. Without memory they stay queued and a full inbox makes
+ * etimer_service_start() return -EAGAIN.
+ */
+static void etimer_service_drain(struct etimer_service_shard *shard, uint32_t self)
+{
+    uint32_t i;
+
+    if (etimer_service_heap_reserve(shard, ETIMER_SERVICE_INBOX_SIZE) != 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < ETIMER_SERVICE_INBOX_SIZE; i++)
+    {
+        uint32_t pos = shard->inbox_head;
+        struct etimer_service_msg *msg = &shard->inbox[pos & (ETIMER_SERVICE_INBOX_SIZE - 1)];
+        struct etimer_service_timer *timer;
+
+        if (__atomic_load_n(&msg->seq, __ATOMIC_ACQUIRE) != pos + 1)
+        {
+            return;
+        }
+
+        timer = msg->timer;
+        if (msg->op == ETIMER_SERVICE_OP_ADD)
+        {
+            if (etimer_service_load(timer) == msg->state)
+            {
+                timer->deadline = msg->deadline;
+                etimer_service_heap_push(shard, timer); // reserved
+            }
+            else
+            {
+                // Cancelled before it got here.
+                etimer_service_cas(timer,
+                                   etimer_service_with(msg->state, ETIMER_SERVICE_STATE_CANCELLED),
+                                   etimer_service_with(msg->state, ETIMER_SERVICE_STATE_IDLE));
+            }
+        }
+        else if (timer->shard == self && timer->heap_pos != ETIMER_SERVICE_NO_POS &&
+                 etimer_service_load(timer) == msg->state)
+        {
+            etimer_service_heap_remove(shard, timer);
+            __atomic_store_n(&timer->state,
+                             etimer_service_with(msg->state, ETIMER_SERVICE_STATE_IDLE),
+                             __ATOMIC_RELEASE);
+        }
+
+        __atomic_store_n(&msg->seq, pos + ETIMER_SERVICE_INBOX_SIZE, __ATOMIC_RELEASE);
+        shard->inbox_head = pos + 1;
+    }
+}
+
+//
+// Ready deque (Chase-Lev, fixed size). Only the owner pushes at the bottom, the owner and thieves
+// take from the top so expired timers still run in deadline order.
+//
+static int etimer_service_ready_push(struct etimer_service_shard *shard,
+                                     struct etimer_service_timer *timer)
+{
+    int64_t b = __atomic_load_n(&shard->ready_bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&shard->ready_top, __ATOMIC_ACQUIRE);
+
+    if (b - t >= ETIMER_SERVICE_READY_SIZE)
+    {
+        return -EAGAIN;
+    }
+
+    __atomic_store_n(&shard->ready[b & (ETIMER_SERVICE_READY_SIZE - 1)], timer,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&shard->ready_bottom, b + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+static struct etimer_service_timer *etimer_service_ready_steal(struct etimer_service_shard *shard)
+{
+    int64_t t = __atomic_load_n(&shard->ready_top, __ATOMIC_ACQUIRE);
+    int64_t b;
+    struct etimer_service_timer *timer;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    b = __atomic_load_n(&shard->ready_bottom, __ATOMIC_ACQUIRE);
+    if (t >= b)
+    {
+        return NULL;
+    }
+
+    timer = __atomic_load_n(&shard->ready[t & (ETIMER_SERVICE_READY_SIZE - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&shard->ready_top, &t, t + 1, 0, __ATOMIC_SEQ_CST,
+                                     __ATOMIC_RELAXED))
+    {
+        return NULL;
+    }
+
+    return timer;
+}
+
+/**
+ * @brief  Run a ready timer unless it was cancelled meanwhile.
+ * @return resulting 1 means the callback ran.
+ */
+static int etimer_service_run(struct etimer_service_timer *timer, struct etimer_service_late *late,
+                              uint32_t now)
+{
+    uint32_t state = etimer_service_load(timer);
+
+    if ((state & ETIMER_SERVICE_STATE_MASK) != ETIMER_SERVICE_STATE_READY ||
+        !etimer_service_cas(timer, state,
+                            etimer_service_with(state, ETIMER_SERVICE_STATE_RUNNING)))
+    {
+        return 0;
+    }
+
+    if (late != NULL)
+    {
+        etimer_service_late_record(late, timer, now);
+    }
+    timer->cb(timer, timer->arg);
+    // A re-arm bumped the generation, possibly onto another shard already running it again.
+    etimer_service_cas(timer, etimer_service_with(state, ETIMER_SERVICE_STATE_RUNNING),
+                       etimer_service_with(state, ETIMER_SERVICE_STATE_IDLE));
+
+    return 1;
+}
+
+void etimer_service_timer_init(struct etimer_service_timer *timer, etimer_service_cb_t cb,
+                               void *arg)
+{
+    memset(timer, 0, sizeof(*timer));
+    timer->state = ETIMER_SERVICE_STATE_IDLE;
+    timer->heap_pos = ETIMER_SERVICE_NO_POS;
+    timer->cb = cb;
+    timer->arg = arg;
+}
+
+int etimer_service_init(struct etimer_service *svc, uint32_t shard_count)
+{
+    uint32_t i, j;
+
+    svc->shard_count = shard_count;
+    svc->late_enabled = 0;
+    svc->shards = calloc(shard_count, sizeof(*svc->shards));
+    if (svc->shards == NULL)
+    {
+        return -ENOMEM;
+    }
+
+    for (i = 0; i < shard_count; i++)
+    {
+        for (j = 0; j < ETIMER_SERVICE_INBOX_SIZE; j++)
+        {
+            svc->shards[i].inbox[j].seq = j;
+        }
+        svc->shards[i].steal_from = i + 1;
+    }
+
+    return 0;
+}
+
+void etimer_service_deinit(struct etimer_service *svc)
+{
+    uint32_t i;
+
+    for (i = 0; i < svc->shard_count; i++)
+    {
+        free(svc->shards[i].heap);
+    }
+    free(svc->shards);
+    svc->shards = NULL;
+    svc->shard_count = 0;
+}
+
+int etimer_service_start(struct etimer_service *svc, uint32_t self,
+                         struct etimer_service_timer *timer, uint32_t shard, uint32_t deadline)
+{
+    uint32_t state = etimer_service_load(timer), pending;
+    int ret;
+
+    do
+    {
+        if ((state & ETIMER_SERVICE_STATE_MASK) != ETIMER_SERVICE_STATE_IDLE &&
+            (state & ETIMER_SERVICE_STATE_MASK) != ETIMER_SERVICE_STATE_RUNNING)
+        {
+            return -EBUSY;
+        }
+        pending = etimer_service_with(state + (1u << ETIMER_SERVICE_STATE_BITS),
+                                      ETIMER_SERVICE_STATE_PENDING);
+    } while (!__atomic_compare_exchange_n(&timer->state, &state, pending, 0, __ATOMIC_ACQ_REL,
+                                          __ATOMIC_ACQUIRE));
+
+    timer->shard = shard;
+    if (shard == self)
+    {
+        timer->deadline = deadline;
+        ret = etimer_service_heap_push(&svc->shards[shard], timer);
+    }
+    else
+    {
+        ret = etimer_service_post(&svc->shards[shard], ETIMER_SERVICE_OP_ADD, timer, pending,
+                                  deadline);
+    }
+
+    if (ret != 0)
+    {
+        __atomic_store_n(&timer->state, etimer_service_with(pending, ETIMER_SERVICE_STATE_IDLE),
+                         __ATOMIC_RELEASE);
+    }
+
+    return ret;
+}
+
+int etimer_service_cancel(struct etimer_service *svc, uint32_t self,
+                          struct etimer_service_timer *timer)
+{
+    uint32_t state = etimer_service_load(timer), cancelled;
+    uint32_t shard;
+
+    for (;;)
+    {
+        if ((state & ETIMER_SERVICE_STATE_MASK) == ETIMER_SERVICE_STATE_READY)
+        {
+            if (etimer_service_cas(timer, state,
+                                   etimer_service_with(state, ETIMER_SERVICE_STATE_IDLE)))
+            {
+                return 0;
+            }
+        }
+        else if ((state & ETIMER_SERVICE_STATE_MASK) != ETIMER_SERVICE_STATE_PENDING)
+        {
+            return -EALREADY;
+        }
+        else if (etimer_service_cas(timer, state,
+                                    etimer_service_with(state, ETIMER_SERVICE_STATE_CANCELLED)))
+        {
+            break;
+        }
+        state = etimer_service_load(timer);
+    }
+    cancelled = etimer_service_with(state, ETIMER_SERVICE_STATE_CANCELLED);
+
+    shard = timer->shard;
+    if (shard != self)
+    {
+        if (etimer_service_post(&svc->shards[shard], ETIMER_SERVICE_OP_CANCEL, timer, cancelled,
+                                0) != 0 &&
+            etimer_service_cas(timer, cancelled, state))
+        {
+            return -EAGAIN;
+        }
+        return 0;
+    }
+
+    // Not in the heap yet if its ADD message is still in our inbox, draining it finishes.
+    if (timer->heap_pos != ETIMER_SERVICE_NO_POS)
+    {
+        etimer_service_heap_remove(&svc->shards[self], timer);
+        __atomic_store_n(&timer->state, etimer_service_with(state, ETIMER_SERVICE_STATE_IDLE),
+                         __ATOMIC_RELEASE);
+    }
+
+    return 0;
+}
+
+int etimer_service_idle(const struct etimer_service_timer *timer)
+{
+    return (etimer_service_load(timer) & ETIMER_SERVICE_STATE_MASK) == ETIMER_SERVICE_STATE_IDLE;
+}
+
+uint32_t etimer_service_poll(struct etimer_service *svc, uint32_t self, uint32_t now,
+                             uint32_t budget)
+{
+    struct etimer_service_shard *shard = &svc->shards[self];
+    struct etimer_service_late *late =
+            __atomic_load_n(&svc->late_enabled, __ATOMIC_RELAXED) ? &shard->late : NULL;
+    struct etimer_service_timer *timer;
+    uint32_t ran = 0, state;
+    uint32_t i;
+
+    etimer_service_drain(shard, self);
+
+    // Backlog from previous polls first.
+    while (ran < budget && (timer = etimer_service_ready_steal(shard)) != NULL)
+    {
+        ran += etimer_service_run(timer, late, now);
+    }
+
+    while (shard->heap_size && etimer_sub(shard->heap[0]->deadline, now) <= 0)
+    {
+        timer = shard->heap[0];
+        etimer_service_heap_remove(shard, timer);
+        // The generation cannot change while it is in the heap.
+        state = etimer_service_with(etimer_service_load(timer), ETIMER_SERVICE_STATE_PENDING);
+        if (!etimer_service_cas(timer, state,
+                                etimer_service_with(state, ETIMER_SERVICE_STATE_READY)))
+        {
+            // Cancelled, its CANCEL message is still in flight.
+            __atomic_store_n(&timer->state, etimer_service_with(state, ETIMER_SERVICE_STATE_IDLE),
+                             __ATOMIC_RELEASE);
+            continue;
+        }
+        if (ran < budget)
+        {
+            ran += etimer_service_run(timer, late, now);
+            continue;
+        }
+        if (etimer_service_ready_push(shard, timer) != 0)
+        {
+            // Deque full, keep it pending for the next poll.
+            __atomic_store_n(&timer->state, state, __ATOMIC_RELEASE);
+            etimer_service_heap_push(shard, timer);
+            break;
+        }
+    }
+
+    // Nothing of our own left, help the others.
+    for (i = 0; ran < budget && i + 1 < svc->shard_count; i++)
+    {
+        uint32_t victim = shard->steal_from % svc->shard_count;
+        if (victim == self)
+        {
+            victim = (victim + 1) % svc->shard_count;
+        }
+        while (ran < budget && (timer = etimer_service_ready_steal(&svc->shards[victim])) != NULL)
+        {
+            ran += etimer_service_run(timer, late, now);
+        }
+        shard->steal_from = victim + 1;
+    }
+
+    return ran;
+}
+
+int etimer_service_next(const struct etimer_service *svc, uint32_t self, uint32_t *deadline)
+{
+    const struct etimer_service_shard *shard = &svc->shards[self];
+
+    if (shard->heap_size == 0)
+    {
+        return 0;
+    }
+
+    *deadline = shard->heap[0]->deadline;
+    return 1;
+}
+
+void etimer_service_late_enable(struct etimer_service *svc, int enable)
+{
+    __atomic_store_n(&svc->late_enabled, enable != 0, __ATOMIC_RELAXED);
+}
+
+void etimer_service_late_snapshot(const struct etimer_service *svc,
+                                  struct etimer_service_late *late)
+{
+    uint32_t i, j;
+
+    memset(late, 0, sizeof(*late));
+    for (i = 0; i < svc->shard_count; i++)
+    {
+        const struct etimer_service_late *src = &svc->shards[i].late;
+
+        for (j = 0; j < ETIMER_SERVICE_LATE_BUCKETS; j++)
+        {
+            late->hist[j] += __atomic_load_n(&src->hist[j], __ATOMIC_RELAXED);
+        }
+        for (j = 0; j < ETIMER_SERVICE_LATE_CLASSES; j++)
+        {
+            struct etimer_service_late_class *cls = &late->classes[j];
+            uint32_t max = __atomic_load_n(&src->classes[j].max, __ATOMIC_RELAXED);
+
+            cls->count += __atomic_load_n(&src->classes[j].count, __ATOMIC_RELAXED);
+            cls->sum += __atomic_load_n(&src->classes[j].sum, __ATOMIC_RELAXED);
+            if (max > cls->max)
+            {
+                cls->max = max;
+                cls->max_deadline = __atomic_load_n(&src->classes[j].max_deadline,
+                                                    __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+void etimer_service_late_reset(struct etimer_service *svc)
+{
+    uint32_t i;
+
+    for (i = 0; i < svc->shard_count; i++)
+    {
+        memset(&svc->shards[i].late, 0, sizeof(svc->shards[i].late));
+    }
+}
+
+uint32_t etimer_service_late_quantile(const struct etimer_service_late *late, uint32_t permille)
+{
+    uint64_t total = 0, seen = 0, rank;
+    uint32_t i;
+
+    for (i = 0; i < ETIMER_SERVICE_LATE_BUCKETS; i++)
+    {
+        total += late->hist[i];
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    rank = (total * permille + 999) / 1000;
+    for (i = 0; i < ETIMER_SERVICE_LATE_BUCKETS - 1; i++)
+    {
+        seen += late->hist[i];
+        if (seen >= rank && seen > 0)
+        {
+            break;
+        }
+    }
+
+    return i ? (uint32_t)((2ull << (i - 1)) - 1) : 0;
+}
+
+size_t etimer_service_late_worst(const struct etimer_service_late *late, uint32_t *classes,
+                                 size_t max)
+{
+    size_t n = 0, k;
+    uint32_t i;
+
+    // insertion into the first max, there are only ETIMER_SERVICE_LATE_CLASSES
+    for (i = 0; i < ETIMER_SERVICE_LATE_CLASSES; i++)
+    {
+        if (late->classes[i].count == 0)
+        {
+            continue;
+        }
+        for (k = n < max ? n++ : max; k > 0; k--)
+        {
+            if (late->classes[classes[k - 1]].max >= late->classes[i].max)
+            {
+                break;
+            }
+            if (k < max)
+            {
+                classes[k] = classes[k - 1];
+            }
+        }
+        if (k < max)
+        {
+            classes[k] = i;
+        }
+    }
+
+    return n;
+}
@@ -0,0 +1,249 @@
+#ifndef _ETIMER_SERVICE_H_
+#define _ETIMER_SERVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Sharded timer service for multi-threaded hosts. Each shard is driven by one thread calling
+ * etimer_service_poll() and owns a min-heap of pending timers ordered by wrapped deadline. Expired
+ * timers run on the owning shard, those beyond the poll budget wait in the shard's ready deque
+ * where idle shards can steal them. Operations on a timer owned by another shard are posted to
+ * the owner's lock-free inbox.
+ *
+ * Pending deadlines are expected within ETIMER_MAX_VALUE_OVERFLOW of now.
+ *
+ * Optional lateness telemetry, etimer_service_late_enable(): every callback run records
+ * etimer_sub(now, deadline) of the poll running it, so time spent in the ready deque counts. Each
+ * shard keeps its own log2 histogram and per class worst case, written only by its polling thread
+ * with relaxed stores, etimer_service_late_snapshot() sums them from any thread.
+ */
+
+#define ETIMER_SERVICE_INBOX_SIZE   4096 /* per shard, power of 2 */
+#define ETIMER_SERVICE_READY_SIZE   4096 /* per shard, power of 2 */
+#define ETIMER_SERVICE_LATE_BUCKETS 32   /* 0 on time, b late by [2^(b-1), 2^b) */
+#define ETIMER_SERVICE_LATE_CLASSES 16   /* higher classes count in the last one */
+
+struct etimer_service_timer;
+
+typedef void (*etimer_service_cb_t)(struct etimer_service_timer *timer, void *arg);
+
+struct etimer_service_timer
+{
+    uint32_t deadline;
+    uint32_t state; /* generation << 3 | ETIMER_SERVICE_STATE_xxx, atomic, bumped by start */
+    uint32_t heap_pos;
+    uint32_t shard;
+    uint32_t cls; /* lateness telemetry class, 0 after init */
+    etimer_service_cb_t cb;
+    void *arg;
+};
+
+struct etimer_service_msg
+{
+    uint32_t seq;
+    uint32_t op;
+    uint32_t state; /* timer state word when posted */
+    uint32_t deadline;
+    struct etimer_service_timer *timer;
+};
+
+struct etimer_service_late_class
+{
+    uint64_t count;
+    uint64_t sum;
+    uint32_t max;
+    uint32_t max_deadline; /* deadline of the worst (max lateness) expiry */
+};
+
+struct etimer_service_late
+{
+    uint64_t hist[ETIMER_SERVICE_LATE_BUCKETS];
+    struct etimer_service_late_class classes[ETIMER_SERVICE_LATE_CLASSES];
+};
+
+struct etimer_service_shard
+{
+    // owner only
+    struct etimer_service_timer **heap;
+    uint32_t heap_size;
+    uint32_t heap_cap;
+    uint32_t steal_from;
+
+    // inbox, multi producer single consumer
+    struct etimer_service_msg inbox[ETIMER_SERVICE_INBOX_SIZE];
+    uint32_t inbox_head __attribute__((aligned(64)));
+    uint32_t inbox_tail __attribute__((aligned(64)));
+
+    // ready deque, owner pushes at bottom, owner and thieves take from top
+    struct etimer_service_timer *ready[ETIMER_SERVICE_READY_SIZE];
+    int64_t ready_top __attribute__((aligned(64)));
+    int64_t ready_bottom __attribute__((aligned(64)));
+
+    // lateness of the callbacks run by this shard, stolen ones included, owner writes only
+    struct etimer_service_late late __attribute__((aligned(64)));
+};
+
+struct etimer_service
+{
+    struct etimer_service_shard *shards;
+    uint32_t shard_count;
+    uint32_t late_enabled;
+};
+
+/**
+ * @brief  Record the lateness of one expiry, called by the polling thread before the callback.
+ * @param[in]  late: Telemetry of the polling shard.
+ * @param[in]  timer: Expired timer.
+ * @param[in]  now: Time of the poll running it.
+ */
+static inline void etimer_service_late_record(struct etimer_service_late *late,
+                                              const struct etimer_service_timer *timer,
+                                              uint32_t now)
+{
+    int32_t diff = etimer_sub(now, timer->deadline);
+    uint32_t lateness = diff > 0 ? (uint32_t)diff : 0;
+    // branch free, on time and slightly late expiries alternate
+    uint32_t bucket = (32 - __builtin_clz(lateness | 1)) & (0 - (uint32_t)(lateness != 0));
+    uint32_t id = timer->cls < ETIMER_SERVICE_LATE_CLASSES ? timer->cls :
+                                                             ETIMER_SERVICE_LATE_CLASSES - 1;
+    struct etimer_service_late_class *cls = &late->classes[id];
+
+    // single writer, the atomic stores only keep snapshot readers from seeing torn values
+    __atomic_store_n(&late->hist[bucket], late->hist[bucket] + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&cls->count, cls->count + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&cls->sum, cls->sum + lateness, __ATOMIC_RELAXED);
+    if (__builtin_expect(lateness > cls->max, 0))
+    {
+        __atomic_store_n(&cls->max_deadline, timer->deadline, __ATOMIC_RELAXED);
+        __atomic_store_n(&cls->max, lateness, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief  Initialize a timer, must be done once before first start.
+ * @param[in]  timer: Timer.
+ * @param[in]  cb: Expiry callback, runs on the polling shard.
+ * @param[in]  arg: Callback argument.
+ */
+void etimer_service_timer_init(struct etimer_service_timer *timer, etimer_service_cb_t cb,
+                               void *arg);
+
+/**
+ * @brief  Allocate shard_count shards.
+ * @param[out] svc: Service.
+ * @param[in]  shard_count: Number of shards, usually one per thread.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+int etimer_service_init(struct etimer_service *svc, uint32_t shard_count);
+
+/**
+ * @brief  Free all shards. No shard may be polled any more.
+ * @param[in]  svc: Service.
+ */
+void etimer_service_deinit(struct etimer_service *svc);
+
+/**
+ * @brief  Start an idle timer on a shard. Can be called from an expiry callback to re-arm.
+ * @param[in]  svc: Service.
+ * @param[in]  self: Shard of the calling thread.
+ * @param[in]  timer: Timer, idle or running its own callback.
+ * @param[in]  shard: Shard owning the timer, a message is posted if it is not self.
+ * @param[in]  deadline: Absolute expiry time.
+ * @return 0 on success, -EBUSY if the timer is not idle, -EAGAIN if the inbox is full (its owner
+ * polls too rarely or is out of memory), -ENOMEM if self is out of memory. Once 0 is returned the
+ * timer either runs or is cancelled, never dropped.
+ */
+int etimer_service_start(struct etimer_service *svc, uint32_t self,
+                         struct etimer_service_timer *timer, uint32_t shard, uint32_t deadline);
+
+/**
+ * @brief  Cancel a pending or ready timer. Cancelling a timer owned by another shard is posted to
+ * the owner, the timer becomes idle once the owner polls.
+ * @param[in]  svc: Service.
+ * @param[in]  self: Shard of the calling thread.
+ * @param[in]  timer: Timer.
+ * @return 0 if the callback will not run, -EALREADY if the timer is not pending, -EAGAIN if the
+ * owner's inbox is full.
+ */
+int etimer_service_cancel(struct etimer_service *svc, uint32_t self,
+                          struct etimer_service_timer *timer);
+
+/**
+ * @brief  Check a timer is idle, ie it can be started again.
+ * @param[in]  timer: Timer.
+ * @return resulting 1 means idle.
+ */
+int etimer_service_idle(const struct etimer_service_timer *timer);
+
+/**
+ * @brief  Drive one shard: process its inbox and run up to budget expired callbacks, the rest is
+ * left in its ready deque. Steals from other shards when budget is left.
+ * @param[in]  svc: Service.
+ * @param[in]  self: Shard of the calling thread.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  budget: Max number of callbacks to run.
+ * @return number of callbacks run.
+ */
+uint32_t etimer_service_poll(struct etimer_service *svc, uint32_t self, uint32_t now,
+                             uint32_t budget);
+
+/**
+ * @brief  Earliest pending deadline of a shard, for sleeping until it.
+ * @param[in]  svc: Service.
+ * @param[in]  self: Shard of the calling thread.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a timer is pending.
+ */
+int etimer_service_next(const struct etimer_service *svc, uint32_t self, uint32_t *deadline);
+
+/**
+ * @brief  Turn lateness telemetry on or off, from any thread. Off by default.
+ * @param[in]  svc: Service.
+ * @param[in]  enable: 1 to record every expiry.
+ */
+void etimer_service_late_enable(struct etimer_service *svc, int enable);
+
+/**
+ * @brief  Sum the telemetry of all shards, from any thread while they poll.
+ * @param[in]  svc: Service.
+ * @param[out] late: Histogram and per class totals, max is the max over shards.
+ */
+void etimer_service_late_snapshot(const struct etimer_service *svc,
+                                  struct etimer_service_late *late);
+
+/**
+ * @brief  Clear the telemetry of all shards. Racy against shards still polling.
+ * @param[in]  svc: Service.
+ */
+void etimer_service_late_reset(struct etimer_service *svc);
+
+/**
+ * @brief  Lateness quantile from a histogram.
+ * @param[in]  late: Snapshot.
+ * @param[in]  permille: Quantile in 1/1000, 500 for the median.
+ * @return upper bound of the bucket holding the quantile, 0 if nothing was recorded.
+ */
+uint32_t etimer_service_late_quantile(const struct etimer_service_late *late, uint32_t permille);
+
+/**
+ * @brief  Classes that recorded expiries, worst max lateness first.
+ * @param[in]  late: Snapshot.
+ * @param[out] classes: Class ids.
+ * @param[in]  max: Size of classes.
+ * @return number of class ids written.
+ */
+size_t etimer_service_late_worst(const struct etimer_service_late *late, uint32_t *classes,
+                                 size_t max);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_SERVICE_H_ */
@@ -0,0 +1,540 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "etimer_shm.h"
+
+#define ETIMER_SHM_FREE      0
+#define ETIMER_SHM_ARMED     1
+#define ETIMER_SHM_FIRED     2
+#define ETIMER_SHM_CANCELLED 3
+#define ETIMER_SHM_STATE     3u
+#define ETIMER_SHM_INDEX     ((1u << ETIMER_SHM_INDEX_BITS) - 1)
+
+static size_t etimer_shm_size(uint32_t capacity, uint32_t owners)
+{
+    return sizeof(struct etimer_shm_header) + (size_t)owners * sizeof(struct etimer_shm_owner) +
+           (size_t)capacity * sizeof(struct etimer_shm_slot);
+}
+
+static void etimer_shm_layout(struct etimer_shm *shm, void *map, size_t size)
+{
+    shm->header = map;
+    shm->owners = (struct etimer_shm_owner *)(shm->header + 1);
+    shm->slots = (struct etimer_shm_slot *)(shm->owners + shm->header->owner_count);
+    shm->size = size;
+}
+
+/**
+ * @brief  Futex in a shared mapping, not FUTEX_PRIVATE_FLAG: waiters are other processes.
+ */
+static long etimer_shm_futex(uint32_t *addr, int op, uint32_t val, const struct timespec *ts)
+{
+    return syscall(SYS_futex, addr, op, val, ts, NULL, 0);
+}
+
+static void etimer_shm_wake(uint32_t *seq)
+{
+    __atomic_add_fetch(seq, 1, __ATOMIC_RELEASE);
+    etimer_shm_futex(seq, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+static void etimer_shm_sleep(uint32_t *seq, uint32_t val, uint32_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (long)(us % 1000000) * 1000;
+    etimer_shm_futex(seq, FUTEX_WAIT, val, &ts);
+}
+
+/**
+ * @brief  Push a slot on a stack whose head is only ever taken whole, through its link field.
+ */
+static void etimer_shm_push(uint32_t *head, uint32_t *link, uint32_t index)
+{
+    uint32_t old = __atomic_load_n(head, __ATOMIC_RELAXED);
+
+    do
+    {
+        __atomic_store_n(link, old, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(head, &old, index, 1, __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+}
+
+static uint32_t etimer_shm_pop_free(struct etimer_shm *shm)
+{
+    uint64_t old = __atomic_load_n(&shm->header->free_head, __ATOMIC_ACQUIRE), next;
+    uint32_t index;
+
+    do
+    {
+        index = (uint32_t)old;
+        if (index == ETIMER_SHM_NONE)
+        {
+            return ETIMER_SHM_NONE;
+        }
+        // may read a slot popped meanwhile, the tag then fails the exchange
+        next = ((old >> 32) + 1) << 32 |
+               __atomic_load_n(&shm->slots[index].next, __ATOMIC_RELAXED);
+    } while (!__atomic_compare_exchange_n(&shm->header->free_head, &old, next, 1,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE));
+
+    return index;
+}
+
+static void etimer_shm_push_free(struct etimer_shm *shm, uint32_t index)
+{
+    struct etimer_shm_slot *slot = &shm->slots[index];
+    uint64_t old = __atomic_load_n(&shm->header->free_head, __ATOMIC_RELAXED), next;
+    uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot->state, (state & ~ETIMER_SHM_STATE) | ETIMER_SHM_FREE,
+                     __ATOMIC_RELAXED);
+    do
+    {
+        __atomic_store_n(&slot->next, (uint32_t)old, __ATOMIC_RELAXED);
+        next = ((old >> 32) + 1) << 32 | index;
+    } while (!__atomic_compare_exchange_n(&shm->header->free_head, &old, next, 1,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+int etimer_shm_create(struct etimer_shm *shm, const char *name, uint32_t capacity,
+                      uint32_t owners)
+{
+    struct etimer_shm_header *header;
+    size_t size = etimer_shm_size(capacity, owners);
+    void *map;
+    uint32_t i;
+    int fd, ret;
+
+    memset(shm, 0, sizeof(*shm));
+    if (capacity == 0 || capacity > ETIMER_SHM_INDEX || owners == 0 || owners > 0xFFFF)
+    {
+        return -EINVAL;
+    }
+
+    fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (ftruncate(fd, (off_t)size) != 0)
+    {
+        ret = -errno;
+        close(fd);
+        shm_unlink(name);
+        return ret;
+    }
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        ret = -errno;
+        shm_unlink(name);
+        return ret;
+    }
+
+    // fresh pages read 0, every slot free at generation 0
+    header = map;
+    header->version = ETIMER_SHM_VERSION;
+    header->capacity = capacity;
+    header->owner_count = owners;
+    header->free_head = 0;
+    header->incoming = ETIMER_SHM_NONE;
+    header->dead = ETIMER_SHM_NONE;
+    etimer_earliest_init(&header->earliest);
+    etimer_shm_layout(shm, map, size);
+    for (i = 0; i < owners; i++)
+    {
+        shm->owners[i].fired = ETIMER_SHM_NONE;
+    }
+    for (i = 0; i < capacity; i++)
+    {
+        shm->slots[i].next = i + 1 < capacity ? i + 1 : ETIMER_SHM_NONE;
+    }
+    __atomic_store_n(&header->magic, ETIMER_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+int etimer_shm_open(struct etimer_shm *shm, const char *name)
+{
+    const struct etimer_shm_header *header;
+    struct stat st;
+    void *map;
+    int fd = shm_open(name, O_RDWR, 0);
+    int ret;
+
+    memset(shm, 0, sizeof(*shm));
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (fstat(fd, &st) != 0)
+    {
+        ret = -errno;
+        close(fd);
+        return ret;
+    }
+    if ((size_t)st.st_size < sizeof(struct etimer_shm_header))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return -errno;
+    }
+
+    header = map;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != ETIMER_SHM_MAGIC ||
+        header->version != ETIMER_SHM_VERSION || header->capacity == 0 ||
+        header->capacity > ETIMER_SHM_INDEX || header->owner_count == 0 ||
+        header->owner_count > 0xFFFF ||
+        etimer_shm_size(header->capacity, header->owner_count) != (size_t)st.st_size)
+    {
+        munmap(map, st.st_size);
+        return -EINVAL;
+    }
+    etimer_shm_layout(shm, map, st.st_size);
+
+    return 0;
+}
+
+void etimer_shm_close(struct etimer_shm *shm)
+{
+    if (shm->header != NULL)
+    {
+        munmap(shm->header, shm->size);
+    }
+    memset(shm, 0, sizeof(*shm));
+}
+
+int etimer_shm_unlink(const char *name)
+{
+    return shm_unlink(name) != 0 ? -errno : 0;
+}
+
+uint32_t etimer_shm_arm(struct etimer_shm *shm, uint32_t owner, uint32_t deadline,
+                        uint32_t cookie, uint32_t now)
+{
+    struct etimer_shm_header *header = shm->header;
+    struct etimer_shm_slot *slot;
+    uint32_t index, gen;
+
+    if (owner >= header->owner_count)
+    {
+        return ETIMER_SHM_NONE;
+    }
+    index = etimer_shm_pop_free(shm);
+    if (index == ETIMER_SHM_NONE)
+    {
+        // cancelled slots come back through the dispatcher, have it run now
+        etimer_shm_wake(&header->wake_seq);
+        return ETIMER_SHM_NONE;
+    }
+
+    slot = &shm->slots[index];
+    gen = (__atomic_load_n(&slot->state, __ATOMIC_RELAXED) >> 2) + 1;
+    slot->deadline = deadline;
+    slot->owner = owner;
+    slot->cookie = cookie;
+    __atomic_store_n(&slot->state, gen << 2 | ETIMER_SHM_ARMED, __ATOMIC_RELEASE);
+    etimer_shm_push(&header->incoming, &slot->link, index);
+
+    if (etimer_earliest_update(&header->earliest, deadline, now))
+    {
+        etimer_shm_wake(&header->wake_seq);
+    }
+
+    return gen << ETIMER_SHM_INDEX_BITS | index;
+}
+
+int etimer_shm_cancel(struct etimer_shm *shm, uint32_t handle)
+{
+    uint32_t index = handle & ETIMER_SHM_INDEX, state;
+    struct etimer_shm_slot *slot;
+
+    if (index >= shm->header->capacity)
+    {
+        return -EINVAL;
+    }
+    slot = &shm->slots[index];
+    state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+    if ((state & ETIMER_SHM_STATE) != ETIMER_SHM_ARMED ||
+        (state >> 2 << ETIMER_SHM_INDEX_BITS) != (handle & ~ETIMER_SHM_INDEX) ||
+        !__atomic_compare_exchange_n(&slot->state, &state,
+                                     (state & ~ETIMER_SHM_STATE) | ETIMER_SHM_CANCELLED, 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+        return -EINVAL;
+    }
+    etimer_shm_push(&shm->header->dead, &slot->next, index);
+
+    return 0;
+}
+
+size_t etimer_shm_collect(struct etimer_shm *shm, uint32_t owner, uint32_t *cookies, size_t max)
+{
+    struct etimer_shm_owner *own;
+    uint32_t index, next, tail, old;
+    size_t n = 0;
+
+    // the segment is shared, a bad id must not touch another process's slots
+    if (owner >= shm->header->owner_count)
+    {
+        return 0;
+    }
+    own = &shm->owners[owner];
+    index = __atomic_exchange_n(&own->fired, ETIMER_SHM_NONE, __ATOMIC_ACQUIRE);
+
+    while (index != ETIMER_SHM_NONE && n < max)
+    {
+        next = shm->slots[index].next;
+        cookies[n++] = shm->slots[index].cookie;
+        etimer_shm_push_free(shm, index);
+        index = next;
+    }
+
+    // no room left, give the rest back
+    if (index != ETIMER_SHM_NONE)
+    {
+        for (tail = index; shm->slots[tail].next != ETIMER_SHM_NONE; tail = shm->slots[tail].next)
+        {
+        }
+        old = __atomic_load_n(&own->fired, __ATOMIC_RELAXED);
+        do
+        {
+            shm->slots[tail].next = old;
+        } while (!__atomic_compare_exchange_n(&own->fired, &old, index, 1, __ATOMIC_RELEASE,
+                                              __ATOMIC_RELAXED));
+    }
+
+    return n;
+}
+
+int etimer_shm_wait(struct etimer_shm *shm, uint32_t owner, uint32_t timeout)
+{
+    struct etimer_shm_owner *own;
+    uint32_t seq;
+
+    if (owner >= shm->header->owner_count)
+    {
+        return -EINVAL;
+    }
+    own = &shm->owners[owner];
+    seq = __atomic_load_n(&own->seq, __ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(&own->fired, __ATOMIC_ACQUIRE) == ETIMER_SHM_NONE)
+    {
+        etimer_shm_sleep(&own->seq, seq, timeout);
+    }
+
+    return __atomic_load_n(&own->fired, __ATOMIC_ACQUIRE) != ETIMER_SHM_NONE;
+}
+
+int etimer_shm_dispatcher_init(struct etimer_shm_dispatcher *disp, struct etimer_shm *shm)
+{
+    uint32_t capacity = shm->header->capacity, i;
+
+    memset(disp, 0, sizeof(*disp));
+    disp->shm = shm;
+    disp->heap = malloc((size_t)capacity * sizeof(*disp->heap));
+    disp->pos = malloc((size_t)capacity * sizeof(*disp->pos));
+    disp->keys = malloc((size_t)capacity * sizeof(*disp->keys));
+    disp->notify = calloc(shm->header->owner_count, sizeof(*disp->notify));
+    if (disp->heap == NULL || disp->pos == NULL || disp->keys == NULL || disp->notify == NULL)
+    {
+        etimer_shm_dispatcher_deinit(disp);
+        return -ENOMEM;
+    }
+    for (i = 0; i < capacity; i++)
+    {
+        disp->pos[i] = ETIMER_SHM_NONE;
+    }
+
+    return 0;
+}
+
+void etimer_shm_dispatcher_deinit(struct etimer_shm_dispatcher *disp)
+{
+    free(disp->heap);
+    free(disp->pos);
+    free(disp->keys);
+    free(disp->notify);
+    memset(disp, 0, sizeof(*disp));
+}
+
+static inline int etimer_shm_less(const struct etimer_shm_dispatcher *disp, uint32_t a,
+                                  uint32_t b)
+{
+    return etimer_sub(disp->keys[a], disp->keys[b]) < 0;
+}
+
+static inline void etimer_shm_place(struct etimer_shm_dispatcher *disp, uint32_t i,
+                                    uint32_t index)
+{
+    disp->heap[i] = index;
+    disp->pos[index] = i;
+}
+
+static void etimer_shm_up(struct etimer_shm_dispatcher *disp, uint32_t i)
+{
+    uint32_t index = disp->heap[i], parent;
+
+    while (i > 0)
+    {
+        parent = (i - 1) / 2;
+        if (!etimer_shm_less(disp, index, disp->heap[parent]))
+        {
+            break;
+        }
+        etimer_shm_place(disp, i, disp->heap[parent]);
+        i = parent;
+    }
+    etimer_shm_place(disp, i, index);
+}
+
+static void etimer_shm_down(struct etimer_shm_dispatcher *disp, uint32_t i)
+{
+    uint32_t index = disp->heap[i], child;
+
+    for (;;)
+    {
+        child = 2 * i + 1;
+        if (child >= disp->count)
+        {
+            break;
+        }
+        if (child + 1 < disp->count &&
+            etimer_shm_less(disp, disp->heap[child + 1], disp->heap[child]))
+        {
+            child++;
+        }
+        if (!etimer_shm_less(disp, disp->heap[child], index))
+        {
+            break;
+        }
+        etimer_shm_place(disp, i, disp->heap[child]);
+        i = child;
+    }
+    etimer_shm_place(disp, i, index);
+}
+
+static void etimer_shm_remove(struct etimer_shm_dispatcher *disp, uint32_t index)
+{
+    uint32_t i = disp->pos[index], last;
+
+    if (i == ETIMER_SHM_NONE)
+    {
+        return;
+    }
+    disp->pos[index] = ETIMER_SHM_NONE;
+    last = disp->heap[--disp->count];
+    if (i < disp->count)
+    {
+        etimer_shm_place(disp, i, last);
+        etimer_shm_up(disp, i);
+        etimer_shm_down(disp, disp->pos[last]);
+    }
+}
+
+size_t etimer_shm_dispatch(struct etimer_shm_dispatcher *disp, uint32_t now)
+{
+    struct etimer_shm *shm = disp->shm;
+    struct etimer_shm_header *header = shm->header;
+    struct etimer_shm_slot *slot;
+    uint32_t index, next, dead, state, i;
+    size_t fired = 0;
+
+    disp->seq = __atomic_load_n(&header->wake_seq, __ATOMIC_ACQUIRE);
+    etimer_earliest_take(&header->earliest, now, &next);
+
+    // dead first: a cancel is pushed after its arm, so the incoming taken next holds the arm
+    // of every slot in this dead batch
+    dead = __atomic_exchange_n(&header->dead, ETIMER_SHM_NONE, __ATOMIC_ACQUIRE);
+    index = __atomic_exchange_n(&header->incoming, ETIMER_SHM_NONE, __ATOMIC_ACQUIRE);
+    while (index != ETIMER_SHM_NONE)
+    {
+        slot = &shm->slots[index];
+        next = slot->link;
+        disp->keys[index] = slot->deadline;
+        etimer_shm_place(disp, disp->count++, index);
+        etimer_shm_up(disp, disp->count - 1);
+        index = next;
+    }
+    while (dead != ETIMER_SHM_NONE)
+    {
+        next = shm->slots[dead].next;
+        etimer_shm_remove(disp, dead);
+        etimer_shm_push_free(shm, dead);
+        dead = next;
+    }
+
+    while (disp->count && etimer_sub(disp->keys[disp->heap[0]], now) <= 0)
+    {
+        index = disp->heap[0];
+        etimer_shm_remove(disp, index);
+        slot = &shm->slots[index];
+        state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        // a cancelled one is in the dead stack, freed by a later pass
+        if ((state & ETIMER_SHM_STATE) == ETIMER_SHM_ARMED &&
+            __atomic_compare_exchange_n(&slot->state, &state,
+                                        (state & ~ETIMER_SHM_STATE) | ETIMER_SHM_FIRED, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            etimer_shm_push(&shm->owners[slot->owner].fired, &slot->next, index);
+            disp->notify[slot->owner] = 1;
+            fired++;
+        }
+    }
+
+    for (i = 0; fired && i < header->owner_count; i++)
+    {
+        if (disp->notify[i])
+        {
+            disp->notify[i] = 0;
+            etimer_shm_wake(&shm->owners[i].seq);
+        }
+    }
+
+    if (disp->count)
+    {
+        etimer_earliest_update(&header->earliest, disp->keys[disp->heap[0]], now);
+    }
+
+    return fired;
+}
+
+void etimer_shm_dispatcher_sleep(struct etimer_shm_dispatcher *disp, uint32_t now)
+{
+    int32_t rel = ETIMER_EARLIEST_PIN;
+
+    if (disp->count)
+    {
+        rel = etimer_sub(disp->keys[disp->heap[0]], now);
+        if (rel <= 0)
+        {
+            return;
+        }
+    }
+    etimer_shm_sleep(&disp->shm->header->wake_seq, disp->seq, (uint32_t)rel);
+    disp->wakeups++;
+}
+
+#endif /* __linux__ */
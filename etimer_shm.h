@@ -0,0 +1,193 @@
+#ifndef _ETIMER_SHM_H_
+#define _ETIMER_SHM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+#include "etimer_earliest.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Linux timer table in a POSIX shared memory segment, shared by cooperating processes on the
+ * etimer_timerfd clock. Any process arms and cancels timers lock-free, one dispatcher process
+ * sleeps until the earliest deadline for all of them and wakes each owner with expired timers
+ * once per pass through a futex in the segment. Slots are linked by index, never by pointer, so
+ * every process may map the segment anywhere.
+ *
+ * A slot moves between index linked stacks: free (any process pops and pushes, tagged against
+ * ABA), incoming and dead (any process pushes, the dispatcher takes them whole) and the fired
+ * stack of each owner (the dispatcher pushes, the owner takes it whole). The dispatcher orders
+ * the armed timers in a private heap with etimer_sub(), cancelled slots return to the free stack
+ * through it, fired ones through their owner.
+ *
+ * The slot state word holds a generation bumped on every arm, handles carry its low bits so a
+ * handle of a slot since reused is refused.
+ */
+
+#define ETIMER_SHM_MAGIC      0x4D485345 /* "ESHM" */
+#define ETIMER_SHM_VERSION    1
+#define ETIMER_SHM_NONE       (~(uint32_t)0)
+#define ETIMER_SHM_INDEX_BITS 20 /* max capacity 2^20 - 1, the rest of a handle is generation */
+
+struct etimer_shm_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t owner_count;
+    uint64_t free_head __attribute__((aligned(64))); /* tag << 32 | index */
+    uint32_t incoming __attribute__((aligned(64)));
+    uint32_t dead;
+    struct etimer_earliest earliest; /* dispatcher's next wakeup */
+    uint32_t wake_seq __attribute__((aligned(64))); /* futex of the dispatcher */
+};
+
+struct etimer_shm_owner
+{
+    uint32_t fired __attribute__((aligned(64)));
+    uint32_t seq; /* futex of the owner */
+};
+
+struct etimer_shm_slot
+{
+    uint32_t state; /* generation << 2 | free, armed, fired or cancelled */
+    uint32_t deadline;
+    uint32_t owner;
+    uint32_t cookie;
+    uint32_t link;  /* incoming stack */
+    uint32_t next;  /* free, dead or fired stack */
+};
+
+struct etimer_shm
+{
+    struct etimer_shm_header *header;
+    struct etimer_shm_owner *owners;
+    struct etimer_shm_slot *slots;
+    size_t size;
+};
+
+struct etimer_shm_dispatcher
+{
+    struct etimer_shm *shm;
+    uint32_t *heap;     /* slot indexes */
+    uint32_t *pos;      /* per slot: index in heap, or ETIMER_SHM_NONE */
+    uint32_t *keys;     /* per slot: deadline while in heap */
+    uint32_t *notify;   /* per owner: 1 to wake at the end of the pass */
+    uint32_t count;
+    uint32_t seq;       /* wake_seq seen at the start of the pass */
+    uint32_t wakeups;
+};
+
+/**
+ * @brief  Create and map a new segment, it must not exist.
+ * @param[out] shm: Mapping.
+ * @param[in]  name: shm_open() name, "/name".
+ * @param[in]  capacity: Max number of pending timers, below 2^ETIMER_SHM_INDEX_BITS.
+ * @param[in]  owners: Number of owners, ids 0 to owners - 1.
+ * @return 0 on success, -EINVAL for bad sizes, negative errno on failure.
+ */
+int etimer_shm_create(struct etimer_shm *shm, const char *name, uint32_t capacity,
+                      uint32_t owners);
+
+/**
+ * @brief  Map an existing segment.
+ * @param[out] shm: Mapping.
+ * @param[in]  name: shm_open() name.
+ * @return 0 on success, -EINVAL if not a timer table or its sizes are out of the bounds of
+ * etimer_shm_create(), negative errno on failure.
+ */
+int etimer_shm_open(struct etimer_shm *shm, const char *name);
+
+/**
+ * @brief  Unmap the segment, it lives on until etimer_shm_unlink().
+ * @param[in]  shm: Mapping.
+ */
+void etimer_shm_close(struct etimer_shm *shm);
+
+/**
+ * @brief  Remove the segment name.
+ * @param[in]  name: shm_open() name.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_shm_unlink(const char *name);
+
+/**
+ * @brief  Start a timer, from any process. Wakes the dispatcher if it is the new earliest.
+ * @param[in]  shm: Mapping.
+ * @param[in]  owner: Owner notified on expiry.
+ * @param[in]  deadline: Absolute deadline, less than ETIMER_MAX_VALUE_OVERFLOW ahead.
+ * @param[in]  cookie: Returned by etimer_shm_collect().
+ * @param[in]  now: Current absolute time.
+ * @return handle, ETIMER_SHM_NONE if owner is out of range or the table is full. Cancelled
+ * slots are free again after the next dispatcher pass, which a full table triggers.
+ */
+uint32_t etimer_shm_arm(struct etimer_shm *shm, uint32_t owner, uint32_t deadline,
+                        uint32_t cookie, uint32_t now);
+
+/**
+ * @brief  Stop a pending timer, from any process.
+ * @param[in]  shm: Mapping.
+ * @param[in]  handle: Handle returned by etimer_shm_arm().
+ * @return 0 on success, -EINVAL if it has fired, was cancelled or the slot was reused.
+ */
+int etimer_shm_cancel(struct etimer_shm *shm, uint32_t handle);
+
+/**
+ * @brief  Take the expired timers of an owner, their slots are freed.
+ * @param[in]  shm: Mapping.
+ * @param[in]  owner: Owner.
+ * @param[out] cookies: Cookies of the expired timers.
+ * @param[in]  max: Size of cookies, the rest stays for the next call.
+ * @return number of cookies written, 0 if owner is out of range.
+ */
+size_t etimer_shm_collect(struct etimer_shm *shm, uint32_t owner, uint32_t *cookies, size_t max);
+
+/**
+ * @brief  Sleep until the dispatcher reports expired timers of the owner.
+ * @param[in]  shm: Mapping.
+ * @param[in]  owner: Owner.
+ * @param[in]  timeout: Max sleep in us.
+ * @return resulting 1 means expired timers are waiting, -EINVAL if owner is out of range.
+ */
+int etimer_shm_wait(struct etimer_shm *shm, uint32_t owner, uint32_t timeout);
+
+/**
+ * @brief  Set up the dispatcher, one process per segment.
+ * @param[out] disp: Dispatcher.
+ * @param[in]  shm: Mapping.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+int etimer_shm_dispatcher_init(struct etimer_shm_dispatcher *disp, struct etimer_shm *shm);
+
+/**
+ * @brief  Free the dispatcher.
+ * @param[in]  disp: Dispatcher.
+ */
+void etimer_shm_dispatcher_deinit(struct etimer_shm_dispatcher *disp);
+
+/**
+ * @brief  Take the armed and cancelled timers, fire the due ones and wake their owners, each
+ * owner once, then publish the next deadline.
+ * @param[in]  disp: Dispatcher.
+ * @param[in]  now: Current absolute time.
+ * @return number of timers fired.
+ */
+size_t etimer_shm_dispatch(struct etimer_shm_dispatcher *disp, uint32_t now);
+
+/**
+ * @brief  Sleep until the next deadline, or until a process arms an earlier one since the last
+ * etimer_shm_dispatch().
+ * @param[in]  disp: Dispatcher.
+ * @param[in]  now: Current absolute time.
+ */
+void etimer_shm_dispatcher_sleep(struct etimer_shm_dispatcher *disp, uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_SHM_H_ */
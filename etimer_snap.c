@@ -0,0 +1,237 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_snap.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ETIMER_SNAP_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define ETIMER_SNAP_USE_MMAP 0
+#endif
+
+// Records converted per fwrite().
+#define ETIMER_SNAP_BLOCK 1024
+
+static int etimer_snap_write(FILE *fp, const uint32_t *deadlines, const uint32_t *ids, size_t n,
+                             uint32_t now, uint32_t max_value, uint64_t wall)
+{
+    struct etimer_snap_record block[ETIMER_SNAP_BLOCK];
+    struct etimer_snap_header header;
+    size_t i, j, len;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = ETIMER_SNAP_MAGIC;
+    header.version = ETIMER_SNAP_VERSION;
+    header.max_value = max_value;
+    header.overflow = max_value >> 1;
+    header.record_size = sizeof(struct etimer_snap_record);
+    header.time = now;
+    header.count = n;
+    header.wall = wall;
+    if (fwrite(&header, sizeof(header), 1, fp) != 1)
+    {
+        return -EIO;
+    }
+
+    for (i = 0; i < n; i += len)
+    {
+        len = n - i < ETIMER_SNAP_BLOCK ? n - i : ETIMER_SNAP_BLOCK;
+        for (j = 0; j < len; j++)
+        {
+            block[j].delta = etimer_sub_raw(deadlines[i + j], now, header.overflow, max_value);
+            block[j].id = ids != NULL ? ids[i + j] : (uint32_t)(i + j);
+        }
+        if (fwrite(block, sizeof(block[0]), len, fp) != len)
+        {
+            return -EIO;
+        }
+    }
+
+    return 0;
+}
+
+int etimer_snap_save(const char *path, const uint32_t *deadlines, const uint32_t *ids, size_t n,
+                     uint32_t now, uint32_t max_value, uint64_t wall)
+{
+    size_t len = strlen(path);
+    char *tmp = malloc(len + sizeof(".tmp"));
+    FILE *fp;
+    int ret;
+
+    if (tmp == NULL)
+    {
+        return -ENOMEM;
+    }
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, ".tmp", sizeof(".tmp"));
+
+    fp = fopen(tmp, "wb");
+    if (fp == NULL)
+    {
+        ret = -errno;
+        free(tmp);
+        return ret;
+    }
+
+    ret = etimer_snap_write(fp, deadlines, ids, n, now, max_value, wall);
+    if (fclose(fp) != 0 && ret == 0)
+    {
+        ret = -EIO;
+    }
+    if (ret == 0 && rename(tmp, path) != 0)
+    {
+        ret = -errno;
+    }
+    if (ret != 0)
+    {
+        remove(tmp);
+    }
+    free(tmp);
+
+    return ret;
+}
+
+static int etimer_snap_map(struct etimer_snap_reader *reader, const char *path)
+{
+#if ETIMER_SNAP_USE_MMAP
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        int ret = -errno;
+        close(fd);
+        return ret;
+    }
+
+    if ((size_t)st.st_size < sizeof(struct etimer_snap_header))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+
+    reader->map_size = st.st_size;
+    reader->map = mmap(NULL, reader->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->map == MAP_FAILED)
+    {
+        reader->map = NULL;
+        return -errno;
+    }
+
+    return 0;
+#else
+    // No mmap on this platform, fall back to loading the file.
+    long size;
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return -errno;
+    }
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0 ||
+        (size_t)size < sizeof(struct etimer_snap_header))
+    {
+        fclose(fp);
+        return -EINVAL;
+    }
+
+    reader->map_size = size;
+    reader->map = malloc(reader->map_size);
+    if (reader->map == NULL)
+    {
+        fclose(fp);
+        return -ENOMEM;
+    }
+
+    if (fread(reader->map, 1, reader->map_size, fp) != reader->map_size)
+    {
+        fclose(fp);
+        free(reader->map);
+        reader->map = NULL;
+        return -EIO;
+    }
+    fclose(fp);
+
+    return 0;
+#endif
+}
+
+int etimer_snap_open(struct etimer_snap_reader *reader, const char *path)
+{
+    const struct etimer_snap_header *header;
+    int ret;
+
+    memset(reader, 0, sizeof(*reader));
+
+    ret = etimer_snap_map(reader, path);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    // count is checked against the size before the product, which would overflow for a corrupt one
+    header = reader->map;
+    if (header->magic != ETIMER_SNAP_MAGIC || header->version != ETIMER_SNAP_VERSION ||
+        header->record_size != sizeof(struct etimer_snap_record) || header->max_value == 0 ||
+        (header->max_value & (header->max_value + 1)) != 0 ||
+        header->overflow != header->max_value >> 1 ||
+        header->count > (reader->map_size - sizeof(*header)) / sizeof(struct etimer_snap_record) ||
+        reader->map_size - sizeof(*header) != header->count * sizeof(struct etimer_snap_record))
+    {
+        etimer_snap_close(reader);
+        return -EINVAL;
+    }
+
+    reader->header = header;
+    reader->records = (const struct etimer_snap_record *)(header + 1);
+
+    return 0;
+}
+
+void etimer_snap_close(struct etimer_snap_reader *reader)
+{
+    if (reader->map != NULL)
+    {
+#if ETIMER_SNAP_USE_MMAP
+        munmap(reader->map, reader->map_size);
+#else
+        free(reader->map);
+#endif
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+size_t etimer_snap_restore(const struct etimer_snap_record *records, size_t n, uint32_t now,
+                           uint64_t elapsed, uint32_t max_value, uint32_t *deadlines)
+{
+    int64_t late = (int64_t)(max_value >> 2), down, rel;
+    size_t due = 0, i;
+    uint32_t ticks;
+
+    // past twice the range every timer is due, and the clamp below needs no more
+    down = elapsed > 0x1FFFFFFFFull ? 0x1FFFFFFFFll : (int64_t)elapsed;
+    for (i = 0; i < n; i++)
+    {
+        rel = (int64_t)records[i].delta - down;
+        due += rel <= 0;
+        rel = rel < -late ? -late : rel;
+        // a negative distance goes forward by one domain, etimer_add_raw() wraps at most once
+        ticks = (uint32_t)rel + (rel < 0 ? max_value + 1 : 0);
+        deadlines[i] = etimer_add_raw(now, (int32_t)ticks, max_value);
+    }
+
+    return due;
+}
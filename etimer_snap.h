@@ -0,0 +1,96 @@
+#ifndef _ETIMER_SNAP_H_
+#define _ETIMER_SNAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define ETIMER_SNAP_MAGIC   0x50414E53 /* "SNAP" */
+#define ETIMER_SNAP_VERSION 1
+
+/**
+ * Snapshot of pending timers for a warm restart. Each deadline is kept as its etimer_sub_raw()
+ * distance from the snapshot time, so the file does not depend on where the clock was in its
+ * wrap. File layout, host byte order, used in place once mapped:
+ *   header | record 0 | record 1 | ... | record count-1
+ */
+struct etimer_snap_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t max_value;
+    uint32_t overflow;
+    uint32_t record_size;
+    uint32_t time;  /* clock at the snapshot */
+    uint64_t count;
+    uint64_t wall;  /* caller's clock at the snapshot, to measure the downtime */
+};
+
+struct etimer_snap_record
+{
+    int32_t delta; /* deadline - time, negative if already due */
+    uint32_t id;   /* caller's key of the timer */
+};
+
+struct etimer_snap_reader
+{
+    const struct etimer_snap_header *header;
+    const struct etimer_snap_record *records;
+    void *map;
+    size_t map_size;
+};
+
+/**
+ * @brief  Write the pending timers to a snapshot file. The file is written next to path and
+ * renamed over it, a crash leaves the previous snapshot in place.
+ * @param[in]  path: File path.
+ * @param[in]  deadlines: Absolute deadlines, within overflow of now.
+ * @param[in]  ids: Key of each timer, NULL to store the indexes.
+ * @param[in]  n: Number of timers.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  max_value: Max time value, ETIMER_MAX_VALUE for the 32bit domain.
+ * @param[in]  wall: Caller's clock, e.g. CLOCK_REALTIME, stored as is.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_snap_save(const char *path, const uint32_t *deadlines, const uint32_t *ids, size_t n,
+                     uint32_t now, uint32_t max_value, uint64_t wall);
+
+/**
+ * @brief  Map a snapshot file read only. Records are used in place.
+ * @param[out] reader: Reader state.
+ * @param[in]  path: File path.
+ * @return 0 on success, negative errno on failure, -EINVAL on a malformed file.
+ */
+int etimer_snap_open(struct etimer_snap_reader *reader, const char *path);
+
+/**
+ * @brief  Unmap a snapshot file.
+ * @param[in]  reader: Reader state.
+ */
+void etimer_snap_close(struct etimer_snap_reader *reader);
+
+/**
+ * @brief  Rebase snapshot records onto the current clock in one pass:
+ * deadline = etimer_add_raw(now, delta - elapsed). Timers that came due during the downtime
+ * keep their lateness up to overflow / 2 before now, so they still compare as passed.
+ * @param[in]  records: Snapshot records.
+ * @param[in]  n: Number of records.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  elapsed: Ticks between the snapshot and now.
+ * @param[in]  max_value: Max time value of the snapshot.
+ * @param[out] deadlines: Absolute deadline of each record.
+ * @return number of timers already due at now.
+ */
+size_t etimer_snap_restore(const struct etimer_snap_record *records, size_t n, uint32_t now,
+                           uint64_t elapsed, uint32_t max_value, uint32_t *deadlines);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_SNAP_H_ */
@@ -0,0 +1,525 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_sorted.h"
+
+// Batches up to this size are insertion sorted, larger ones radix sorted.
+#define ETIMER_SORTED_SMALL 8
+
+// Widest radix digit, in bits.
+#define ETIMER_SORTED_DIGIT 11
+
+// A batch whose merge would move more than this many pending timers per timer armed goes to the
+// stage heap, merged once it holds more than this fraction of the array. Stale slots are swept
+// once they make up this fraction of the slots stored.
+#define ETIMER_SORTED_RATIO 8
+
+/**
+ * @brief  Deadline relative to now, biased so that unsigned order is deadline order.
+ */
+static inline uint32_t etimer_sorted_key(const struct etimer_sorted *sorted, uint32_t deadline,
+                                         uint32_t now)
+{
+    if (sorted->max_value == ETIMER_MAX_VALUE)
+    {
+        return (uint32_t)etimer_sub(deadline, now) ^ 0x80000000u;
+    }
+    return (uint32_t)etimer_sub_raw(deadline, now, sorted->overflow, sorted->max_value) ^
+           0x80000000u;
+}
+
+/**
+ * @brief  resulting 1 means deadline a is before deadline b.
+ */
+static inline int etimer_sorted_before(const struct etimer_sorted *sorted, uint32_t a, uint32_t b)
+{
+    return etimer_sub_raw(a, b, sorted->overflow, sorted->max_value) < 0;
+}
+
+/**
+ * @brief  resulting 1 means the slot was not cancelled, re-armed or expired since stored.
+ */
+static inline int etimer_sorted_live(const struct etimer_sorted *sorted,
+                                     const struct etimer_sorted_slot *slot)
+{
+    return sorted->gen[slot->handle] == slot->gen;
+}
+
+int etimer_sorted_init(struct etimer_sorted *sorted, uint32_t capacity, uint32_t max_value)
+{
+    memset(sorted, 0, sizeof(*sorted));
+    sorted->capacity = capacity;
+    sorted->max_value = max_value;
+    sorted->overflow = max_value >> 1;
+    sorted->slots = malloc((size_t)capacity * sizeof(*sorted->slots));
+    sorted->stage = malloc((size_t)capacity * sizeof(*sorted->stage));
+    sorted->gen = calloc(capacity, sizeof(*sorted->gen));
+    sorted->keys = malloc((size_t)capacity * sizeof(*sorted->keys));
+    sorted->keys_tmp = malloc((size_t)capacity * sizeof(*sorted->keys_tmp));
+    if (sorted->slots == NULL || sorted->stage == NULL || sorted->gen == NULL ||
+        sorted->keys == NULL || sorted->keys_tmp == NULL)
+    {
+        etimer_sorted_deinit(sorted);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+void etimer_sorted_deinit(struct etimer_sorted *sorted)
+{
+    free(sorted->slots);
+    free(sorted->stage);
+    free(sorted->gen);
+    free(sorted->keys);
+    free(sorted->keys_tmp);
+    memset(sorted, 0, sizeof(*sorted));
+}
+
+static void etimer_sorted_stage_up(struct etimer_sorted *sorted, uint32_t index,
+                                   struct etimer_sorted_slot slot)
+{
+    while (index > 0 &&
+           etimer_sorted_before(sorted, slot.deadline, sorted->stage[(index - 1) / 2].deadline))
+    {
+        sorted->stage[index] = sorted->stage[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    sorted->stage[index] = slot;
+}
+
+static void etimer_sorted_stage_down(struct etimer_sorted *sorted, uint32_t index,
+                                     struct etimer_sorted_slot slot)
+{
+    uint32_t child;
+
+    while ((child = index * 2 + 1) < sorted->stage_size)
+    {
+        if (child + 1 < sorted->stage_size &&
+            etimer_sorted_before(sorted, sorted->stage[child + 1].deadline,
+                                 sorted->stage[child].deadline))
+        {
+            child++;
+        }
+        if (!etimer_sorted_before(sorted, sorted->stage[child].deadline, slot.deadline))
+        {
+            break;
+        }
+        sorted->stage[index] = sorted->stage[child];
+        index = child;
+    }
+    sorted->stage[index] = slot;
+}
+
+static void etimer_sorted_stage_pop(struct etimer_sorted *sorted)
+{
+    if (--sorted->stage_size)
+    {
+        etimer_sorted_stage_down(sorted, 0, sorted->stage[sorted->stage_size]);
+    }
+}
+
+/**
+ * @brief  Drop stale slots from the array.
+ */
+static void etimer_sorted_sweep(struct etimer_sorted *sorted)
+{
+    uint32_t end = sorted->head + sorted->size;
+    uint32_t out = 0;
+    uint32_t i;
+
+    for (i = sorted->head; i < end; i++)
+    {
+        if (etimer_sorted_live(sorted, &sorted->slots[i]))
+        {
+            sorted->slots[out++] = sorted->slots[i];
+        }
+    }
+    sorted->dead -= sorted->size - out;
+    sorted->head = 0;
+    sorted->size = out;
+}
+
+/**
+ * @brief  Drop stale slots from the stage and rebuild the heap.
+ */
+static void etimer_sorted_stage_sweep(struct etimer_sorted *sorted)
+{
+    uint32_t out = 0;
+    uint32_t i;
+
+    for (i = 0; i < sorted->stage_size; i++)
+    {
+        if (etimer_sorted_live(sorted, &sorted->stage[i]))
+        {
+            sorted->stage[out++] = sorted->stage[i];
+        }
+    }
+    sorted->dead -= sorted->stage_size - out;
+    sorted->stage_size = out;
+
+    for (i = out / 2; i-- > 0;)
+    {
+        etimer_sorted_stage_down(sorted, i, sorted->stage[i]);
+    }
+}
+
+/**
+ * @brief  Sweep once stale slots pile up, and keep a live timer at the front of the array and
+ * the top of the stage.
+ */
+static void etimer_sorted_tidy(struct etimer_sorted *sorted)
+{
+    if ((uint64_t)sorted->dead * ETIMER_SORTED_RATIO > sorted->size + sorted->stage_size)
+    {
+        etimer_sorted_sweep(sorted);
+        etimer_sorted_stage_sweep(sorted);
+    }
+
+    while (sorted->size && !etimer_sorted_live(sorted, &sorted->slots[sorted->head]))
+    {
+        sorted->head++;
+        sorted->size--;
+        sorted->dead--;
+    }
+    if (sorted->size == 0)
+    {
+        sorted->head = 0;
+    }
+
+    while (sorted->stage_size && !etimer_sorted_live(sorted, &sorted->stage[0]))
+    {
+        etimer_sorted_stage_pop(sorted);
+        sorted->dead--;
+    }
+}
+
+/**
+ * @brief  Stable sort by key. Tiny batches are insertion sorted, others LSD radix sorted on the
+ * key minus the smallest key, with digits about twice the batch size and at most 11 bits, so a
+ * burst spanning a few ticks per timer takes a single pass wherever it sits relative to the wrap.
+ */
+static struct etimer_sorted_key *etimer_sorted_sort(struct etimer_sorted_key *keys,
+                                                    struct etimer_sorted_key *tmp, size_t n,
+                                                    uint32_t min, uint32_t max)
+{
+    uint32_t count[1u << ETIMER_SORTED_DIGIT];
+    uint32_t range = max - min;
+    uint32_t mask, bits = 4;
+    size_t i, j;
+    int shift;
+
+    if (n <= ETIMER_SORTED_SMALL)
+    {
+        for (i = 1; i < n; i++)
+        {
+            struct etimer_sorted_key k = keys[i];
+            for (j = i; j > 0 && keys[j - 1].key > k.key; j--)
+            {
+                keys[j] = keys[j - 1];
+            }
+            keys[j] = k;
+        }
+        return keys;
+    }
+
+    while (bits < ETIMER_SORTED_DIGIT && ((size_t)1 << bits) < n * 2)
+    {
+        bits++;
+    }
+    mask = (1u << bits) - 1;
+
+    for (shift = 0; shift < 32 && (range >> shift) != 0; shift += (int)bits)
+    {
+        struct etimer_sorted_key *swap;
+        uint32_t sum = 0;
+
+        memset(count, 0, (mask + 1) * sizeof(*count));
+        for (i = 0; i < n; i++)
+        {
+            count[((keys[i].key - min) >> shift) & mask]++;
+        }
+        for (i = 0; i <= mask; i++)
+        {
+            uint32_t t = count[i];
+            count[i] = sum;
+            sum += t;
+        }
+        for (i = 0; i < n; i++)
+        {
+            tmp[count[((keys[i].key - min) >> shift) & mask]++] = keys[i];
+        }
+
+        swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+
+    return keys;
+}
+
+/**
+ * @brief  First index in [lo, hi) whose key is above key, searched from hi since bursts mostly
+ * land after the pending timers.
+ */
+static uint32_t etimer_sorted_gallop(const struct etimer_sorted *sorted, uint32_t lo, uint32_t hi,
+                                     uint32_t key, uint32_t now)
+{
+    uint32_t bound, step, mid;
+
+    if (hi == lo || etimer_sorted_key(sorted, sorted->slots[hi - 1].deadline, now) <= key)
+    {
+        return hi;
+    }
+
+    // slots[bound] is above key, double the step back until one is not
+    bound = hi - 1;
+    step = 1;
+    while (bound - lo >= step &&
+           etimer_sorted_key(sorted, sorted->slots[bound - step].deadline, now) > key)
+    {
+        bound -= step;
+        step *= 2;
+    }
+    lo = bound - lo >= step ? bound - step + 1 : lo;
+    hi = bound;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (etimer_sorted_key(sorted, sorted->slots[mid].deadline, now) > key)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief  Sort the first n keys and merge them into the array.
+ */
+static void etimer_sorted_merge(struct etimer_sorted *sorted, uint32_t now, size_t n,
+                                uint32_t min, uint32_t max)
+{
+    struct etimer_sorted_key *keys =
+            etimer_sorted_sort(sorted->keys, sorted->keys_tmp, n, min, max);
+    uint32_t i, k, lo;
+    size_t j;
+
+    // make room after the pending slots
+    if (sorted->head + sorted->size + n > sorted->capacity)
+    {
+        if (sorted->size + n > sorted->capacity)
+        {
+            etimer_sorted_sweep(sorted);
+        }
+        memmove(sorted->slots, sorted->slots + sorted->head,
+                sorted->size * sizeof(*sorted->slots));
+        sorted->head = 0;
+    }
+
+    // backward merge, pending blocks above the next batch timer move as a whole, nothing moves
+    // when the batch lands after all of them
+    i = sorted->head + sorted->size;
+    k = i + (uint32_t)n;
+    j = n;
+    if (etimer_sorted_gallop(sorted, sorted->head, i, keys[0].key, now) == i)
+    {
+        for (j = 0; j < n; j++)
+        {
+            sorted->slots[i + j] = keys[j].slot;
+        }
+        j = 0;
+    }
+    while (j > 0)
+    {
+        lo = etimer_sorted_gallop(sorted, sorted->head, i, keys[j - 1].key, now);
+        if (i > lo)
+        {
+            k -= i - lo;
+            memmove(sorted->slots + k, sorted->slots + lo, (i - lo) * sizeof(*sorted->slots));
+            i = lo;
+        }
+        sorted->slots[--k] = keys[--j].slot;
+    }
+    sorted->size += (uint32_t)n;
+}
+
+/**
+ * @brief  Merge the live part of the stage into the array.
+ */
+static void etimer_sorted_flush(struct etimer_sorted *sorted, uint32_t now)
+{
+    uint32_t min = ~(uint32_t)0, max = 0;
+    uint32_t i, key;
+    size_t n = 0;
+
+    for (i = 0; i < sorted->stage_size; i++)
+    {
+        if (etimer_sorted_live(sorted, &sorted->stage[i]))
+        {
+            key = etimer_sorted_key(sorted, sorted->stage[i].deadline, now);
+            min = key < min ? key : min;
+            max = key > max ? key : max;
+            sorted->keys[n].key = key;
+            sorted->keys[n++].slot = sorted->stage[i];
+        }
+    }
+    sorted->dead -= sorted->stage_size - (uint32_t)n;
+    sorted->stage_size = 0;
+    if (n == 0)
+    {
+        return;
+    }
+
+    etimer_sorted_merge(sorted, now, n, min, max);
+}
+
+int etimer_sorted_arm(struct etimer_sorted *sorted, uint32_t now,
+                      const struct etimer_sorted_entry *batch, size_t n)
+{
+    struct etimer_sorted_key *keys = sorted->keys;
+    uint32_t min = ~(uint32_t)0, max = 0;
+    uint32_t *gen;
+    uint32_t end;
+    size_t j;
+
+    if (n == 0)
+    {
+        return 0;
+    }
+    // keys[] holds one batch, handles are unique so a larger one is bad input
+    if (n > sorted->capacity)
+    {
+        return -EINVAL;
+    }
+    for (j = 0; j < n; j++)
+    {
+        if (batch[j].handle >= sorted->capacity)
+        {
+            return -EINVAL;
+        }
+    }
+
+    // a new generation leaves the copy of a re-armed timer stale
+    for (j = 0; j < n; j++)
+    {
+        gen = &sorted->gen[batch[j].handle];
+        sorted->dead += *gen & 1;
+        *gen += (*gen & 1) + 1;
+
+        keys[j].key = etimer_sorted_key(sorted, batch[j].deadline, now);
+        keys[j].slot.deadline = batch[j].deadline;
+        keys[j].slot.handle = batch[j].handle;
+        keys[j].slot.gen = *gen;
+        min = keys[j].key < min ? keys[j].key : min;
+        max = keys[j].key > max ? keys[j].key : max;
+    }
+    etimer_sorted_tidy(sorted);
+
+    // a batch landing deep inside the array would move most of it, stage it instead
+    end = sorted->head + sorted->size;
+    if (end - etimer_sorted_gallop(sorted, sorted->head, end, min, now) <=
+        ETIMER_SORTED_RATIO * n)
+    {
+        etimer_sorted_merge(sorted, now, n, min, max);
+        return 0;
+    }
+
+    if (sorted->stage_size + n > sorted->capacity)
+    {
+        etimer_sorted_stage_sweep(sorted);
+    }
+    for (j = 0; j < n; j++)
+    {
+        etimer_sorted_stage_up(sorted, sorted->stage_size++, keys[j].slot);
+    }
+    if ((uint64_t)sorted->stage_size * ETIMER_SORTED_RATIO > sorted->size)
+    {
+        etimer_sorted_flush(sorted, now);
+    }
+
+    return 0;
+}
+
+size_t etimer_sorted_cancel(struct etimer_sorted *sorted, const uint32_t *handles, size_t n)
+{
+    size_t cancelled = 0;
+    uint32_t pending;
+    size_t j;
+
+    for (j = 0; j < n; j++)
+    {
+        if (handles[j] < sorted->capacity)
+        {
+            pending = sorted->gen[handles[j]] & 1;
+            sorted->gen[handles[j]] += pending;
+            cancelled += pending;
+        }
+    }
+    sorted->dead += (uint32_t)cancelled;
+    etimer_sorted_tidy(sorted);
+
+    return cancelled;
+}
+
+/**
+ * @brief  resulting 1 means the earliest timer is in the stage heap.
+ */
+static inline int etimer_sorted_staged_first(const struct etimer_sorted *sorted)
+{
+    return sorted->stage_size &&
+           (sorted->size == 0 || etimer_sorted_before(sorted, sorted->stage[0].deadline,
+                                                      sorted->slots[sorted->head].deadline));
+}
+
+size_t etimer_sorted_expire(struct etimer_sorted *sorted, uint32_t now, uint32_t *handles,
+                            size_t max)
+{
+    struct etimer_sorted_slot slot;
+    size_t n = 0;
+    int staged;
+
+    while (n < max && (sorted->size || sorted->stage_size))
+    {
+        staged = etimer_sorted_staged_first(sorted);
+        slot = staged ? sorted->stage[0] : sorted->slots[sorted->head];
+        if (etimer_sub_raw(slot.deadline, now, sorted->overflow, sorted->max_value) > 0)
+        {
+            break;
+        }
+
+        sorted->gen[slot.handle]++;
+        handles[n++] = slot.handle;
+        if (staged)
+        {
+            etimer_sorted_stage_pop(sorted);
+        }
+        else
+        {
+            sorted->head++;
+            sorted->size--;
+        }
+        etimer_sorted_tidy(sorted);
+    }
+
+    return n;
+}
+
+int etimer_sorted_next(const struct etimer_sorted *sorted, uint32_t *deadline)
+{
+    if (sorted->size == 0 && sorted->stage_size == 0)
+    {
+        return 0;
+    }
+
+    *deadline = etimer_sorted_staged_first(sorted) ? sorted->stage[0].deadline
+                                                   : sorted->slots[sorted->head].deadline;
+    return 1;
+}
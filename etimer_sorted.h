@@ -0,0 +1,133 @@
+#ifndef _ETIMER_SORTED_H_
+#define _ETIMER_SORTED_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Pending timers kept as one array sorted by wrapped deadline, for hosts arming and cancelling
+ * timers in bursts. A batch is sorted once by its deadline relative to now, a radix sort so the
+ * wrap costs nothing, then merged backwards into the array in a single pass that moves pending
+ * timers in blocks. Bursts usually expire after the timers already pending, so the merge stops
+ * early and only the tail moves. A small batch landing deep inside the array goes to a stage heap
+ * instead, merged as one batch once it holds an eighth of the array.
+ *
+ * Cancelling only bumps the generation of the handle, the stored copy goes stale and is skipped
+ * at expiry or dropped by a sweep once stale copies make up an eighth of the timers stored.
+ *
+ * Pending deadlines are expected within the overflow of the domain from now. Any etimer domain
+ * works: ETIMER_MAX_VALUE, 0xFFFF for etimer16 times, or a narrower _raw counter whose
+ * max_value + 1 is a power of 2.
+ */
+
+struct etimer_sorted_entry
+{
+    uint32_t deadline;
+    uint32_t handle; /* below capacity, chosen by the caller */
+};
+
+struct etimer_sorted_slot
+{
+    uint32_t deadline;
+    uint32_t handle;
+    uint32_t gen; /* generation of the handle when armed */
+};
+
+struct etimer_sorted_key
+{
+    uint32_t key;
+    struct etimer_sorted_slot slot;
+};
+
+struct etimer_sorted
+{
+    struct etimer_sorted_slot *slots;
+    uint32_t head;
+    uint32_t size; /* slots from head, stale ones included */
+    uint32_t capacity;
+    struct etimer_sorted_slot *stage; /* heap of timers not merged yet */
+    uint32_t stage_size;
+    uint32_t *gen; /* per handle, odd while pending */
+    uint32_t dead; /* stale slots in the array and the stage */
+    struct etimer_sorted_key *keys;
+    struct etimer_sorted_key *keys_tmp;
+    uint32_t max_value;
+    uint32_t overflow;
+};
+
+/**
+ * @brief  Allocate room for capacity timers, with handles 0 to capacity - 1.
+ * @param[out] sorted: Pending set.
+ * @param[in]  capacity: Max number of timers.
+ * @param[in]  max_value: Max time value of the domain.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+int etimer_sorted_init(struct etimer_sorted *sorted, uint32_t capacity, uint32_t max_value);
+
+/**
+ * @brief  Free the pending set.
+ * @param[in]  sorted: Pending set.
+ */
+void etimer_sorted_deinit(struct etimer_sorted *sorted);
+
+/**
+ * @brief  Arm a batch of timers. A handle already pending is re-armed, a handle must appear once
+ * in a batch. Timers with equal deadlines expire in any order.
+ * @param[in]  sorted: Pending set.
+ * @param[in]  now: Current absolute time.
+ * @param[in]  batch: Timers to arm.
+ * @param[in]  n: Number of timers.
+ * @return 0 on success, -EINVAL for a handle beyond capacity or more than capacity timers.
+ */
+int etimer_sorted_arm(struct etimer_sorted *sorted, uint32_t now,
+                      const struct etimer_sorted_entry *batch, size_t n);
+
+/**
+ * @brief  Cancel a batch of timers.
+ * @param[in]  sorted: Pending set.
+ * @param[in]  handles: Timers to cancel, those not pending are skipped.
+ * @param[in]  n: Number of handles.
+ * @return number of timers cancelled.
+ */
+size_t etimer_sorted_cancel(struct etimer_sorted *sorted, const uint32_t *handles, size_t n);
+
+/**
+ * @brief  Take timers whose deadline is not after now, in deadline order.
+ * @param[in]  sorted: Pending set.
+ * @param[in]  now: Current absolute time.
+ * @param[out] handles: Expired timers.
+ * @param[in]  max: Size of handles.
+ * @return number of timers taken.
+ */
+size_t etimer_sorted_expire(struct etimer_sorted *sorted, uint32_t now, uint32_t *handles,
+                            size_t max);
+
+/**
+ * @brief  Earliest pending deadline.
+ * @param[in]  sorted: Pending set.
+ * @param[out] deadline: Earliest deadline.
+ * @return resulting 1 means a timer is pending.
+ */
+int etimer_sorted_next(const struct etimer_sorted *sorted, uint32_t *deadline);
+
+/**
+ * @brief  Number of pending timers.
+ * @param[in]  sorted: Pending set.
+ * @return pending timers.
+ */
+static inline uint32_t etimer_sorted_count(const struct etimer_sorted *sorted)
+{
+    return sorted->size + sorted->stage_size - sorted->dead;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_SORTED_H_ */
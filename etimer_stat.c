@@ -0,0 +1,94 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_stat.h"
+
+__thread struct etimer_stat_thread *etimer_stat_tls;
+uint32_t etimer_stat_near_permille = 900;
+
+static void *etimer_stat_sites[ETIMER_STAT_MAX_SITES];
+static struct etimer_registry etimer_stat_registry =
+        ETIMER_REGISTRY_INIT(etimer_stat_sites, sizeof(struct etimer_stat_thread));
+
+uint32_t etimer_stat_register(struct etimer_stat_site *site)
+{
+    return etimer_registry_add(&etimer_stat_registry, &site->id, site);
+}
+
+struct etimer_stat_thread *etimer_stat_thread_init(void)
+{
+    struct etimer_stat_thread *thread = etimer_registry_table_new(&etimer_stat_registry);
+
+    etimer_stat_tls = thread;
+    return thread;
+}
+
+void etimer_stat_set_near(uint32_t permille)
+{
+    etimer_stat_near_permille = permille;
+}
+
+size_t etimer_stat_snapshot(struct etimer_stat_report *reports, size_t max)
+{
+    uint32_t count = etimer_registry_count(&etimer_stat_registry);
+    struct etimer_stat_thread *thread;
+    uint32_t id, i;
+
+    for (id = 1; id < count && id - 1 < max; id++)
+    {
+        struct etimer_stat_report *report = &reports[id - 1];
+
+        memset(report, 0, sizeof(*report));
+        report->site = etimer_stat_sites[id];
+        for (thread = etimer_registry_tables(&etimer_stat_registry); thread != NULL;
+             thread = (struct etimer_stat_thread *)thread->link.next)
+        {
+            const struct etimer_stat_counter *counter = &thread->sites[id];
+            report->counter.calls += counter->calls;
+            report->counter.wraps += counter->wraps;
+            report->counter.near += counter->near;
+            for (i = 0; i < ETIMER_STAT_BUCKETS; i++)
+            {
+                report->counter.hist[i] += counter->hist[i];
+            }
+        }
+    }
+
+    return count - 1;
+}
+
+void etimer_stat_dump(FILE *fp)
+{
+    struct etimer_stat_report *reports = malloc(ETIMER_STAT_MAX_SITES * sizeof(*reports));
+    size_t count, n, i;
+
+    if (reports == NULL)
+    {
+        return;
+    }
+
+    count = etimer_stat_snapshot(reports, ETIMER_STAT_MAX_SITES);
+    fprintf(fp, "etimer stat: %zu sites, near > %u permille of overflow\n", count,
+            etimer_stat_near_permille);
+    for (n = 0; n < count; n++)
+    {
+        const struct etimer_stat_report *report = &reports[n];
+
+        fprintf(fp, "%s:%d %s calls %llu wraps %llu near %llu\n  hist", report->site->file,
+                report->site->line, report->site->op, (unsigned long long)report->counter.calls,
+                (unsigned long long)report->counter.wraps,
+                (unsigned long long)report->counter.near);
+        for (i = 0; i < ETIMER_STAT_BUCKETS; i++)
+        {
+            fprintf(fp, " %llu", (unsigned long long)report->counter.hist[i]);
+        }
+        fprintf(fp, "\n");
+    }
+
+    free(reports);
+}
+
+void etimer_stat_reset(void)
+{
+    etimer_registry_reset(&etimer_stat_registry);
+}
@@ -0,0 +1,246 @@
+#ifndef _ETIMER_STAT_H_
+#define _ETIMER_STAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "etimer.h"
+#include "etimer16.h"
+#include "etimer_registry.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Opt-in instrumentation of the etimer/etimer16 primitives, enabled by building with
+ * -DETIMER_STAT. Every call site then gets its own counters for:
+ * - wrap crossings: the two times lie on both sides of the max_value -> 0 wrap,
+ * - near ambiguity: wrap-aware distance above etimer_stat_near_permille of overflow, where
+ *   etimer_past() is about to flip its answer,
+ * - a histogram of the distance in 1/ETIMER_STAT_BUCKETS steps of overflow.
+ * Counters are per thread, so recording is a few plain increments. Needs gcc/clang (statement
+ * expressions and __thread).
+ */
+
+#define ETIMER_STAT_MAX_SITES 256
+#define ETIMER_STAT_BUCKETS   16
+
+struct etimer_stat_site
+{
+    const char *file;
+    int line;
+    const char *op;
+    uint32_t id; /* 0 until registered */
+};
+
+struct etimer_stat_counter
+{
+    uint64_t calls;
+    uint64_t wraps;
+    uint64_t near;
+    uint64_t hist[ETIMER_STAT_BUCKETS];
+};
+
+struct etimer_stat_thread
+{
+    struct etimer_registry_table link;
+    struct etimer_stat_counter sites[ETIMER_STAT_MAX_SITES];
+};
+
+struct etimer_stat_report
+{
+    const struct etimer_stat_site *site;
+    struct etimer_stat_counter counter; /* summed over threads */
+};
+
+extern __thread struct etimer_stat_thread *etimer_stat_tls;
+extern uint32_t etimer_stat_near_permille;
+
+uint32_t etimer_stat_register(struct etimer_stat_site *site);
+struct etimer_stat_thread *etimer_stat_thread_init(void);
+
+/**
+ * @brief  Set the near ambiguity threshold, default 900 (90% of overflow).
+ * @param[in]  permille: Threshold in 1/1000 of overflow.
+ */
+void etimer_stat_set_near(uint32_t permille);
+
+/**
+ * @brief  Sum the counters of all threads per call site.
+ * @param[out] reports: Output array.
+ * @param[in]  max: Size of reports.
+ * @return number of call sites, may be larger than max.
+ */
+size_t etimer_stat_snapshot(struct etimer_stat_report *reports, size_t max);
+
+/**
+ * @brief  Print one line per call site and its histogram.
+ * @param[in]  fp: Output stream.
+ */
+void etimer_stat_dump(FILE *fp);
+
+/**
+ * @brief  Clear the counters of all threads. Racy against threads still recording.
+ */
+void etimer_stat_reset(void);
+
+/**
+ * @brief  Record one call.
+ * @param[in]  site: Call site.
+ * @param[in]  diff: Numeric distance |time1 - time2| or |ticks|.
+ * @param[in]  wrapped: 1 if the operation crosses the wrap point.
+ * @param[in]  overflow: Overflow time value of the domain.
+ */
+static inline void etimer_stat_record(struct etimer_stat_site *site, uint32_t diff, int wrapped,
+                                      uint32_t overflow)
+{
+    struct etimer_stat_thread *thread = etimer_stat_tls;
+    struct etimer_stat_counter *counter;
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_RELAXED);
+    uint64_t bucket;
+
+    if (__builtin_expect(id == 0, 0))
+    {
+        id = etimer_stat_register(site);
+    }
+    if (__builtin_expect(thread == NULL, 0))
+    {
+        thread = etimer_stat_thread_init();
+    }
+    if (id >= ETIMER_STAT_MAX_SITES || thread == NULL)
+    {
+        return;
+    }
+
+    counter = &thread->sites[id];
+    bucket = (uint64_t)diff * ETIMER_STAT_BUCKETS / ((uint64_t)overflow + 1);
+    counter->calls++;
+    counter->wraps += wrapped;
+    counter->near += (uint64_t)diff * 1000 > (uint64_t)overflow * etimer_stat_near_permille;
+    counter->hist[bucket < ETIMER_STAT_BUCKETS ? bucket : ETIMER_STAT_BUCKETS - 1]++;
+}
+
+/**
+ * @brief  Record a comparison of two times, overflow is assumed to be max_value / 2.
+ */
+static inline void etimer_stat_record_cmp(struct etimer_stat_site *site, uint32_t time1,
+                                          uint32_t time2, uint32_t overflow, uint32_t max_value)
+{
+    uint32_t diff = time1 >= time2 ? time1 - time2 : time2 - time1;
+    int wrapped = diff > overflow;
+
+    etimer_stat_record(site, wrapped ? max_value - diff + 1 : diff, wrapped, overflow);
+}
+
+static inline int etimer_stat_past_raw(struct etimer_stat_site *site, uint32_t time1,
+                                       uint32_t time2, uint32_t overflow)
+{
+    etimer_stat_record_cmp(site, time1, time2, overflow, overflow * 2 + 1);
+    return (etimer_past_raw)(time1, time2, overflow);
+}
+
+static inline int32_t etimer_stat_sub_raw(struct etimer_stat_site *site, uint32_t time1,
+                                          uint32_t time2, uint32_t overflow, uint32_t max_value)
+{
+    etimer_stat_record_cmp(site, time1, time2, overflow, max_value);
+    return (etimer_sub_raw)(time1, time2, overflow, max_value);
+}
+
+static inline int32_t etimer_stat_sub(struct etimer_stat_site *site, uint32_t time1,
+                                      uint32_t time2)
+{
+    etimer_stat_record_cmp(site, time1, time2, ETIMER_MAX_VALUE_OVERFLOW, ETIMER_MAX_VALUE);
+    return (etimer_sub)(time1, time2);
+}
+
+static inline uint32_t etimer_stat_add_raw(struct etimer_stat_site *site, uint32_t time1,
+                                           int32_t ticks, uint32_t max_value)
+{
+    uint32_t tmp = (etimer_add_raw)(time1, ticks, max_value);
+    uint32_t diff = ticks < 0 ? 0 - (uint32_t)ticks : (uint32_t)ticks;
+
+    etimer_stat_record(site, diff, ticks < 0 ? tmp > time1 : tmp < time1, max_value >> 1);
+    return tmp;
+}
+
+static inline int etimer16_stat_past_raw(struct etimer_stat_site *site, uint16_t time1,
+                                         uint16_t time2, uint16_t overflow)
+{
+    etimer_stat_record_cmp(site, time1, time2, overflow, overflow * 2 + 1);
+    return (etimer16_past_raw)(time1, time2, overflow);
+}
+
+static inline int16_t etimer16_stat_sub_raw(struct etimer_stat_site *site, uint16_t time1,
+                                            uint16_t time2, uint16_t overflow, uint16_t max_value)
+{
+    etimer_stat_record_cmp(site, time1, time2, overflow, max_value);
+    return (etimer16_sub_raw)(time1, time2, overflow, max_value);
+}
+
+static inline int16_t etimer16_stat_sub(struct etimer_stat_site *site, uint16_t time1,
+                                        uint16_t time2)
+{
+    etimer_stat_record_cmp(site, time1, time2, ETIMER16_MAX_VALUE_OVERFLOW, 0xFFFF);
+    return (etimer16_sub)(time1, time2);
+}
+
+static inline uint16_t etimer16_stat_add_raw(struct etimer_stat_site *site, uint16_t time1,
+                                             int16_t ticks, uint16_t max_value)
+{
+    uint16_t tmp = (etimer16_add_raw)(time1, ticks, max_value);
+    uint32_t diff = ticks < 0 ? -ticks : ticks;
+
+    etimer_stat_record(site, diff, ticks < 0 ? tmp > time1 : tmp < time1, max_value >> 1);
+    return tmp;
+}
+
+#define ETIMER_STAT_CAT_(a, b) a##b
+#define ETIMER_STAT_CAT(a, b)  ETIMER_STAT_CAT_(a, b)
+
+/**
+ * @brief  Call fn with a call site static to the expansion point.
+ */
+#define ETIMER_STAT_CALL_(name, op, fn, ...)                                                       \
+    __extension__({                                                                                \
+        static struct etimer_stat_site name = {__FILE__, __LINE__, op, 0};                         \
+        fn(&name, __VA_ARGS__);                                                                    \
+    })
+#define ETIMER_STAT_CALL(op, fn, ...)                                                              \
+    ETIMER_STAT_CALL_(ETIMER_STAT_CAT(etimer_stat_site_, __COUNTER__), op, fn, __VA_ARGS__)
+
+#ifdef ETIMER_STAT
+#define etimer_past_raw(time1, time2, overflow)                                                    \
+    ETIMER_STAT_CALL("etimer_past_raw", etimer_stat_past_raw, time1, time2, overflow)
+#define etimer_past(time1, time2)                                                                  \
+    ETIMER_STAT_CALL("etimer_past", etimer_stat_past_raw, time1, time2,                           \
+                     ETIMER_MAX_VALUE_OVERFLOW)
+#define etimer_sub_raw(time1, time2, overflow, max_value)                                          \
+    ETIMER_STAT_CALL("etimer_sub_raw", etimer_stat_sub_raw, time1, time2, overflow, max_value)
+#define etimer_sub(time1, time2) ETIMER_STAT_CALL("etimer_sub", etimer_stat_sub, time1, time2)
+#define etimer_add_raw(time1, ticks, max_value)                                                    \
+    ETIMER_STAT_CALL("etimer_add_raw", etimer_stat_add_raw, time1, ticks, max_value)
+#define etimer_add(time1, ticks)                                                                   \
+    ETIMER_STAT_CALL("etimer_add", etimer_stat_add_raw, time1, ticks, ETIMER_MAX_VALUE)
+
+#define etimer16_past_raw(time1, time2, overflow)                                                  \
+    ETIMER_STAT_CALL("etimer16_past_raw", etimer16_stat_past_raw, time1, time2, overflow)
+#define etimer16_past(time1, time2)                                                                \
+    ETIMER_STAT_CALL("etimer16_past", etimer16_stat_past_raw, time1, time2,                       \
+                     ETIMER16_MAX_VALUE_OVERFLOW)
+#define etimer16_sub_raw(time1, time2, overflow, max_value)                                        \
+    ETIMER_STAT_CALL("etimer16_sub_raw", etimer16_stat_sub_raw, time1, time2, overflow, max_value)
+#define etimer16_sub(time1, time2)                                                                 \
+    ETIMER_STAT_CALL("etimer16_sub", etimer16_stat_sub, time1, time2)
+#define etimer16_add_raw(time1, ticks, max_value)                                                  \
+    ETIMER_STAT_CALL("etimer16_add_raw", etimer16_stat_add_raw, time1, ticks, max_value)
+#define etimer16_add(time1, ticks)                                                                 \
+    ETIMER_STAT_CALL("etimer16_add", etimer16_stat_add_raw, time1, ticks, 0xFFFF)
+#endif /* ETIMER_STAT */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_STAT_H_ */
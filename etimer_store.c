@@ -0,0 +1,120 @@
+#include <errno.h>
+#include <stdlib.h>
+
+#include "etimer_store.h"
+
+int etimer_store_init(struct etimer_store *store, uint32_t capacity, uint32_t max_value,
+                      uint32_t base)
+{
+    uint32_t i;
+
+    store->base = base;
+    store->max_value = max_value;
+    store->overflow = max_value >> 1;
+    store->capacity = capacity;
+    store->count = 0;
+    store->offsets = malloc((size_t)capacity * sizeof(*store->offsets));
+    store->used = calloc(capacity, sizeof(*store->used));
+    store->free_slots = malloc((size_t)capacity * sizeof(*store->free_slots));
+    if (store->offsets == NULL || store->used == NULL || store->free_slots == NULL)
+    {
+        etimer_store_deinit(store);
+        return -ENOMEM;
+    }
+
+    // lowest handles first
+    for (i = 0; i < capacity; i++)
+    {
+        store->free_slots[i] = capacity - 1 - i;
+    }
+    store->free_count = capacity;
+
+    return 0;
+}
+
+void etimer_store_deinit(struct etimer_store *store)
+{
+    free(store->offsets);
+    free(store->used);
+    free(store->free_slots);
+    store->offsets = NULL;
+    store->used = NULL;
+    store->free_slots = NULL;
+    store->capacity = 0;
+    store->count = 0;
+    store->free_count = 0;
+}
+
+uint32_t etimer_store_add(struct etimer_store *store, uint32_t deadline)
+{
+    uint32_t handle;
+
+    if (store->free_count == 0)
+    {
+        return ETIMER_STORE_NONE;
+    }
+
+    handle = store->free_slots[--store->free_count];
+    store->used[handle] = 1;
+    store->count++;
+    etimer_store_set(store, handle, deadline);
+
+    return handle;
+}
+
+void etimer_store_remove(struct etimer_store *store, uint32_t handle)
+{
+    if (!store->used[handle])
+    {
+        return;
+    }
+
+    store->used[handle] = 0;
+    store->count--;
+    store->free_slots[store->free_count++] = handle;
+}
+
+void etimer_store_shift(struct etimer_store *store, const uint32_t *handles, size_t n,
+                        int32_t ticks)
+{
+    uint32_t step = ticks >= 0 ? (uint32_t)ticks
+                               : etimer_store_neg((uint32_t)-(int64_t)ticks, store->max_value);
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        store->offsets[handles[i]] =
+                etimer_add_raw(store->offsets[handles[i]], (int32_t)step, store->max_value);
+    }
+}
+
+void etimer_store_get_batch(const struct etimer_store *store, const uint32_t *handles, size_t n,
+                            uint32_t *deadlines)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        deadlines[i] = etimer_store_get(store, handles[i]);
+    }
+}
+
+size_t etimer_store_expired(const struct etimer_store *store, uint32_t now, uint32_t *handles,
+                            size_t max)
+{
+    // the offset frame is the absolute frame moved by -base, differences are unchanged
+    uint32_t now_offset = etimer_store_offset(store, now);
+    size_t n = 0;
+    uint32_t i;
+
+    for (i = 0; i < store->capacity && n < max; i++)
+    {
+        if (store->used[i] &&
+            etimer_sub_raw(store->offsets[i], now_offset, store->overflow, store->max_value) <= 0)
+        {
+            handles[n++] = i;
+        }
+    }
+
+    return n;
+}
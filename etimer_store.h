@@ -0,0 +1,175 @@
+#ifndef _ETIMER_STORE_H_
+#define _ETIMER_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Deadline store keeping every timer as an offset from one shared base. A step of the time base,
+ * after a sync to a peer or a counter reset, moves all deadlines with one etimer_add_raw() on the
+ * base instead of a walk over the timers. Absolute wrapped deadlines are rebuilt on read.
+ *
+ * Offsets are kept modulo max_value + 1, so they stay exact however far the base lags behind
+ * the deadlines. Any etimer domain works: ETIMER_MAX_VALUE, 0xFFFF for etimer16 times, or a
+ * narrower _raw counter whose max_value + 1 is a power of 2.
+ */
+
+#define ETIMER_STORE_NONE (~(uint32_t)0)
+
+struct etimer_store
+{
+    uint32_t base;
+    uint32_t max_value;
+    uint32_t overflow;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t *offsets;
+    uint8_t *used;
+    uint32_t *free_slots;
+    uint32_t free_count;
+};
+
+/**
+ * @brief  Negate a time modulo max_value + 1.
+ */
+static inline uint32_t etimer_store_neg(uint32_t time1, uint32_t max_value)
+{
+    return time1 ? max_value - time1 + 1 : 0;
+}
+
+/**
+ * @brief  Offset of an absolute time from the base.
+ */
+static inline uint32_t etimer_store_offset(const struct etimer_store *store, uint32_t time1)
+{
+    return etimer_add_raw(time1, (int32_t)etimer_store_neg(store->base, store->max_value),
+                          store->max_value);
+}
+
+/**
+ * @brief  Allocate a store for capacity timers.
+ * @param[out] store: Store.
+ * @param[in]  capacity: Max number of timers.
+ * @param[in]  max_value: Max time value of the domain.
+ * @param[in]  base: Initial base, usually the current time.
+ * @return 0 on success, -ENOMEM on failure.
+ */
+int etimer_store_init(struct etimer_store *store, uint32_t capacity, uint32_t max_value,
+                      uint32_t base);
+
+/**
+ * @brief  Free the store.
+ * @param[in]  store: Store.
+ */
+void etimer_store_deinit(struct etimer_store *store);
+
+/**
+ * @brief  Add a timer.
+ * @param[in]  store: Store.
+ * @param[in]  deadline: Absolute expiry time.
+ * @return handle, ETIMER_STORE_NONE if the store is full.
+ */
+uint32_t etimer_store_add(struct etimer_store *store, uint32_t deadline);
+
+/**
+ * @brief  Remove a timer, its handle may be reused.
+ * @param[in]  store: Store.
+ * @param[in]  handle: Handle returned by etimer_store_add().
+ */
+void etimer_store_remove(struct etimer_store *store, uint32_t handle);
+
+/**
+ * @brief  Set the deadline of a timer.
+ * @param[in]  store: Store.
+ * @param[in]  handle: Handle.
+ * @param[in]  deadline: Absolute expiry time.
+ */
+static inline void etimer_store_set(struct etimer_store *store, uint32_t handle,
+                                    uint32_t deadline)
+{
+    store->offsets[handle] = etimer_store_offset(store, deadline);
+}
+
+/**
+ * @brief  Absolute deadline of a timer.
+ * @param[in]  store: Store.
+ * @param[in]  handle: Handle.
+ * @return absolute expiry time.
+ */
+static inline uint32_t etimer_store_get(const struct etimer_store *store, uint32_t handle)
+{
+    return etimer_add_raw(store->base, (int32_t)store->offsets[handle], store->max_value);
+}
+
+/**
+ * @brief  Move every deadline by ticks in O(1).
+ * @param[in]  store: Store.
+ * @param[in]  ticks: Signed step, within overflow of the domain.
+ */
+static inline void etimer_store_step(struct etimer_store *store, int32_t ticks)
+{
+    uint32_t step = ticks >= 0 ? (uint32_t)ticks
+                               : etimer_store_neg((uint32_t)-(int64_t)ticks, store->max_value);
+
+    store->base = etimer_add_raw(store->base, (int32_t)step, store->max_value);
+}
+
+/**
+ * @brief  Remap every deadline after a counter reset, time from on the old counter is time to on
+ * the new one.
+ * @param[in]  store: Store.
+ * @param[in]  from: Time on the old counter.
+ * @param[in]  to: Same instant on the new counter.
+ */
+static inline void etimer_store_remap(struct etimer_store *store, uint32_t from, uint32_t to)
+{
+    store->base = etimer_add_raw(
+            store->base,
+            (int32_t)etimer_add_raw(to, (int32_t)etimer_store_neg(from, store->max_value),
+                                    store->max_value),
+            store->max_value);
+}
+
+/**
+ * @brief  Move selected deadlines by ticks, leaving the others in place.
+ * @param[in]  store: Store.
+ * @param[in]  handles: Handles to move.
+ * @param[in]  n: Number of handles.
+ * @param[in]  ticks: Signed step, within overflow of the domain.
+ */
+void etimer_store_shift(struct etimer_store *store, const uint32_t *handles, size_t n,
+                        int32_t ticks);
+
+/**
+ * @brief  Absolute deadlines of selected timers.
+ * @param[in]  store: Store.
+ * @param[in]  handles: Handles.
+ * @param[in]  n: Number of handles.
+ * @param[out] deadlines: Absolute expiry times, n entries.
+ */
+void etimer_store_get_batch(const struct etimer_store *store, const uint32_t *handles, size_t n,
+                            uint32_t *deadlines);
+
+/**
+ * @brief  Collect timers whose deadline is not after now. The scan compares offsets against now
+ * moved into the base frame, no deadline is rebuilt.
+ * @param[in]  store: Store.
+ * @param[in]  now: Current absolute time, pending deadlines are expected within overflow of it.
+ * @param[out] handles: Expired handles.
+ * @param[in]  max: Size of handles.
+ * @return number of handles written.
+ */
+size_t etimer_store_expired(const struct etimer_store *store, uint32_t now, uint32_t *handles,
+                            size_t max);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_STORE_H_ */
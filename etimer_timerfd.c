@@ -0,0 +1,124 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "etimer_timerfd.h"
+
+static uint64_t etimer_timerfd_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+uint32_t etimer_timerfd_now(void)
+{
+    return (uint32_t)(etimer_timerfd_now_ns() / 1000);
+}
+
+int etimer_timerfd_init(struct etimer_timerfd *tfd, int epfd, void *data)
+{
+    memset(tfd, 0, sizeof(*tfd));
+
+    tfd->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd->fd < 0)
+    {
+        return -errno;
+    }
+
+    if (epfd >= 0)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = data;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, tfd->fd, &ev) != 0)
+        {
+            int ret = -errno;
+            close(tfd->fd);
+            tfd->fd = -1;
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+void etimer_timerfd_deinit(struct etimer_timerfd *tfd)
+{
+    if (tfd->fd >= 0)
+    {
+        close(tfd->fd);
+    }
+    tfd->fd = -1;
+    tfd->armed = 0;
+}
+
+int etimer_timerfd_arm(struct etimer_timerfd *tfd, uint32_t deadline)
+{
+    struct itimerspec its;
+    uint64_t ns;
+
+    if (tfd->armed && tfd->deadline == deadline)
+    {
+        return 0;
+    }
+
+    ns = etimer_timerfd_to_ns(etimer_timerfd_now_ns(), deadline);
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = ns / 1000000000u;
+    its.it_value.tv_nsec = ns % 1000000000u;
+
+    tfd->arm_count++;
+    if (timerfd_settime(tfd->fd, TFD_TIMER_ABSTIME, &its, NULL) != 0)
+    {
+        tfd->armed = 0;
+        return -errno;
+    }
+    tfd->armed = 1;
+    tfd->deadline = deadline;
+
+    return 0;
+}
+
+int etimer_timerfd_disarm(struct etimer_timerfd *tfd)
+{
+    struct itimerspec its;
+
+    if (!tfd->armed)
+    {
+        return 0;
+    }
+
+    memset(&its, 0, sizeof(its));
+    tfd->arm_count++;
+    tfd->armed = 0;
+    if (timerfd_settime(tfd->fd, 0, &its, NULL) != 0)
+    {
+        return -errno;
+    }
+
+    return 0;
+}
+
+uint64_t etimer_timerfd_ack(struct etimer_timerfd *tfd)
+{
+    uint64_t expirations;
+
+    if (read(tfd->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+    {
+        return 0;
+    }
+    tfd->armed = 0;
+
+    return expirations;
+}
+
+#endif /* __linux__ */
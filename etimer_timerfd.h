@@ -0,0 +1,87 @@
+#ifndef _ETIMER_TIMERFD_H_
+#define _ETIMER_TIMERFD_H_
+
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Linux backend: the etimer clock is CLOCK_MONOTONIC in microseconds truncated to 32 bits, and a
+ * single timerfd is armed for the earliest pending deadline so an epoll loop sleeps until it
+ * instead of polling. The timerfd is armed with an absolute CLOCK_MONOTONIC time derived from
+ * etimer_sub(deadline, now), which stays correct across the 32bit wrap for deadlines within
+ * ETIMER_MAX_VALUE_OVERFLOW of now.
+ */
+
+struct etimer_timerfd
+{
+    int fd;
+    int armed;
+    uint32_t deadline;
+    uint32_t arm_count; /* timerfd_settime calls */
+};
+
+/**
+ * @brief  Convert a wrapped deadline to an absolute CLOCK_MONOTONIC time.
+ * @param[in]  now_ns: Current CLOCK_MONOTONIC time in ns.
+ * @param[in]  deadline: Absolute time in us, truncated to 32 bits.
+ * @return absolute time in ns, now_ns if the deadline has passed.
+ */
+static inline uint64_t etimer_timerfd_to_ns(uint64_t now_ns, uint32_t deadline)
+{
+    int32_t diff = etimer_sub(deadline, (uint32_t)(now_ns / 1000));
+    return diff > 0 ? now_ns - now_ns % 1000 + (uint64_t)diff * 1000 : now_ns;
+}
+
+/**
+ * @brief  Current time: CLOCK_MONOTONIC in us truncated to 32 bits.
+ * @return current absolute time.
+ */
+uint32_t etimer_timerfd_now(void);
+
+/**
+ * @brief  Create the timerfd and register it for EPOLLIN.
+ * @param[out] tfd: Backend state.
+ * @param[in]  epfd: epoll instance, negative to skip registration.
+ * @param[in]  data: epoll_event.data.ptr of the registration.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_timerfd_init(struct etimer_timerfd *tfd, int epfd, void *data);
+
+/**
+ * @brief  Close the timerfd, it is removed from epoll implicitly.
+ * @param[in]  tfd: Backend state.
+ */
+void etimer_timerfd_deinit(struct etimer_timerfd *tfd);
+
+/**
+ * @brief  Arm for the earliest pending deadline. No syscall if already armed for it.
+ * @param[in]  tfd: Backend state.
+ * @param[in]  deadline: Absolute time in us.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_timerfd_arm(struct etimer_timerfd *tfd, uint32_t deadline);
+
+/**
+ * @brief  Disarm, when nothing is pending.
+ * @param[in]  tfd: Backend state.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_timerfd_disarm(struct etimer_timerfd *tfd);
+
+/**
+ * @brief  Consume the expiration after epoll reported the fd readable.
+ * @param[in]  tfd: Backend state.
+ * @return number of expirations, 0 if none was pending.
+ */
+uint64_t etimer_timerfd_ack(struct etimer_timerfd *tfd);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_TIMERFD_H_ */
@@ -0,0 +1,398 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "etimer_trace.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ETIMER_TRACE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define ETIMER_TRACE_USE_MMAP 0
+#endif
+
+static int etimer_trace_flush_block(struct etimer_trace_writer *writer)
+{
+    if (writer->block_used == 0)
+    {
+        return 0;
+    }
+
+    if (fwrite(writer->block, sizeof(writer->block[0]), writer->block_used, writer->fp) !=
+        writer->block_used)
+    {
+        // The file is missing records now, refuse any further write.
+        writer->error = -EIO;
+        return -EIO;
+    }
+    writer->block_used = 0;
+
+    return 0;
+}
+
+int etimer_trace_writer_open(struct etimer_trace_writer *writer, const char *path,
+                             uint32_t max_value)
+{
+    memset(writer, 0, sizeof(*writer));
+
+    writer->fp = fopen(path, "wb");
+    if (writer->fp == NULL)
+    {
+        return -errno;
+    }
+
+    writer->header.magic = ETIMER_TRACE_MAGIC;
+    writer->header.version = ETIMER_TRACE_VERSION;
+    writer->header.max_value = max_value;
+    writer->header.overflow = max_value >> 1;
+    writer->header.record_size = sizeof(struct etimer_trace_record);
+    writer->header.block_records = ETIMER_TRACE_BLOCK_RECORDS;
+
+    // Placeholder, rewritten on close.
+    if (fwrite(&writer->header, sizeof(writer->header), 1, writer->fp) != 1)
+    {
+        fclose(writer->fp);
+        writer->fp = NULL;
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int etimer_trace_write(struct etimer_trace_writer *writer, uint32_t time, uint32_t event)
+{
+    struct etimer_trace_header *header = &writer->header;
+    uint64_t ext_time = time;
+
+    if (writer->error != 0)
+    {
+        return writer->error;
+    }
+
+    if (header->record_count != 0)
+    {
+        int32_t delta =
+                etimer_sub_raw(time, writer->last_time, header->overflow, header->max_value);
+        if (delta < 0)
+        {
+            return -ERANGE;
+        }
+        ext_time = writer->ext_time + delta;
+    }
+
+    if (writer->block_used == 0)
+    {
+        if (header->block_count == writer->index_cap)
+        {
+            uint64_t cap = writer->index_cap ? writer->index_cap * 2 : 64;
+            uint64_t *index = realloc(writer->index, cap * sizeof(*index));
+            if (index == NULL)
+            {
+                return -ENOMEM;
+            }
+            writer->index = index;
+            writer->index_cap = cap;
+        }
+        writer->index[header->block_count++] = ext_time;
+    }
+
+    // Committed only now, a failed write leaves the writer as it was.
+    writer->ext_time = ext_time;
+    writer->block[writer->block_used].time = time;
+    writer->block[writer->block_used].event = event;
+    writer->last_time = time;
+    header->record_count++;
+
+    if (++writer->block_used == ETIMER_TRACE_BLOCK_RECORDS)
+    {
+        return etimer_trace_flush_block(writer);
+    }
+
+    return 0;
+}
+
+int etimer_trace_writer_close(struct etimer_trace_writer *writer)
+{
+    struct etimer_trace_header *header = &writer->header;
+    int ret = writer->error != 0 ? writer->error : etimer_trace_flush_block(writer);
+
+    header->index_offset =
+            sizeof(*header) + header->record_count * sizeof(struct etimer_trace_record);
+    header->end_time = writer->ext_time;
+
+    if (ret == 0 && header->block_count &&
+        fwrite(writer->index, sizeof(uint64_t), header->block_count, writer->fp) !=
+                header->block_count)
+    {
+        ret = -EIO;
+    }
+
+    if (ret == 0 && (fseek(writer->fp, 0, SEEK_SET) != 0 ||
+                     fwrite(header, sizeof(*header), 1, writer->fp) != 1))
+    {
+        ret = -EIO;
+    }
+
+    if (fclose(writer->fp) != 0 && ret == 0)
+    {
+        ret = -EIO;
+    }
+    free(writer->index);
+    writer->fp = NULL;
+    writer->index = NULL;
+
+    return ret;
+}
+
+static int etimer_trace_map(struct etimer_trace_reader *reader, const char *path)
+{
+#if ETIMER_TRACE_USE_MMAP
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+
+    if (fstat(fd, &st) != 0)
+    {
+        int ret = -errno;
+        close(fd);
+        return ret;
+    }
+
+    if ((size_t)st.st_size < sizeof(struct etimer_trace_header))
+    {
+        close(fd);
+        return -EINVAL;
+    }
+
+    reader->map_size = st.st_size;
+    reader->map = mmap(NULL, reader->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (reader->map == MAP_FAILED)
+    {
+        reader->map = NULL;
+        return -errno;
+    }
+
+    return 0;
+#else
+    // No mmap on this platform, fall back to loading the file.
+    long size;
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return -errno;
+    }
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0 ||
+        (size_t)size < sizeof(struct etimer_trace_header))
+    {
+        fclose(fp);
+        return -EINVAL;
+    }
+
+    reader->map_size = size;
+    reader->map = malloc(reader->map_size);
+    if (reader->map == NULL)
+    {
+        fclose(fp);
+        return -ENOMEM;
+    }
+
+    if (fread(reader->map, 1, reader->map_size, fp) != reader->map_size)
+    {
+        fclose(fp);
+        free(reader->map);
+        reader->map = NULL;
+        return -EIO;
+    }
+    fclose(fp);
+
+    return 0;
+#endif
+}
+
+int etimer_trace_reader_open(struct etimer_trace_reader *reader, const char *path)
+{
+    const struct etimer_trace_header *header;
+    uint64_t blocks, room;
+    int ret;
+
+    memset(reader, 0, sizeof(*reader));
+
+    ret = etimer_trace_map(reader, path);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    // counts are checked against the size before any product, which would wrap for a corrupt one
+    header = reader->map;
+    room = reader->map_size - sizeof(*header);
+    blocks = header->block_records == 0 ? 0 :
+             header->record_count / header->block_records +
+                     (header->record_count % header->block_records != 0);
+
+    if (header->magic != ETIMER_TRACE_MAGIC || header->version != ETIMER_TRACE_VERSION ||
+        header->record_size != sizeof(struct etimer_trace_record) || header->max_value == 0 ||
+        (header->max_value & (header->max_value + 1)) != 0 ||
+        header->overflow != header->max_value >> 1 || header->block_records == 0 ||
+        header->block_count != blocks ||
+        header->record_count > room / sizeof(struct etimer_trace_record) ||
+        header->index_offset !=
+                sizeof(*header) + header->record_count * sizeof(struct etimer_trace_record) ||
+        header->block_count > (reader->map_size - header->index_offset) / sizeof(uint64_t) ||
+        reader->map_size - header->index_offset != header->block_count * sizeof(uint64_t))
+    {
+        etimer_trace_reader_close(reader);
+        return -EINVAL;
+    }
+
+    reader->header = header;
+    reader->records = (const struct etimer_trace_record *)(header + 1);
+    reader->index = (const uint64_t *)((const char *)reader->map + header->index_offset);
+
+    return 0;
+}
+
+void etimer_trace_reader_close(struct etimer_trace_reader *reader)
+{
+    if (reader->map != NULL)
+    {
+#if ETIMER_TRACE_USE_MMAP
+        munmap(reader->map, reader->map_size);
+#else
+        free(reader->map);
+#endif
+    }
+    memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * @brief  Last block whose start time is not after time, 0 if time is before the first block.
+ */
+static uint64_t etimer_trace_find_block(const struct etimer_trace_reader *reader, uint64_t time)
+{
+    uint64_t lo = 0;
+    uint64_t hi = reader->header->block_count;
+
+    while (hi - lo > 1)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (reader->index[mid] <= time)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/**
+ * @brief  Locate the first record at or after time in one block. Blocks spanning less than
+ * overflow are binary searched on the offset from their first record, others are decoded.
+ * @param[out] ext: Extended time of the returned record, unchanged if none.
+ * @return record index, or the first record of the next block.
+ */
+static uint64_t etimer_trace_seek(const struct etimer_trace_reader *reader, uint64_t time,
+                                  uint64_t *ext)
+{
+    const struct etimer_trace_header *header = reader->header;
+    uint64_t block = etimer_trace_find_block(reader, time);
+    uint64_t pos = block * header->block_records;
+    uint64_t end = pos + header->block_records;
+    uint64_t start = reader->index[block];
+    uint64_t next = block + 1 < header->block_count ? reader->index[block + 1] : header->end_time;
+    uint32_t first = reader->records[pos].time;
+
+    if (end > header->record_count)
+    {
+        end = header->record_count;
+    }
+
+    if (time <= start)
+    {
+        *ext = start;
+        return pos;
+    }
+
+    if (next - start <= header->overflow)
+    {
+        uint64_t lo = pos, hi = end;
+        while (lo < hi)
+        {
+            uint64_t mid = lo + (hi - lo) / 2;
+            uint32_t t = reader->records[mid].time;
+            uint32_t offset = t >= first ? t - first : t - first + header->max_value + 1;
+            if (start + offset < time)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        pos = lo;
+        if (pos < end)
+        {
+            uint32_t t = reader->records[pos].time;
+            *ext = start + (t >= first ? t - first : t - first + header->max_value + 1);
+            return pos;
+        }
+    }
+    else
+    {
+        uint64_t cur = start;
+        uint32_t last = first;
+        for (; pos < end; pos++)
+        {
+            uint32_t t = reader->records[pos].time;
+            cur += etimer_sub_raw(t, last, header->overflow, header->max_value);
+            last = t;
+            if (cur >= time)
+            {
+                *ext = cur;
+                return pos;
+            }
+        }
+    }
+
+    if (block + 1 < header->block_count)
+    {
+        *ext = next;
+    }
+
+    return pos;
+}
+
+void etimer_trace_find(const struct etimer_trace_reader *reader, uint64_t begin, uint64_t end,
+                       struct etimer_trace_range *range)
+{
+    uint64_t first, last, unused;
+
+    memset(range, 0, sizeof(*range));
+    if (reader->header->record_count == 0 || begin >= end)
+    {
+        return;
+    }
+
+    first = etimer_trace_seek(reader, begin, &range->first_time);
+    last = etimer_trace_seek(reader, end, &unused);
+    if (last > first)
+    {
+        range->first = first;
+        range->count = last - first;
+    }
+}
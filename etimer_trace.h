@@ -0,0 +1,145 @@
+#ifndef _ETIMER_TRACE_H_
+#define _ETIMER_TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define ETIMER_TRACE_MAGIC         0x43525445 /* "ETRC" */
+#define ETIMER_TRACE_VERSION       1
+#define ETIMER_TRACE_BLOCK_RECORDS 4096
+
+/**
+ * File layout, host byte order:
+ *   header | block 0 | block 1 | ... | block n-1 | index
+ * Every block holds block_records records (the last one may be shorter), the index holds one
+ * 64-bit extended start time per block.
+ */
+struct etimer_trace_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t max_value;
+    uint32_t overflow;
+    uint32_t record_size;
+    uint32_t block_records;
+    uint64_t record_count;
+    uint64_t block_count;
+    uint64_t index_offset;
+    uint64_t end_time; /* extended time of the last record */
+    uint64_t reserved;
+};
+
+struct etimer_trace_record
+{
+    uint32_t time;
+    uint32_t event;
+};
+
+struct etimer_trace_writer
+{
+    FILE *fp;
+    struct etimer_trace_header header;
+    struct etimer_trace_record block[ETIMER_TRACE_BLOCK_RECORDS];
+    uint32_t block_used;
+    uint32_t last_time;
+    uint64_t ext_time;
+    uint64_t *index;
+    uint64_t index_cap;
+    int error; /* -EIO once a block failed to write, every later call fails */
+};
+
+struct etimer_trace_reader
+{
+    const struct etimer_trace_header *header;
+    const struct etimer_trace_record *records;
+    const uint64_t *index;
+    void *map;
+    size_t map_size;
+};
+
+struct etimer_trace_range
+{
+    uint64_t first;      /* index of the first record in range */
+    uint64_t count;      /* number of records in range */
+    uint64_t first_time; /* extended time of the first record */
+};
+
+/**
+ * @brief  Extend a wrapped time to 64 bits using the nearest extended reference time.
+ * @param[in]  ref: Extended reference time.
+ * @param[in]  time: Wrapped time, within overflow of ref.
+ * @param[in]  overflow: Overflow time value.
+ * @param[in]  max_value: Max time value.
+ * @return extended time of time.
+ */
+static inline uint64_t etimer_trace_extend_raw(uint64_t ref, uint32_t time, uint32_t overflow,
+                                               uint32_t max_value)
+{
+    uint32_t wrapped = (uint32_t)(ref % ((uint64_t)max_value + 1));
+    return ref + (int64_t)etimer_sub_raw(time, wrapped, overflow, max_value);
+}
+
+/**
+ * @brief  Create a trace file for times in the wrap domain [0, max_value].
+ * @param[out] writer: Writer state.
+ * @param[in]  path: File path.
+ * @param[in]  max_value: Max time value, ETIMER_MAX_VALUE for the 32bit domain.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_trace_writer_open(struct etimer_trace_writer *writer, const char *path,
+                             uint32_t max_value);
+
+/**
+ * @brief  Append one record. Times must not go backwards (wrap-aware) and consecutive records
+ * must be less than overflow apart.
+ * @param[in]  writer: Writer state.
+ * @param[in]  time: Wrapped time of the event.
+ * @param[in]  event: Event payload.
+ * @return 0 on success, -ERANGE if time is before the last record, -ENOMEM, -EIO on write error
+ * (this and every later call).
+ */
+int etimer_trace_write(struct etimer_trace_writer *writer, uint32_t time, uint32_t event);
+
+/**
+ * @brief  Flush pending records, write the index and finalize the header.
+ * @param[in]  writer: Writer state.
+ * @return 0 on success, negative errno on failure.
+ */
+int etimer_trace_writer_close(struct etimer_trace_writer *writer);
+
+/**
+ * @brief  Map a trace file read only. Records and index are used in place.
+ * @param[out] reader: Reader state.
+ * @param[in]  path: File path.
+ * @return 0 on success, negative errno on failure, -EINVAL on a malformed file.
+ */
+int etimer_trace_reader_open(struct etimer_trace_reader *reader, const char *path);
+
+/**
+ * @brief  Unmap a trace file.
+ * @param[in]  reader: Reader state.
+ */
+void etimer_trace_reader_close(struct etimer_trace_reader *reader);
+
+/**
+ * @brief  Find the records with extended time in [begin, end) by binary search over the index,
+ * only the two boundary blocks are decoded.
+ * @param[in]  reader: Reader state.
+ * @param[in]  begin: Extended begin time, inclusive.
+ * @param[in]  end: Extended end time, exclusive.
+ * @param[out] range: Resulting record range, count is 0 if nothing matches.
+ */
+void etimer_trace_find(const struct etimer_trace_reader *reader, uint64_t begin, uint64_t end,
+                       struct etimer_trace_range *range);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_TRACE_H_ */
@@ -0,0 +1,78 @@
+#ifdef __linux__
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+
+#include "etimer_timerfd.h"
+#include "etimer_wait.h"
+
+static inline void etimer_wait_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static inline uint64_t etimer_wait_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void etimer_wait_init(struct etimer_wait *wait)
+{
+    memset(wait, 0, sizeof(*wait));
+    wait->margin = ETIMER_WAIT_MARGIN_NS;
+}
+
+int64_t etimer_wait_ns(struct etimer_wait *wait, uint64_t target_ns)
+{
+    uint64_t now = etimer_wait_now_ns(), wake, spin;
+    struct timespec ts;
+
+    wait->waits++;
+    if (now + wait->margin < target_ns)
+    {
+        wake = target_ns - wait->margin;
+        ts.tv_sec = (time_t)(wake / 1000000000u);
+        ts.tv_nsec = (long)(wake % 1000000000u);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        {
+        }
+        now = etimer_wait_now_ns();
+        wait->sleeps++;
+        etimer_wait_adapt(wait, (int32_t)(now - wake < 0x7FFFFFFF ? now - wake : 0x7FFFFFFF));
+    }
+
+    spin = now;
+    while (now < target_ns)
+    {
+        etimer_wait_relax();
+        now = etimer_wait_now_ns();
+    }
+    wait->spin_ns += now - spin;
+
+    return (int64_t)(now - target_ns);
+}
+
+int64_t etimer_wait(struct etimer_wait *wait, uint32_t deadline)
+{
+    uint64_t now = etimer_wait_now_ns();
+    int32_t diff = etimer_sub(deadline, (uint32_t)(now / 1000));
+
+    // a passed deadline is late by how far it has passed
+    if (diff <= 0)
+    {
+        wait->waits++;
+        return (int64_t)(now % 1000) - (int64_t)diff * 1000;
+    }
+    return etimer_wait_ns(wait, etimer_timerfd_to_ns(now, deadline));
+}
+
+#endif /* __linux__ */
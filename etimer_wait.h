@@ -0,0 +1,89 @@
+#ifndef _ETIMER_WAIT_H_
+#define _ETIMER_WAIT_H_
+
+#include <stdint.h>
+
+#include "etimer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * Linux precise wait on the etimer_timerfd clock, CLOCK_MONOTONIC in microseconds truncated to 32
+ * bits. The wait sleeps with clock_nanosleep() until margin before the deadline, then spins on
+ * the clock with a pause instruction until it is reached. The deadline is converted to an
+ * absolute CLOCK_MONOTONIC time through etimer_sub(), so deadlines across the 32bit wrap are
+ * waited for correctly when they are within ETIMER_MAX_VALUE_OVERFLOW of now.
+ *
+ * The margin tracks a high quantile of the oversleep, the time a sleep wakes after it was asked
+ * to: a sleep waking past the deadline raises it by a quarter, any other sleep lowers it by
+ * 1 / 128. At equilibrium about 1 sleep in 32 wakes past the deadline and spins no more, the
+ * others spin for the margin at most. Outliers move the margin by one step, not to their size.
+ */
+
+#define ETIMER_WAIT_MARGIN_NS     100000 /* initial margin */
+#define ETIMER_WAIT_MIN_MARGIN_NS 2000
+#define ETIMER_WAIT_MAX_MARGIN_NS 2000000
+#define ETIMER_WAIT_UP_SHIFT      2 /* a late sleep adds margin >> 2 */
+#define ETIMER_WAIT_DOWN_SHIFT    7 /* another sleep takes margin >> 7 */
+
+struct etimer_wait
+{
+    uint32_t margin;  /* ns, sleep ends this far before the deadline */
+    uint32_t waits;
+    uint32_t sleeps;
+    uint32_t misses;  /* sleeps woken past the deadline */
+    uint64_t spin_ns; /* time spent spinning */
+};
+
+/**
+ * @brief  Account the oversleep of one sleep and move the margin.
+ * @param[in]  wait: Wait state.
+ * @param[in]  oversleep: ns woken after the requested wakeup.
+ */
+static inline void etimer_wait_adapt(struct etimer_wait *wait, int32_t oversleep)
+{
+    uint32_t margin = wait->margin;
+
+    if (oversleep > (int32_t)margin)
+    {
+        wait->misses++;
+        margin += (margin >> ETIMER_WAIT_UP_SHIFT) + 1;
+    }
+    else
+    {
+        margin -= margin >> ETIMER_WAIT_DOWN_SHIFT;
+    }
+    margin = margin < ETIMER_WAIT_MIN_MARGIN_NS ? ETIMER_WAIT_MIN_MARGIN_NS : margin;
+    margin = margin > ETIMER_WAIT_MAX_MARGIN_NS ? ETIMER_WAIT_MAX_MARGIN_NS : margin;
+    wait->margin = margin;
+}
+
+/**
+ * @brief  Start with ETIMER_WAIT_MARGIN_NS.
+ * @param[out] wait: Wait state.
+ */
+void etimer_wait_init(struct etimer_wait *wait);
+
+/**
+ * @brief  Wait until an absolute CLOCK_MONOTONIC time.
+ * @param[in]  wait: Wait state.
+ * @param[in]  target_ns: Absolute time in ns.
+ * @return ns returned after target_ns, 0 or more.
+ */
+int64_t etimer_wait_ns(struct etimer_wait *wait, uint64_t target_ns);
+
+/**
+ * @brief  Wait until a deadline on the etimer_timerfd clock. A passed deadline returns at once.
+ * @param[in]  wait: Wait state.
+ * @param[in]  deadline: Absolute time in us, truncated to 32 bits.
+ * @return ns returned after the start of the deadline microsecond.
+ */
+int64_t etimer_wait(struct etimer_wait *wait, uint32_t deadline);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _ETIMER_WAIT_H_ */
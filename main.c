@@ -1,8 +1,39 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "etimer.h"
 #include "etimer16.h"
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "etimer_bin.h"
+#include "etimer_clock.h"
+#include "etimer_compact.h"
+#include "etimer_earliest.h"
+#include "etimer_edf.h"
+#include "etimer_idle.h"
+#include "etimer_lift.h"
+#include "etimer_jitter.h"
+#include "etimer_loop.h"
+#include "etimer_min.h"
+#include "etimer_prof.h"
+#include "etimer_queue.h"
+#include "etimer_service.h"
+#include "etimer_shm.h"
+#include "etimer_snap.h"
+#include "etimer_sorted.h"
+#include "etimer_stat.h"
+#include "etimer_store.h"
+#include "etimer_timerfd.h"
+#include "etimer_trace.h"
+#include "etimer_wait.h"
 
 //
 // Tests
@@ -936,6 +967,2085 @@ void test_work_etimer_insuff(void)
     SUITE_END();
 }
 
+static struct etimer_trace_writer trace_writer;
+
+void test_etimer_trace(void)
+{
+    SUITE_START("test_etimer_trace");
+
+    const char *path = "etimer_trace_test.bin";
+    struct etimer_trace_reader reader;
+    struct etimer_trace_range range;
+    uint32_t max_value = 0x00FFFFFF;
+    uint32_t start = 0x00FFF000;
+    uint32_t step = 0x1000;
+    uint32_t count = 3 * ETIMER_TRACE_BLOCK_RECORDS + 100; // wraps the 24bit domain 3 times
+    uint32_t i;
+    int ret;
+
+    ret = etimer_trace_writer_open(&trace_writer, path, max_value);
+    ASSERT(ret == 0);
+    for (i = 0; i < count; i++)
+    {
+        ret |= etimer_trace_write(&trace_writer, etimer_add_raw(start, i * step, max_value), i);
+    }
+    ASSERT(ret == 0);
+    // going backwards is rejected
+    ret = etimer_trace_write(&trace_writer, etimer_add_raw(start, (i - 2) * step, max_value), 0);
+    ASSERT(ret == -ERANGE);
+    ret = etimer_trace_writer_close(&trace_writer);
+    ASSERT(ret == 0);
+
+    ret = etimer_trace_reader_open(&reader, path);
+    ASSERT(ret == 0);
+    ASSERT(reader.header->record_count == count);
+    ASSERT(reader.header->block_count == 4);
+    ASSERT(reader.header->max_value == max_value);
+    ASSERT(reader.index[1] == start + (uint64_t)ETIMER_TRACE_BLOCK_RECORDS * step);
+
+    // range across a block boundary and a wrap
+    etimer_trace_find(&reader, start + 5000ull * step, start + 9000ull * step, &range);
+    ASSERT(range.first == 5000);
+    ASSERT(range.count == 4000);
+    ASSERT(range.first_time == start + 5000ull * step);
+    ASSERT(reader.records[range.first].event == 5000);
+
+    // begin between two records
+    etimer_trace_find(&reader, start + 5000ull * step + 1, start + 5002ull * step + 1, &range);
+    ASSERT(range.first == 5001);
+    ASSERT(range.count == 2);
+
+    // clipped at both ends
+    etimer_trace_find(&reader, 0, start + 10ull * step, &range);
+    ASSERT(range.first == 0);
+    ASSERT(range.count == 10);
+    etimer_trace_find(&reader, start + (count - 3ull) * step, ~0ull, &range);
+    ASSERT(range.first == count - 3);
+    ASSERT(range.count == 3);
+
+    // outside of the trace
+    etimer_trace_find(&reader, start + (uint64_t)count * step, ~0ull, &range);
+    ASSERT(range.count == 0);
+    etimer_trace_find(&reader, 0, start, &range);
+    ASSERT(range.count == 0);
+
+    // wrapped time back to extended time
+    ASSERT(etimer_trace_extend_raw(start + 5000ull * step, reader.records[5001].time,
+                                   reader.header->overflow,
+                                   max_value) == start + 5001ull * step);
+
+    etimer_trace_reader_close(&reader);
+
+    // 32bit domain
+    ret = etimer_trace_writer_open(&trace_writer, path, ETIMER_MAX_VALUE);
+    ret |= etimer_trace_write(&trace_writer, 0xFFFFFFF0, 1);
+    ret |= etimer_trace_write(&trace_writer, 0x10, 2);
+    ret |= etimer_trace_write(&trace_writer, 0x20, 3);
+    ret |= etimer_trace_writer_close(&trace_writer);
+    ASSERT(ret == 0);
+    ret = etimer_trace_reader_open(&reader, path);
+    ASSERT(ret == 0);
+    etimer_trace_find(&reader, 0x100000000ull, 0x100000020ull, &range);
+    ASSERT(range.first == 1);
+    ASSERT(range.count == 1);
+    ASSERT(range.first_time == 0x100000010ull);
+
+    // counts whose sizes wrap 64 bits back to the file size, a domain that is not 2^n
+    struct etimer_trace_header header = *reader.header;
+    uint64_t pad[4] = {0};
+    FILE *fp;
+    etimer_trace_reader_close(&reader);
+    header.block_records = 1;
+    header.record_count = (1ull << 60) + 2;
+    header.block_count = header.record_count;
+    header.index_offset = sizeof(header) + header.record_count * sizeof(struct etimer_trace_record);
+    fp = fopen(path, "wb");
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(pad, sizeof(pad), 1, fp);
+    fclose(fp);
+    ASSERT(etimer_trace_reader_open(&reader, path) == -EINVAL);
+    header.record_count = 2;
+    header.block_count = 2;
+    header.index_offset = sizeof(header) + 2 * sizeof(struct etimer_trace_record);
+    fp = fopen(path, "wb");
+    fwrite(&header, sizeof(header), 1, fp);
+    fwrite(pad, sizeof(pad), 1, fp);
+    fclose(fp);
+    ASSERT(etimer_trace_reader_open(&reader, path) == 0);
+    etimer_trace_reader_close(&reader);
+    header.max_value = 0xFFFE;
+    header.overflow = 0x7FFF;
+    fp = fopen(path, "r+b");
+    fwrite(&header, sizeof(header), 1, fp);
+    fclose(fp);
+    ASSERT(etimer_trace_reader_open(&reader, path) == -EINVAL);
+
+    remove(path);
+
+#ifdef __linux__
+    // a block that fails to write fails every later call
+    ret = etimer_trace_writer_open(&trace_writer, "/dev/full", ETIMER_MAX_VALUE);
+    ASSERT(ret == 0);
+    for (i = 0; i + 1 < ETIMER_TRACE_BLOCK_RECORDS; i++)
+    {
+        ret |= etimer_trace_write(&trace_writer, i, i);
+    }
+    ASSERT(ret == 0);
+    ret = etimer_trace_write(&trace_writer, i, i);
+    ASSERT(ret == -EIO);
+    ret = etimer_trace_write(&trace_writer, i + 1, i);
+    ASSERT(ret == -EIO && trace_writer.block_used == ETIMER_TRACE_BLOCK_RECORDS);
+    ASSERT(trace_writer.header.record_count == ETIMER_TRACE_BLOCK_RECORDS);
+    ret = etimer_trace_writer_close(&trace_writer);
+    ASSERT(ret == -EIO);
+#endif /* __linux__ */
+
+    SUITE_END();
+}
+
+static uint32_t test_rand_seed = 1;
+
+static uint32_t test_rand(void)
+{
+    test_rand_seed ^= test_rand_seed << 13;
+    test_rand_seed ^= test_rand_seed >> 17;
+    test_rand_seed ^= test_rand_seed << 5;
+    return test_rand_seed;
+}
+
+/**
+ * @brief  Reference soonest deadline: smallest distance from now - overflow.
+ */
+static size_t test_min_ref(const uint32_t *deadlines, size_t n, uint32_t now, uint32_t overflow,
+                           uint32_t max_value)
+{
+    uint64_t range = (uint64_t)max_value + 1;
+    uint64_t base = ((uint64_t)now + range - overflow) % range;
+    uint64_t best_key = 0;
+    size_t best = n;
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        uint64_t key = ((uint64_t)deadlines[i] + range - base) % range;
+        if (best == n || key < best_key)
+        {
+            best = i;
+            best_key = key;
+        }
+    }
+
+    return best;
+}
+
+static uint32_t test_min_deadlines[5000];
+static uint16_t test_min_deadlines16[5000];
+
+void test_etimer_min(void)
+{
+    SUITE_START("test_etimer_min");
+
+    uint32_t deadlines[] = {0x30, 0xFFFFFFF0, 0x10, 0x20, 0x10};
+    uint32_t value = 0;
+    uint16_t value16 = 0;
+    size_t idx;
+    size_t n, i;
+    int round;
+
+    // empty
+    idx = etimer_min(deadlines, 0, 0, &value);
+    ASSERT(idx == 0);
+
+    // A(0xFFFFFFF0) is the soonest across the wrap
+    idx = etimer_min(deadlines, 5, 0xFFFFFFE0, &value);
+    ASSERT(idx == 1);
+    ASSERT(value == 0xFFFFFFF0);
+
+    // overdue deadline is the soonest, ties return the first index
+    idx = etimer_min(deadlines, 5, 0x18, &value);
+    ASSERT(idx == 1);
+    idx = etimer_min(deadlines + 2, 3, 0x18, &value);
+    ASSERT(idx == 0);
+    ASSERT(value == 0x10);
+
+    // 0x10 is more than overflow in the past (far future), 0x20 is not
+    idx = etimer_min(deadlines, 5, 0x10 + ETIMER_MAX_VALUE_OVERFLOW + 1, &value);
+    ASSERT(idx == 3);
+
+    // random sizes over the SIMD, chunk and tail paths
+    for (round = 0; round < 40; round++)
+    {
+        uint32_t now = test_rand();
+        uint32_t max_value = round % 2 ? 0x00FFFFFF : ETIMER_MAX_VALUE;
+        uint32_t overflow = max_value / 2;
+        n = test_rand() % 5000;
+        for (i = 0; i < n; i++)
+        {
+            test_min_deadlines[i] = test_rand() & max_value;
+            test_min_deadlines16[i] = (uint16_t)test_rand();
+        }
+        now &= max_value;
+
+        idx = etimer_min_raw(test_min_deadlines, n, now, overflow, max_value, &value);
+        ASSERT(idx == test_min_ref(test_min_deadlines, n, now, overflow, max_value));
+        ASSERT(idx == n || value == test_min_deadlines[idx]);
+
+        idx = etimer16_min(test_min_deadlines16, n, (uint16_t)now, &value16);
+        for (i = 0; i < n; i++)
+        {
+            test_min_deadlines[i] = test_min_deadlines16[i];
+        }
+        ASSERT(idx == test_min_ref(test_min_deadlines, n, (uint16_t)now, 0x7FFF, 0xFFFF));
+        ASSERT(idx == n || value16 == test_min_deadlines16[idx]);
+
+        for (i = 0; i < n; i++)
+        {
+            test_min_deadlines16[i] &= 0x0FFF;
+        }
+        idx = etimer16_min_raw(test_min_deadlines16, n, (uint16_t)(now & 0x0FFF), 0x07FF, 0x0FFF,
+                               &value16);
+        for (i = 0; i < n; i++)
+        {
+            test_min_deadlines[i] = test_min_deadlines16[i];
+        }
+        ASSERT(idx == test_min_ref(test_min_deadlines, n, now & 0x0FFF, 0x07FF, 0x0FFF));
+    }
+
+    SUITE_END();
+}
+
+static uint32_t test_service_order[8];
+static uint32_t test_service_fired;
+static uint32_t test_service_shard;
+static uint32_t test_service_ran_on[8];
+
+static void test_service_cb(struct etimer_service_timer *timer, void *arg)
+{
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+
+    test_service_ran_on[id] = test_service_shard;
+    test_service_order[test_service_fired++] = id;
+}
+
+static struct etimer_service test_svc;
+
+static void test_service_periodic_cb(struct etimer_service_timer *timer, void *arg)
+{
+    test_service_fired++;
+    etimer_service_start(&test_svc, test_service_shard, timer, test_service_shard,
+                         etimer_add(timer->deadline, 0x10));
+}
+
+static void test_service_move_cb(struct etimer_service_timer *timer, void *arg)
+{
+    test_service_fired++;
+    if (test_service_fired == 1)
+    {
+        // re-armed onto shard 1, which fires it before this callback returns
+        etimer_service_start(&test_svc, 0, timer, 1, etimer_add(timer->deadline, 0x10));
+        test_service_shard = 1;
+        etimer_service_poll(&test_svc, 1, etimer_add(timer->deadline, 0x10), 16);
+        etimer_service_start(&test_svc, 1, timer, 1, etimer_add(timer->deadline, 0x10));
+    }
+}
+
+void test_etimer_service(void)
+{
+    SUITE_START("test_etimer_service");
+
+    struct etimer_service_timer timers[4];
+    uint32_t deadline = 0;
+    uint32_t ran;
+    int ret;
+    int i;
+
+    ret = etimer_service_init(&test_svc, 2);
+    ASSERT(ret == 0);
+    for (i = 0; i < 4; i++)
+    {
+        etimer_service_timer_init(&timers[i], test_service_cb, (void *)(uintptr_t)i);
+    }
+
+    // A(0xFFFFFFF0) < B(0x10) < C(0x20), started out of order on shard 0
+    test_service_fired = 0;
+    etimer_service_start(&test_svc, 0, &timers[2], 0, 0x20);
+    etimer_service_start(&test_svc, 0, &timers[0], 0, 0xFFFFFFF0);
+    etimer_service_start(&test_svc, 0, &timers[1], 0, 0x10);
+    ret = etimer_service_start(&test_svc, 0, &timers[1], 0, 0x10);
+    ASSERT(ret == -EBUSY);
+    ret = etimer_service_next(&test_svc, 0, &deadline);
+    ASSERT(ret == 1 && deadline == 0xFFFFFFF0);
+    ran = etimer_service_poll(&test_svc, 0, 0xFFFFFFF8, 16);
+    ASSERT(ran == 1);
+    ASSERT(etimer_service_idle(&timers[0]));
+    ran = etimer_service_poll(&test_svc, 0, 0x20, 16);
+    ASSERT(ran == 2);
+    ASSERT(test_service_order[0] == 0 && test_service_order[1] == 1 && test_service_order[2] == 2);
+    ret = etimer_service_cancel(&test_svc, 0, &timers[0]);
+    ASSERT(ret == -EALREADY);
+
+    // start and cancel from shard 1 on a timer owned by shard 0 go through the inbox
+    test_service_fired = 0;
+    ret = etimer_service_start(&test_svc, 1, &timers[3], 0, 0x100);
+    ASSERT(ret == 0);
+    ASSERT(etimer_service_next(&test_svc, 0, &deadline) == 0);
+    ran = etimer_service_poll(&test_svc, 0, 0x80, 16);
+    ASSERT(ran == 0);
+    ASSERT(etimer_service_next(&test_svc, 0, &deadline) == 1 && deadline == 0x100);
+    ret = etimer_service_cancel(&test_svc, 1, &timers[3]);
+    ASSERT(ret == 0);
+    ASSERT(!etimer_service_idle(&timers[3]));
+    ran = etimer_service_poll(&test_svc, 0, 0x200, 16);
+    ASSERT(ran == 0);
+    ASSERT(etimer_service_idle(&timers[3]));
+    ASSERT(etimer_service_next(&test_svc, 0, &deadline) == 0);
+
+    // cancelled while its start message is still queued
+    etimer_service_start(&test_svc, 1, &timers[3], 0, 0x300);
+    etimer_service_cancel(&test_svc, 1, &timers[3]);
+    etimer_service_poll(&test_svc, 0, 0x400, 16);
+    ASSERT(etimer_service_idle(&timers[3]));
+    ASSERT(test_service_fired == 0);
+
+    // expired but unrun on shard 0 (no budget), shard 1 steals them
+    for (i = 0; i < 3; i++)
+    {
+        etimer_service_start(&test_svc, 0, &timers[i], 0, 0x500 + i);
+    }
+    test_service_shard = 0;
+    ran = etimer_service_poll(&test_svc, 0, 0x600, 0);
+    ASSERT(ran == 0);
+    ret = etimer_service_cancel(&test_svc, 1, &timers[1]); // ready, cancel from anywhere
+    ASSERT(ret == 0);
+    test_service_shard = 1;
+    ran = etimer_service_poll(&test_svc, 1, 0x600, 16);
+    ASSERT(ran == 2);
+    ASSERT(test_service_ran_on[0] == 1 && test_service_ran_on[2] == 1);
+    ran = etimer_service_poll(&test_svc, 0, 0x600, 16);
+    ASSERT(ran == 0);
+    ASSERT(test_service_fired == 2);
+
+    // re-armed from its callback
+    test_service_fired = 0;
+    test_service_shard = 0;
+    etimer_service_timer_init(&timers[0], test_service_periodic_cb, NULL);
+    etimer_service_start(&test_svc, 0, &timers[0], 0, 0xFFFFFFF0);
+    etimer_service_poll(&test_svc, 0, 0xFFFFFFF0, 16);
+    etimer_service_poll(&test_svc, 0, 0x00, 16);
+    etimer_service_poll(&test_svc, 0, 0x10, 16);
+    ASSERT(test_service_fired == 3);
+    ASSERT(!etimer_service_idle(&timers[0]));
+    ASSERT(etimer_service_next(&test_svc, 0, &deadline) == 1 && deadline == 0x20);
+    etimer_service_cancel(&test_svc, 0, &timers[0]);
+
+    // re-armed onto another shard from its callback, runs there before the first run returns
+    test_service_fired = 0;
+    test_service_shard = 0;
+    etimer_service_timer_init(&timers[0], test_service_move_cb, NULL);
+    etimer_service_start(&test_svc, 0, &timers[0], 0, 0xFFFFFFF8);
+    ran = etimer_service_poll(&test_svc, 0, 0xFFFFFFF8, 16);
+    ASSERT(ran == 1 && test_service_fired == 2);
+    ASSERT(!etimer_service_idle(&timers[0]));
+    ASSERT(etimer_service_start(&test_svc, 1, &timers[0], 1, 0x100) == -EBUSY);
+    ASSERT(etimer_service_next(&test_svc, 1, &deadline) == 1 && deadline == 0x18);
+    ran = etimer_service_poll(&test_svc, 1, 0x18, 16);
+    ASSERT(ran == 1 && test_service_fired == 3 && etimer_service_idle(&timers[0]));
+
+    // lateness telemetry across the wrap, the stolen timer counts on the thief's shard
+    struct etimer_service_late late;
+    uint32_t worst[4];
+    for (i = 0; i < 4; i++)
+    {
+        etimer_service_timer_init(&timers[i], test_service_cb, (void *)(uintptr_t)i);
+    }
+    etimer_service_start(&test_svc, 0, &timers[0], 0, 0xFFFFFFE0);
+    ran = etimer_service_poll(&test_svc, 0, 0xFFFFFFF0, 16); // recorded only when enabled
+    ASSERT(ran == 1);
+    etimer_service_late_enable(&test_svc, 1);
+    timers[1].cls = 3;
+    timers[2].cls = 3;
+    timers[3].cls = 100;
+    etimer_service_start(&test_svc, 0, &timers[0], 0, 0xFFFFFFF8);
+    etimer_service_start(&test_svc, 0, &timers[1], 0, 0xFFFFFFFC);
+    etimer_service_start(&test_svc, 0, &timers[2], 0, 0x04);
+    etimer_service_start(&test_svc, 0, &timers[3], 0, 0x08);
+    ran = etimer_service_poll(&test_svc, 0, 0x08, 3);
+    ASSERT(ran == 3);
+    ran = etimer_service_poll(&test_svc, 1, 0x108, 16);
+    ASSERT(ran == 1);
+    ASSERT(test_svc.shards[0].late.hist[5] == 1 && test_svc.shards[1].late.hist[9] == 1);
+    etimer_service_late_snapshot(&test_svc, &late);
+    ASSERT(late.hist[3] == 1 && late.hist[4] == 1 && late.hist[5] == 1 && late.hist[9] == 1);
+    ASSERT(late.hist[0] == 0);
+    ASSERT(late.classes[0].count == 1 && late.classes[0].max == 16);
+    ASSERT(late.classes[3].count == 2 && late.classes[3].sum == 16);
+    ASSERT(late.classes[3].max == 12 && late.classes[3].max_deadline == 0xFFFFFFFC);
+    ASSERT(late.classes[ETIMER_SERVICE_LATE_CLASSES - 1].max == 256);
+    ASSERT(etimer_service_late_quantile(&late, 250) == 7);
+    ASSERT(etimer_service_late_quantile(&late, 500) == 15);
+    ASSERT(etimer_service_late_quantile(&late, 1000) == 511);
+    ASSERT(etimer_service_late_worst(&late, worst, 4) == 3);
+    ASSERT(worst[0] == ETIMER_SERVICE_LATE_CLASSES - 1 && worst[1] == 0 && worst[2] == 3);
+    ASSERT(etimer_service_late_worst(&late, worst, 1) == 1 && worst[0] == 15);
+    etimer_service_late_reset(&test_svc);
+    etimer_service_late_snapshot(&test_svc, &late);
+    ASSERT(etimer_service_late_quantile(&late, 500) == 0 && late.classes[3].count == 0);
+
+    etimer_service_deinit(&test_svc);
+
+    SUITE_END();
+}
+
+struct test_co
+{
+    struct etimer_co co;
+    uint32_t id;
+    int i;
+};
+
+static uint32_t test_co_log[16];
+static uint32_t test_co_log_size;
+
+static void test_co_record(struct test_co *t)
+{
+    test_co_log[test_co_log_size++] = t->id << 8 | (t->co.loop->now & 0xFF);
+}
+
+static int test_co_a(struct etimer_co *co)
+{
+    struct test_co *t = (struct test_co *)co;
+
+    ETIMER_CO_BEGIN(co);
+    ETIMER_CO_SLEEP_UNTIL(co, 0xFFFFFFF0);
+    test_co_record(t);
+    ETIMER_CO_SLEEP_UNTIL(co, 0x10);
+    test_co_record(t);
+    ETIMER_CO_END(co);
+}
+
+static int test_co_b(struct etimer_co *co)
+{
+    struct test_co *t = (struct test_co *)co;
+
+    ETIMER_CO_BEGIN(co);
+    for (t->i = 0; t->i < 2; t->i++)
+    {
+        ETIMER_CO_SLEEP_FOR(co, 0x18);
+        test_co_record(t);
+    }
+    ETIMER_CO_END(co);
+}
+
+void test_etimer_loop(void)
+{
+    SUITE_START("test_etimer_loop");
+
+    struct etimer_loop loop;
+    struct test_co *a, *b;
+    uint32_t deadline = 0;
+    uint32_t now;
+    int ret;
+
+    // pool sizes that wrap size_t
+    ASSERT(etimer_loop_init(&loop, SIZE_MAX / 2 + 1, 2, 0) == -EINVAL);
+    ASSERT(etimer_loop_init(&loop, SIZE_MAX, 1, 0) == -EINVAL);
+
+    ret = etimer_loop_init(&loop, sizeof(struct test_co), 2, 0xFFFFFFE0);
+    ASSERT(ret == 0);
+
+    test_co_log_size = 0;
+    a = (struct test_co *)etimer_loop_spawn(&loop, test_co_a);
+    b = (struct test_co *)etimer_loop_spawn(&loop, test_co_b);
+    ASSERT(a != NULL && b != NULL);
+    a->id = 1;
+    b->id = 2;
+    ASSERT(etimer_loop_spawn(&loop, test_co_a) == NULL); // pool exhausted
+
+    // drive the loop from deadline to deadline across the wrap
+    now = 0xFFFFFFE0;
+    while (etimer_loop_run(&loop, now), etimer_loop_next(&loop, &deadline))
+    {
+        ASSERT(!etimer_past(deadline, now));
+        now = deadline;
+    }
+    ASSERT(test_co_log_size == 4);
+    ASSERT(test_co_log[0] == (1 << 8 | 0xF0));
+    ASSERT(test_co_log[1] == (2 << 8 | 0xF8));
+    ASSERT(test_co_log[2] == (1 << 8 | 0x10));
+    ASSERT(test_co_log[3] == (2 << 8 | 0x10));
+    ASSERT(loop.spawned == 2);
+    ASSERT(loop.resumed == 6);
+
+    // finished frames went back to the pool
+    ASSERT(etimer_loop_spawn(&loop, test_co_a) != NULL);
+    ASSERT(etimer_loop_spawn(&loop, test_co_a) != NULL);
+
+    etimer_loop_deinit(&loop);
+
+    SUITE_END();
+}
+
+void test_etimer_timerfd(void)
+{
+    SUITE_START("test_etimer_timerfd");
+
+    // wrapped deadline to absolute time
+    uint64_t now_ns = ((1ull << 32) + 0xFFFFFF00) * 1000 + 123;
+    ASSERT(etimer_timerfd_to_ns(now_ns, 0x100) == now_ns - 123 + 0x200 * 1000);
+    ASSERT(etimer_timerfd_to_ns(now_ns, 0xFFFFFF01) == now_ns - 123 + 1000);
+    ASSERT(etimer_timerfd_to_ns(now_ns, 0xFFFFFF00) == now_ns); // due now
+    ASSERT(etimer_timerfd_to_ns(now_ns, 0xFFFFFE00) == now_ns); // passed
+
+#ifdef __linux__
+    struct etimer_timerfd tfd;
+    struct epoll_event ev;
+    uint32_t deadline, now;
+    int epfd = epoll_create1(0);
+    int ret, n;
+
+    ret = etimer_timerfd_init(&tfd, epfd, &tfd);
+    ASSERT(ret == 0);
+
+    deadline = etimer_add(etimer_timerfd_now(), 2000);
+    ret = etimer_timerfd_arm(&tfd, deadline);
+    ASSERT(ret == 0);
+    ret = etimer_timerfd_arm(&tfd, deadline); // same deadline, no syscall
+    ASSERT(ret == 0 && tfd.arm_count == 1);
+    n = epoll_wait(epfd, &ev, 1, 1000);
+    now = etimer_timerfd_now();
+    ASSERT(n == 1 && ev.data.ptr == &tfd);
+    ASSERT(!etimer_past(now, deadline));
+    ASSERT(etimer_timerfd_ack(&tfd) == 1);
+
+    // deadline already passed fires right away
+    ret = etimer_timerfd_arm(&tfd, etimer_add(etimer_timerfd_now(), -1000));
+    n = epoll_wait(epfd, &ev, 1, 1000);
+    ASSERT(ret == 0 && n == 1);
+    ASSERT(etimer_timerfd_ack(&tfd) == 1);
+
+    // disarmed
+    etimer_timerfd_arm(&tfd, etimer_add(etimer_timerfd_now(), 1000));
+    etimer_timerfd_disarm(&tfd);
+    n = epoll_wait(epfd, &ev, 1, 5);
+    ASSERT(n == 0);
+    ASSERT(etimer_timerfd_ack(&tfd) == 0);
+
+    etimer_timerfd_deinit(&tfd);
+    close(epfd);
+#endif
+
+    SUITE_END();
+}
+
+static const struct etimer_stat_counter *test_stat_find(struct etimer_stat_report *reports,
+                                                        size_t count,
+                                                        const struct etimer_stat_site *site)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (reports[i].site == site)
+        {
+            return &reports[i].counter;
+        }
+    }
+    return NULL;
+}
+
+void test_etimer_stat(void)
+{
+    SUITE_START("test_etimer_stat");
+
+    static struct etimer_stat_site past = {__FILE__, __LINE__, "etimer_past", 0};
+    static struct etimer_stat_site add16 = {__FILE__, __LINE__, "etimer16_add", 0};
+    static struct etimer_stat_site sub_raw = {__FILE__, __LINE__, "etimer_sub_raw", 0};
+    static struct etimer_stat_report reports[ETIMER_STAT_MAX_SITES];
+    const struct etimer_stat_counter *counter;
+    size_t count;
+
+    // results are those of the wrapped primitives
+    ASSERT(etimer_stat_past_raw(&past, 0xFFFFFFF0, 0x10, ETIMER_MAX_VALUE_OVERFLOW) == 1);
+    ASSERT(etimer_stat_past_raw(&past, 0x10, 0x20, ETIMER_MAX_VALUE_OVERFLOW) == 1);
+    ASSERT(etimer_stat_past_raw(&past, 0x10, 0x7FFFFFF0, ETIMER_MAX_VALUE_OVERFLOW) == 1);
+    ASSERT(etimer16_stat_add_raw(&add16, 0xFFF0, 0x20, 0xFFFF) == 0x10);
+    ASSERT(etimer16_stat_add_raw(&add16, 0x10, -0x20, 0xFFFF) == 0xFFF0);
+    ASSERT(etimer16_stat_add_raw(&add16, 0x10, 0x7F00, 0xFFFF) == 0x7F10);
+    ASSERT(etimer_stat_sub_raw(&sub_raw, 0x10, 0xFF0, 0x7FF, 0xFFF) == 0x20);
+    ASSERT(ETIMER_STAT_CALL("etimer_sub", etimer_stat_sub, 5, 0xFFFFFFFB) == 10);
+
+    count = etimer_stat_snapshot(reports, ETIMER_STAT_MAX_SITES);
+    ASSERT(count >= 4);
+
+    // one crossing, one beyond 90% of overflow
+    counter = test_stat_find(reports, count, &past);
+    ASSERT(counter && counter->calls == 3 && counter->wraps == 1 && counter->near == 1);
+    ASSERT(counter && counter->hist[0] == 2 && counter->hist[ETIMER_STAT_BUCKETS - 1] == 1);
+
+    counter = test_stat_find(reports, count, &add16);
+    ASSERT(counter && counter->calls == 3 && counter->wraps == 2 && counter->near == 1);
+
+    // 12 bit raw domain
+    counter = test_stat_find(reports, count, &sub_raw);
+    ASSERT(counter && counter->calls == 1 && counter->wraps == 1 && counter->near == 0);
+    ASSERT(counter && counter->hist[0] == 1);
+
+    // lower threshold
+    etimer_stat_set_near(0);
+    etimer_stat_past_raw(&past, 0x10, 0x20, ETIMER_MAX_VALUE_OVERFLOW);
+    etimer_stat_set_near(900);
+    count = etimer_stat_snapshot(reports, ETIMER_STAT_MAX_SITES);
+    counter = test_stat_find(reports, count, &past);
+    ASSERT(counter && counter->calls == 4 && counter->near == 2);
+
+    etimer_stat_reset();
+    count = etimer_stat_snapshot(reports, ETIMER_STAT_MAX_SITES);
+    counter = test_stat_find(reports, count, &past);
+    ASSERT(counter && counter->calls == 0 && counter->hist[0] == 0);
+
+    SUITE_END();
+}
+
+static uint32_t test_prof_clock;
+
+static uint32_t test_prof_read(void)
+{
+    return test_prof_clock;
+}
+
+static const struct etimer_prof_stat *test_prof_find(struct etimer_prof_report *reports,
+                                                     size_t count, const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (strcmp(reports[i].name, name) == 0)
+        {
+            return &reports[i].stat;
+        }
+    }
+    return NULL;
+}
+
+void test_etimer_prof(void)
+{
+    SUITE_START("test_etimer_prof");
+
+    static struct etimer_prof_report reports[ETIMER_PROF_MAX_SECTIONS];
+    const struct etimer_prof_stat *stat;
+    size_t count;
+    int i;
+
+    // 16 bit counter, sections crossing the wrap
+    etimer_prof_set_clock(test_prof_read, 0xFFFF);
+    for (i = 0; i < 3; i++)
+    {
+        test_prof_clock = 0xFFF0;
+        ETIMER_PROF_BEGIN(test_section);
+        test_prof_clock = 0xFFF0 + 0x20 * (i + 1);
+        ETIMER_PROF_END(test_section);
+    }
+    for (i = 0; i < 2; i++)
+    {
+        test_prof_clock = 0x100;
+        ETIMER_PROF_SCOPE(test_scope);
+        test_prof_clock = 0x105;
+    }
+
+    count = etimer_prof_snapshot(reports, ETIMER_PROF_MAX_SECTIONS);
+    stat = test_prof_find(reports, count, "test_section");
+    ASSERT(stat && stat->count == 3 && stat->min == 0x20 && stat->max == 0x60);
+    ASSERT(stat && stat->sum == 0xC0 && stat->sumsq == 0x400 + 0x1000 + 0x2400);
+    stat = test_prof_find(reports, count, "test_scope");
+    ASSERT(stat && stat->count == 2 && stat->min == 5 && stat->max == 5 && stat->sum == 10);
+
+    // a counter going backwards is clamped, not taken as a huge section
+    test_prof_clock = 0x100;
+    ETIMER_PROF_BEGIN(test_back);
+    test_prof_clock = 0xF0;
+    ETIMER_PROF_END(test_back);
+    count = etimer_prof_snapshot(reports, ETIMER_PROF_MAX_SECTIONS);
+    stat = test_prof_find(reports, count, "test_back");
+    ASSERT(stat && stat->count == 1 && stat->max == 0);
+
+    // overhead sections stay out of the tables
+    ASSERT(etimer_prof_overhead(16) == 0);
+    ASSERT(etimer_prof_snapshot(reports, ETIMER_PROF_MAX_SECTIONS) == count);
+
+    etimer_prof_reset();
+    count = etimer_prof_snapshot(reports, ETIMER_PROF_MAX_SECTIONS);
+    stat = test_prof_find(reports, count, "test_section");
+    ASSERT(stat && stat->count == 0);
+
+    etimer_prof_set_clock(NULL, 0);
+
+    SUITE_END();
+}
+
+void test_etimer_store(void)
+{
+    SUITE_START("test_etimer_store");
+
+    static const uint32_t max_values[] = {ETIMER_MAX_VALUE, 0xFFFF, 0xFFFFFF};
+    struct etimer_store store;
+    uint32_t handles[8], deadlines[8], got[8];
+    uint32_t d, max_value, now;
+    size_t i, n;
+    int ret;
+
+    for (d = 0; d < sizeof(max_values) / sizeof(max_values[0]); d++)
+    {
+        max_value = max_values[d];
+        now = max_value - 0x10;
+
+        ret = etimer_store_init(&store, 8, max_value, now);
+        ASSERT(ret == 0);
+
+        // deadlines around the wrap, base lagging far behind some of them
+        for (i = 0; i < 8; i++)
+        {
+            deadlines[i] = etimer_add_raw(now, (int32_t)(i * 8) - 0x18, max_value);
+            handles[i] = etimer_store_add(&store, deadlines[i]);
+            ASSERT(handles[i] == i);
+        }
+        ASSERT(etimer_store_add(&store, now) == ETIMER_STORE_NONE);
+        etimer_store_get_batch(&store, handles, 8, got);
+        ASSERT(memcmp(got, deadlines, sizeof(got)) == 0);
+
+        // due at now - 0x18, -0x10, -0x8 and now
+        n = etimer_store_expired(&store, now, got, 8);
+        ASSERT(n == 4 && got[0] == 0 && got[3] == 3);
+
+        // one step moves everything, back and forth
+        etimer_store_step(&store, 0x20);
+        for (i = 0; i < 8; i++)
+        {
+            ASSERT(etimer_store_get(&store, handles[i]) ==
+                   etimer_add_raw(deadlines[i], 0x20, max_value));
+        }
+        ASSERT(etimer_store_expired(&store, now, got, 8) == 0);
+        etimer_store_step(&store, -0x30);
+        for (i = 0; i < 8; i++)
+        {
+            ASSERT(etimer_store_get(&store, handles[i]) ==
+                   etimer_add_raw(deadlines[i], (int32_t)(max_value - 0xF), max_value));
+        }
+        ASSERT(etimer_store_expired(&store, now, got, 8) == 6);
+
+        // counter reset: old now is 5 on the new counter
+        etimer_store_step(&store, 0x10);
+        etimer_store_remap(&store, now, 5);
+        ASSERT(etimer_store_get(&store, handles[3]) == 5);
+        ASSERT(etimer_store_get(&store, handles[0]) == etimer_add_raw(5, -0x18, max_value));
+        ASSERT(etimer_store_expired(&store, 5, got, 8) == 4);
+
+        // shift a subset only
+        etimer_store_shift(&store, handles, 2, 0x100);
+        ASSERT(etimer_store_get(&store, handles[0]) == etimer_add_raw(5, 0x100 - 0x18, max_value));
+        ASSERT(etimer_store_get(&store, handles[2]) == etimer_add_raw(5, -0x8, max_value));
+        ASSERT(etimer_store_expired(&store, 5, got, 8) == 2);
+
+        // handles are reused
+        etimer_store_remove(&store, handles[2]);
+        etimer_store_remove(&store, handles[2]);
+        ASSERT(store.count == 7);
+        ASSERT(etimer_store_expired(&store, 5, got, 8) == 1);
+        ASSERT(etimer_store_add(&store, 7) == handles[2]);
+        ASSERT(etimer_store_get(&store, handles[2]) == 7);
+
+        etimer_store_deinit(&store);
+    }
+
+    SUITE_END();
+}
+
+void test_etimer_jitter(void)
+{
+    SUITE_START("test_etimer_jitter");
+
+    static uint32_t times[1000];
+    static uint16_t times16[1000];
+    static uint64_t outliers[64];
+    static const size_t chunks[] = {1, 7, 300, 0, 2, 450, 240};
+    struct etimer_jitter jitter;
+    struct etimer_jitter_result res;
+    uint64_t ref_outliers[64];
+    size_t ref_count = 0, i, c, pos;
+    int32_t ref_min = INT32_MAX, ref_max = INT32_MIN, delta;
+    int64_t ref_sum = 0;
+    double ref_sumsq = 0;
+
+    // 1 kHz on a 1 MHz counter wrapping mid capture, with a few late samples
+    times[0] = 0xFFFFFFFF - 500 * 1000;
+    for (i = 1; i < 1000; i++)
+    {
+        times[i] = times[i - 1] + 1000 + test_rand() % 11 - 5 + (i % 97 == 0 ? 200 : 0);
+        times16[i] = (uint16_t)times[i];
+        delta = etimer_sub(times[i], times[i - 1]);
+        ref_min = delta < ref_min ? delta : ref_min;
+        ref_max = delta > ref_max ? delta : ref_max;
+        ref_sum += delta - 1000;
+        ref_sumsq += (double)(delta - 1000) * (delta - 1000);
+        if (delta - 1000 > 50 || delta - 1000 < -50)
+        {
+            ref_outliers[ref_count++] = i;
+        }
+    }
+    times16[0] = (uint16_t)times[0];
+
+    // same result whatever the chunking, for both widths
+    for (int w = 0; w < 2; w++)
+    {
+        etimer_jitter_init(&jitter, 1000, 50, outliers, 64);
+        for (c = 0, pos = 0; c < sizeof(chunks) / sizeof(chunks[0]); pos += chunks[c++])
+        {
+            if (w == 0)
+            {
+                etimer_jitter_feed(&jitter, times + pos, chunks[c]);
+            }
+            else
+            {
+                etimer16_jitter_feed(&jitter, times16 + pos, chunks[c]);
+            }
+        }
+        etimer_jitter_result(&jitter, &res);
+
+        ASSERT(res.intervals == 999);
+        ASSERT(res.min == ref_min && res.max == ref_max);
+        ASSERT(res.mean_err * 999 > ref_sum - 0.5 && res.mean_err * 999 < ref_sum + 0.5);
+        ASSERT(res.rms_err * res.rms_err * 999 > ref_sumsq * 0.999999 &&
+               res.rms_err * res.rms_err * 999 < ref_sumsq * 1.000001);
+        ASSERT(res.outliers == ref_count && ref_count == 10);
+        ASSERT(memcmp(outliers, ref_outliers, ref_count * sizeof(outliers[0])) == 0);
+    }
+
+    // outliers beyond the cap are only counted
+    etimer_jitter_init(&jitter, 1000, 0, outliers, 4);
+    etimer_jitter_feed(&jitter, times, 1000);
+    etimer_jitter_result(&jitter, &res);
+    ASSERT(res.outliers > 4 && outliers[0] >= 1);
+    ASSERT(outliers[0] < outliers[1] && outliers[1] < outliers[2] && outliers[2] < outliers[3]);
+
+    etimer_jitter_init(&jitter, 1000, 0, NULL, 0);
+    etimer_jitter_feed(&jitter, times, 1);
+    etimer_jitter_result(&jitter, &res);
+    ASSERT(res.intervals == 0 && res.min == 0);
+
+    SUITE_END();
+}
+
+void test_etimer_queue(void)
+{
+    SUITE_START("test_etimer_queue");
+
+    struct etimer_queue queue;
+    struct etimer_queue_req reqs[8];
+    uint32_t round, i;
+    size_t n;
+
+    ASSERT(etimer_queue_init(&queue, 6) == -EINVAL);
+    ASSERT(etimer_queue_init(&queue, 4) == 0);
+
+    // several laps, tail wrapping its 32-bit position too
+    queue.tail = queue.head = 0xFFFFFFF8;
+    for (round = 0; round < 4; round++)
+    {
+        for (i = 0; i < 4; i++)
+        {
+            ASSERT(etimer_queue_push(&queue, ETIMER_QUEUE_ARM, round * 4 + i, 0xFFFFFFF0 + i) == 0);
+        }
+        ASSERT(etimer_queue_push(&queue, ETIMER_QUEUE_CANCEL, 99, 0) == -EAGAIN);
+
+        n = etimer_queue_drain(&queue, reqs, 3);
+        ASSERT(n == 3 && reqs[0].handle == round * 4 && reqs[2].deadline == 0xFFFFFFF2);
+        ASSERT(etimer_queue_push(&queue, ETIMER_QUEUE_CANCEL, round * 4, 0) == 0);
+
+        n = etimer_queue_drain(&queue, reqs, 8);
+        ASSERT(n == 2 && reqs[0].handle == round * 4 + 3);
+        ASSERT(reqs[1].op == ETIMER_QUEUE_CANCEL && reqs[1].handle == round * 4);
+        ASSERT(etimer_queue_drain(&queue, reqs, 8) == 0);
+    }
+
+    // a claimed but unpublished slot stops the batch until it is published
+    queue.tail++;
+    __atomic_sub_fetch(&queue.space, 1, __ATOMIC_RELAXED);
+    ASSERT(etimer_queue_push(&queue, ETIMER_QUEUE_ARM, 7, 70) == 0);
+    ASSERT(etimer_queue_drain(&queue, reqs, 8) == 0);
+    queue.slots[(queue.tail - 2) & queue.mask].req.handle = 6;
+    __atomic_store_n(&queue.slots[(queue.tail - 2) & queue.mask].seq, queue.tail - 1,
+                     __ATOMIC_RELEASE);
+    n = etimer_queue_drain(&queue, reqs, 8);
+    ASSERT(n == 2 && reqs[0].handle == 6 && reqs[1].handle == 7);
+
+    etimer_queue_deinit(&queue);
+
+    SUITE_END();
+}
+
+void test_etimer_sorted(void)
+{
+    SUITE_START("test_etimer_sorted");
+
+    static const uint32_t max_values[] = {ETIMER_MAX_VALUE, 0xFFFF};
+    static struct etimer_sorted_entry batch[600];
+    static uint32_t handles[600];
+    struct etimer_sorted sorted;
+    uint32_t d, i, now, max_value, deadline, prev;
+    size_t n, total;
+    int ok;
+
+    // a batch larger than capacity cannot hold unique handles
+    ASSERT(etimer_sorted_init(&sorted, 2, ETIMER_MAX_VALUE) == 0);
+    batch[0].handle = 0;
+    batch[1].handle = 1;
+    batch[2].handle = 1;
+    ASSERT(etimer_sorted_arm(&sorted, 0, batch, 3) == -EINVAL);
+    ASSERT(etimer_sorted_count(&sorted) == 0);
+    etimer_sorted_deinit(&sorted);
+
+    for (d = 0; d < 2; d++)
+    {
+        max_value = max_values[d];
+        now = max_value - 300;
+        ASSERT(etimer_sorted_init(&sorted, 600, max_value) == 0);
+
+        // small batch, then a radix sorted one, both spanning the wrap
+        for (i = 0; i < 20; i++)
+        {
+            batch[i].handle = i;
+            batch[i].deadline = etimer_add_raw(now, (int32_t)(test_rand() % 600), max_value);
+        }
+        ASSERT(etimer_sorted_arm(&sorted, now, batch, 20) == 0);
+        for (i = 0; i < 500; i++)
+        {
+            batch[i].handle = 20 + i;
+            batch[i].deadline = etimer_add_raw(now, (int32_t)(test_rand() % 600), max_value);
+        }
+        ASSERT(etimer_sorted_arm(&sorted, now, batch, 500) == 0);
+        ASSERT(etimer_sorted_count(&sorted) == 520);
+
+        // re-arm a few, cancel others, some twice
+        batch[0].handle = 5;
+        batch[0].deadline = now;
+        batch[1].handle = 300;
+        batch[1].deadline = etimer_add_raw(now, 599, max_value);
+        ASSERT(etimer_sorted_arm(&sorted, now, batch, 2) == 0);
+        ASSERT(etimer_sorted_next(&sorted, &deadline) && deadline == now);
+        handles[0] = 7;
+        handles[1] = 400;
+        handles[2] = 7;
+        handles[3] = 1000;
+        ASSERT(etimer_sorted_cancel(&sorted, handles, 4) == 2);
+        ASSERT(etimer_sorted_count(&sorted) == 518);
+
+        // expiry in wrapped deadline order through the wrap
+        total = 0;
+        prev = now;
+        ok = 1;
+        for (i = 0; i <= 600; i += 50)
+        {
+            uint32_t t = etimer_add_raw(now, (int32_t)i, max_value);
+            n = etimer_sorted_expire(&sorted, t, handles, 600);
+            for (size_t j = 0; j < n; j++)
+            {
+                ok &= handles[j] != 7 && handles[j] != 400;
+                ok &= (sorted.gen[handles[j]] & 1) == 0;
+            }
+            if (n)
+            {
+                // the last one taken is not after t, the next pending one is
+                ok &= etimer_sub_raw(prev, t, max_value >> 1, max_value) <= 0;
+                prev = t;
+            }
+            if (etimer_sorted_next(&sorted, &deadline))
+            {
+                ok &= etimer_sub_raw(deadline, t, max_value >> 1, max_value) > 0;
+            }
+            total += n;
+        }
+        ASSERT(ok && total == 518 && sorted.size == 0 && sorted.stage_size == 0);
+        ASSERT(sorted.head == 0);
+        ASSERT(etimer_sorted_expire(&sorted, now, handles, 600) == 0);
+
+        // order inside the array
+        for (i = 0; i < 300; i++)
+        {
+            batch[i].handle = i;
+            batch[i].deadline = etimer_add_raw(now, (int32_t)(test_rand() % 600), max_value);
+        }
+        etimer_sorted_arm(&sorted, now, batch, 300);
+        etimer_sorted_arm(&sorted, now, batch + 150, 150);
+        ok = etimer_sorted_count(&sorted) == 300;
+        for (i = sorted.head + 1; i < sorted.head + sorted.size; i++)
+        {
+            ok &= etimer_sub_raw(sorted.slots[i - 1].deadline, sorted.slots[i].deadline,
+                                 max_value >> 1, max_value) <= 0;
+        }
+        ASSERT(ok);
+
+        // single arms inside the array are staged, then merged as one batch
+        for (i = 300; i < 360; i++)
+        {
+            batch[0].handle = i;
+            batch[0].deadline = etimer_add_raw(now, (int32_t)(i == 300 ? 1 : test_rand() % 600),
+                                               max_value);
+            etimer_sorted_arm(&sorted, now, batch, 1);
+            ok &= i != 300 || sorted.stage_size == 1;
+        }
+        ASSERT(ok && sorted.stage_size > 0 && sorted.size > 300);
+        handles[0] = 359;
+        ASSERT(etimer_sorted_cancel(&sorted, handles, 1) == 1);
+        batch[0].handle = 358;
+        batch[0].deadline = now;
+        etimer_sorted_arm(&sorted, now, batch, 1);
+        total = 0;
+        prev = now;
+        for (i = 0; i <= 600; i++)
+        {
+            uint32_t t = etimer_add_raw(now, (int32_t)i, max_value);
+            n = etimer_sorted_expire(&sorted, t, handles, 600);
+            for (size_t j = 0; j < n; j++)
+            {
+                ok &= handles[j] != 359;
+            }
+            if (etimer_sorted_next(&sorted, &deadline))
+            {
+                ok &= etimer_sub_raw(deadline, prev, max_value >> 1, max_value) >= 0;
+                ok &= etimer_sub_raw(deadline, t, max_value >> 1, max_value) > 0;
+                prev = deadline;
+            }
+            total += n;
+        }
+        ASSERT(ok && total == 359 && sorted.size == 0 && sorted.stage_size == 0);
+
+        batch[0].handle = 600;
+        ASSERT(etimer_sorted_arm(&sorted, now, batch, 1) == -EINVAL);
+        etimer_sorted_deinit(&sorted);
+    }
+
+    SUITE_END();
+}
+
+//
+// Simulated hardware for test_etimer_clock: a narrow counter driven by a 64-bit tick count. Its
+// overflow interrupt may fire at any hardware access, including in the middle of a read, and
+// higher priority readers run in the middle of the interrupt.
+//
+static struct etimer_clock test_clock;
+static uint64_t test_clock_ticks;
+static int test_clock_flag;
+static int test_clock_in_isr;
+static int test_clock_immediate; /* interrupt taken right at the wrap, no pending callback */
+static uint32_t test_clock_overflows;
+static int test_clock_ok;
+
+static void test_clock_isr(void)
+{
+    if (test_clock_flag && !test_clock_in_isr && (test_clock_immediate || test_rand() % 2))
+    {
+        test_clock_in_isr = 1;
+        test_clock_overflows++;
+        etimer_clock_overflow(&test_clock);
+        test_clock_in_isr = 0;
+    }
+}
+
+static void test_clock_tick(void)
+{
+    uint64_t before = test_clock_ticks;
+    uint32_t shift = test_clock.shift;
+
+    // often jump right before the next wrap, never past a wrap not handled yet
+    if (!test_clock_flag && !test_clock_in_isr && test_rand() % 8 == 0)
+    {
+        test_clock_ticks = (((test_clock_ticks >> shift) + 1) << shift) - 1 - test_rand() % 3;
+        test_clock_ticks = test_clock_ticks < before ? before : test_clock_ticks;
+    }
+    else
+    {
+        test_clock_ticks += test_rand() % 3;
+    }
+
+    if ((before >> shift) != (test_clock_ticks >> shift))
+    {
+        test_clock_flag = 1;
+        if (test_clock_immediate)
+        {
+            test_clock_isr();
+        }
+    }
+}
+
+static void test_clock_check(void)
+{
+    uint32_t before = (uint32_t)test_clock_ticks;
+    uint32_t now = etimer_clock_read(&test_clock);
+    uint32_t after = (uint32_t)test_clock_ticks;
+
+    test_clock_ok &= etimer_sub(now, before) >= 0 && etimer_sub(after, now) >= 0;
+}
+
+static uint32_t test_clock_read(void)
+{
+    uint32_t hw;
+
+    test_clock_isr();
+    hw = (uint32_t)test_clock_ticks & test_clock.max_value;
+    test_clock_tick();
+    test_clock_isr();
+    return hw;
+}
+
+static int test_clock_pending(void)
+{
+    int flag;
+
+    test_clock_isr();
+    flag = test_clock_flag;
+    test_clock_tick();
+    test_clock_isr();
+    return flag;
+}
+
+static void test_clock_clear(void)
+{
+    test_clock_check();
+    test_clock_flag = 0;
+    test_clock_check();
+}
+
+void test_etimer_clock(void)
+{
+    SUITE_START("test_etimer_clock");
+
+    static const uint32_t max_values[] = {0xFF, 0xFFFF, 0xFFFFFF};
+    uint32_t d, mode, i;
+
+    ASSERT(etimer_clock_init(&test_clock, 0x1FE, test_clock_read, NULL, NULL) == -EINVAL);
+    ASSERT(etimer_clock_init(&test_clock, 0, test_clock_read, NULL, NULL) == -EINVAL);
+
+    for (d = 0; d < 3; d++)
+    {
+        // mode 0 with the overflow flag, mode 1 without it
+        for (mode = 0; mode < 2; mode++)
+        {
+            ASSERT(etimer_clock_init(&test_clock, max_values[d], test_clock_read,
+                                     mode ? NULL : test_clock_pending, test_clock_clear) == 0);
+            ASSERT(test_clock.shift == 8 * (d + 1));
+
+            // start a few periods before the 32-bit wrap
+            test_clock_ticks = 0xFFFFFFFFull - 3ull * (max_values[d] + 1) + 7;
+            test_clock.seq = (uint32_t)(test_clock_ticks >> test_clock.shift) << 1;
+            test_clock_flag = 0;
+            test_clock_immediate = mode;
+            test_clock_overflows = 0;
+            test_clock_ok = 1;
+
+            for (i = 0; i < 20000; i++)
+            {
+                test_clock_check();
+                if (test_rand() % 4 == 0)
+                {
+                    test_clock_tick();
+                }
+                test_clock_isr();
+            }
+            ASSERT(test_clock_ok);
+            ASSERT(test_clock_overflows > 500 && test_clock_ticks > 0xFFFFFFFFull);
+        }
+    }
+
+    SUITE_END();
+}
+
+static uint32_t test_edf_now;
+static uint32_t test_edf_cost;
+
+static void test_edf_job(struct etimer_edf_task *task, void *arg)
+{
+    (void)task;
+    (void)arg;
+    test_edf_now += test_edf_cost;
+}
+
+static uint32_t test_edf_clock(void)
+{
+    return test_edf_now;
+}
+
+/**
+ * @brief  Run the scheduler in virtual time, each job taking its budget times cost, and check
+ * that every job starts after its release with the earliest deadline among the ready ones.
+ * @return resulting 1 means every decision was EDF.
+ */
+static int test_edf_simulate(struct etimer_edf *edf, uint32_t *now, uint32_t cost,
+                             uint32_t decisions)
+{
+    struct etimer_edf_task *task;
+    uint32_t i, k, release;
+    int ok = 1;
+
+    for (i = 0; i < decisions; i++)
+    {
+        task = etimer_edf_next(edf, *now);
+        if (task == NULL)
+        {
+            ok &= etimer_edf_wakeup(edf, &release);
+            *now = release;
+            continue;
+        }
+        ok &= etimer_sub_raw(*now, task->release, edf->overflow, edf->max_value) >= 0;
+        for (k = 0; k < edf->ready.size; k++)
+        {
+            ok &= etimer_sub_raw(edf->ready.entries[k].key, task->due, edf->overflow,
+                                 edf->max_value) >= 0;
+        }
+        *now = etimer_add_raw(*now, (int32_t)(task->budget * cost), edf->max_value);
+        etimer_edf_done(edf, task, *now);
+    }
+
+    return ok;
+}
+
+void test_etimer_edf(void)
+{
+    SUITE_START("test_etimer_edf");
+
+    struct etimer_edf edf;
+    struct etimer_edf_task tasks[4], *task;
+    uint32_t now, i;
+
+    // admission
+    ASSERT(etimer_edf_init(&edf, 3, 0xFFFE, 1000, 0) == -EINVAL);
+    ASSERT(etimer_edf_init(&edf, 3, 0xFFFF, 1000, 0) == 0);
+    etimer_edf_task_init(&tasks[0], 10, 0, 10, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == -EINVAL);
+    etimer_edf_task_init(&tasks[0], 10, 11, 11, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == -EBUSY);
+    etimer_edf_task_init(&tasks[0], 10, 6, 5, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == -EINVAL);
+    etimer_edf_task_init(&tasks[0], 0x4000, 1, 10, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == -EINVAL);
+
+    etimer_edf_task_init(&tasks[0], 10, 5, 10, test_edf_job, NULL);
+    etimer_edf_task_init(&tasks[1], 40, 5, 10, test_edf_job, NULL);
+    etimer_edf_task_init(&tasks[2], 100, 1, 100, test_edf_job, NULL);
+    etimer_edf_task_init(&tasks[3], 100, 1, 100, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == 0);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == -EBUSY && edf.ready.size == 1);
+    ASSERT(etimer_edf_admit(&edf, &tasks[1], 0) == 0);
+    ASSERT(etimer_edf_admit(&edf, &tasks[2], 0) == -EBUSY);
+    etimer_edf_remove(&edf, &tasks[1]);
+    ASSERT(tasks[1].state == ETIMER_EDF_IDLE && edf.ready.size == 1);
+    ASSERT(etimer_edf_admit(&edf, &tasks[2], 0) == 0);
+    ASSERT(etimer_edf_admit(&edf, &tasks[1], 0) == -EBUSY);
+    ASSERT(etimer_edf_admit(&edf, &tasks[3], 0) == 0);
+    etimer_edf_task_init(&tasks[1], 1000, 1, 1000, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[1], 0) == -ENOSPC);
+    etimer_edf_deinit(&edf);
+
+    // a job late by more than half the range still runs before one due ahead
+    ASSERT(etimer_edf_init(&edf, 2, ETIMER_MAX_VALUE, 1000, 0xFFFFFF00) == 0);
+    etimer_edf_task_init(&tasks[0], 0x3FFFFFFF, 1, 100, test_edf_job, NULL);
+    etimer_edf_task_init(&tasks[1], 0x3FFFFFFF, 1, 0x3FFFFFFF, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0xFFFFFF00) == 0);
+    now = 0xFFFFFF00 + 0x48000000;
+    ASSERT(etimer_edf_next(&edf, now) == &tasks[0]);
+    ASSERT(etimer_edf_admit(&edf, &tasks[1], now) == 0);
+    ASSERT(!etimer_past(tasks[0].due, tasks[1].due));
+    ASSERT(etimer_edf_next(&edf, now) == &tasks[0]);
+    etimer_edf_done(&edf, &tasks[0], now);
+    ASSERT(tasks[0].misses == 1 && tasks[0].late_max == 0x48000000 - 100);
+    // the next release is already past, still late and still first
+    ASSERT(etimer_edf_next(&edf, now) == &tasks[0]);
+    etimer_edf_done(&edf, &tasks[0], now);
+    ASSERT(tasks[0].misses == 2 && tasks[0].state == ETIMER_EDF_SLEEP);
+    ASSERT(etimer_edf_next(&edf, now) == &tasks[1]);
+    etimer_edf_done(&edf, &tasks[1], now + 1);
+    ASSERT(tasks[1].misses == 0 && edf.misses == 2 && edf.jobs == 3);
+    etimer_edf_deinit(&edf);
+
+    // periodic tasks across the wrap of narrow domains, EDF order and no misses up to 100%
+    static const uint32_t max_values[] = {0xFFFF, 0xFFFFFF, ETIMER_MAX_VALUE};
+    for (i = 0; i < 3; i++)
+    {
+        now = max_values[i] - 500;
+        ASSERT(etimer_edf_init(&edf, 4, max_values[i], 1000, now) == 0);
+        etimer_edf_task_init(&tasks[0], 8, 2, 8, test_edf_job, NULL);
+        etimer_edf_task_init(&tasks[1], 12, 3, 6, test_edf_job, NULL);
+        etimer_edf_task_init(&tasks[2], 40, 5, 40, test_edf_job, NULL);
+        ASSERT(etimer_edf_admit(&edf, &tasks[0], now) == 0);
+        ASSERT(etimer_edf_admit(&edf, &tasks[1], now) == 0);
+        ASSERT(etimer_edf_admit(&edf, &tasks[2], now) == 0);
+        ASSERT(test_edf_simulate(&edf, &now, 1, 3000));
+        ASSERT(now < 0x10000);
+        ASSERT(edf.misses == 0 && edf.late_max <= 0);
+        ASSERT(tasks[0].jobs * 8 + 16 > tasks[1].jobs * 12 &&
+               tasks[0].jobs * 8 < tasks[1].jobs * 12 + 16);
+        ASSERT(tasks[0].jobs * 8 + 80 > tasks[2].jobs * 40 &&
+               tasks[0].jobs * 8 < tasks[2].jobs * 40 + 80);
+
+        // overrun every job by half, misses are counted and the order stays EDF
+        ASSERT(test_edf_simulate(&edf, &now, 2, 1000));
+        ASSERT(edf.misses > 0 && edf.late_max > 0);
+        ASSERT(edf.misses == tasks[0].misses + tasks[1].misses + tasks[2].misses);
+        etimer_edf_deinit(&edf);
+    }
+
+    // run through the clock and job function
+    test_edf_now = 0xFFF0;
+    ASSERT(etimer_edf_init(&edf, 1, 0xFFFF, 1000, test_edf_now) == 0);
+    etimer_edf_task_init(&tasks[0], 10, 4, 10, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], test_edf_now) == 0);
+    test_edf_cost = 4;
+    ASSERT(etimer_edf_run(&edf, test_edf_clock) == 1);
+    ASSERT(etimer_edf_run(&edf, test_edf_clock) == 0);
+    ASSERT(etimer_edf_wakeup(&edf, &now) && now == 0xFFFA);
+    test_edf_now = now;
+    test_edf_cost = 12;
+    ASSERT(etimer_edf_run(&edf, test_edf_clock) == 1);
+    ASSERT(tasks[0].jobs == 2 && tasks[0].misses == 1 && tasks[0].late_max == 2);
+    task = etimer_edf_next(&edf, test_edf_now);
+    ASSERT(task == &tasks[0] && task->due == 0x0E);
+    etimer_edf_remove(&edf, task);
+    ASSERT(etimer_edf_next(&edf, test_edf_now) == NULL && edf.density == 0);
+    etimer_edf_deinit(&edf);
+
+    // not polled for over half the range, a ready and a sleeping task restart at the new now
+    ASSERT(etimer_edf_init(&edf, 2, 0xFFFF, 1000, 0) == 0);
+    etimer_edf_task_init(&tasks[0], 100, 5, 100, test_edf_job, NULL);
+    etimer_edf_task_init(&tasks[1], 100, 5, 100, test_edf_job, NULL);
+    ASSERT(etimer_edf_admit(&edf, &tasks[0], 0) == 0);
+    ASSERT(etimer_edf_admit(&edf, &tasks[1], 0) == 0);
+    task = etimer_edf_next(&edf, 0);
+    etimer_edf_done(&edf, task, 5);
+    ASSERT(task->state == ETIMER_EDF_SLEEP);
+    ASSERT(etimer_edf_next(&edf, 2) != task); // stale reading, ignored
+    ASSERT(edf.now == 5);
+    ASSERT(etimer_edf_next(&edf, 0x9000) != task && edf.now == 0x9000);
+    ASSERT(task->state == ETIMER_EDF_READY && task->release == 0x9000);
+    etimer_edf_done(&edf, etimer_edf_next(&edf, 0x9000), 0x9005);
+    ASSERT(edf.misses == 1 && edf.ready.size == 1 && etimer_edf_next(&edf, 0x9005) == task);
+    etimer_edf_deinit(&edf);
+
+    SUITE_END();
+}
+
+void test_etimer_idle(void)
+{
+    SUITE_START("test_etimer_idle");
+
+    static uint32_t ref_last[64];
+    static uint8_t ref_open[64], ref_busy[64];
+    struct etimer_idle idle;
+    uint32_t handles[64], now, h, i, k, step, expired = 0, ok = 1;
+    size_t n;
+
+    ASSERT(etimer_idle_init(&idle, 8, 0, 1, 0) == -EINVAL);
+    ASSERT(etimer_idle_init(&idle, 8, 100, 200, 0) == -EINVAL);
+    ASSERT(etimer_idle_init(&idle, 8, ETIMER_MAX_VALUE_OVERFLOW / 2, 1, 0) == -EINVAL);
+
+    // full, reuse after remove
+    ASSERT(etimer_idle_init(&idle, 2, 100, 10, 0) == 0);
+    ASSERT(idle.shift == 4);
+    ASSERT(etimer_idle_add(&idle, 0) == 0);
+    ASSERT(etimer_idle_add(&idle, 0) == 1);
+    ASSERT(etimer_idle_add(&idle, 0) == ETIMER_IDLE_NONE);
+    etimer_idle_remove(&idle, 0);
+    etimer_idle_remove(&idle, 0);
+    ASSERT(idle.count == 1);
+    ASSERT(etimer_idle_add(&idle, 5) == 0);
+    ASSERT(etimer_idle_expire(&idle, 99, handles, 64) == 0);
+    etimer_idle_touch(&idle, 0, 50);
+    ASSERT(etimer_idle_ticks(&idle, 0, 60) == 10);
+    ASSERT(etimer_idle_expire(&idle, 120, handles, 64) == 1 && handles[0] == 1);
+    ASSERT(etimer_idle_expire(&idle, 149, handles, 64) == 0);
+    ASSERT(etimer_idle_expire(&idle, 160, handles, 64) == 1 && handles[0] == 0);
+    ASSERT(idle.count == 0);
+    etimer_idle_deinit(&idle);
+
+    // a partial expire resumes in the same slot, a long pause is one lap
+    ASSERT(etimer_idle_init(&idle, 64, 1000, 16, 0xFFFFFF00) == 0);
+    for (i = 0; i < 64; i++)
+    {
+        ASSERT(etimer_idle_add(&idle, 0xFFFFFF00) == i);
+    }
+    ASSERT(etimer_idle_expire(&idle, 0xFFFFFF00 + 1040, handles, 10) == 10);
+    ASSERT(etimer_idle_expire(&idle, 0xFFFFFF00 + 1040, handles + 10, 54) == 54);
+    for (i = 0; i < 64; i++)
+    {
+        ok &= idle.conns[i].prev == ETIMER_IDLE_NONE;
+    }
+    ASSERT(ok && idle.count == 0);
+    for (i = 0; i < 64; i++)
+    {
+        ok &= etimer_idle_add(&idle, 0x100) != ETIMER_IDLE_NONE;
+    }
+    ASSERT(ok && etimer_idle_add(&idle, 0x100) == ETIMER_IDLE_NONE);
+    ASSERT(etimer_idle_expire(&idle, 0x100 + 0x10000000, handles, 64) == 64);
+    etimer_idle_deinit(&idle);
+
+    // random traffic across the 32-bit wrap against a model
+    ASSERT(etimer_idle_init(&idle, 64, 1000, 16, 0xFFFF0000) == 0);
+    now = 0xFFFF0000;
+    memset(ref_open, 0, sizeof(ref_open));
+    for (step = 0; step < 200000; step++)
+    {
+        now += 1 + test_rand() % 8;
+        k = test_rand() % 64;
+        if (!ref_open[k] && test_rand() % 4 == 0)
+        {
+            h = etimer_idle_add(&idle, now);
+            ok &= h != ETIMER_IDLE_NONE && !ref_open[h];
+            ref_open[h] = 1;
+            ref_busy[h] = test_rand() % 2;
+            ref_last[h] = now;
+        }
+        else if (ref_open[k] && test_rand() % 512 == 0)
+        {
+            etimer_idle_remove(&idle, k);
+            ref_open[k] = 0;
+        }
+        for (i = 0; i < 64; i++)
+        {
+            if (ref_open[i] && ref_busy[i] && test_rand() % 64 == 0)
+            {
+                etimer_idle_touch(&idle, i, now);
+                ref_last[i] = now;
+            }
+        }
+
+        n = etimer_idle_expire(&idle, now, handles, 64);
+        for (i = 0; i < n; i++)
+        {
+            h = handles[i];
+            ok &= ref_open[h] && now - ref_last[h] >= 1000;
+            ref_open[h] = 0;
+        }
+        expired += n;
+        for (i = 0; i < 64; i++)
+        {
+            // one granule late at most, plus the step
+            ok &= !ref_open[i] || now - ref_last[i] < 1000 + 16 + 8;
+        }
+    }
+    ASSERT(ok);
+    ASSERT(expired > 1000 && now < 0xFFFF0000);
+    etimer_idle_deinit(&idle);
+
+    SUITE_END();
+}
+
+void test_etimer_lift(void)
+{
+    SUITE_START("test_etimer_lift");
+
+    static const uint32_t refs[] = {0, 0x7FFF, 0x8000, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000,
+                                    0xFFFF8000, 0xFFFFFFF0, 0xFFFFFFFF};
+    static uint32_t narrow[80], out[80];
+    static uint16_t narrow16[80];
+    uint32_t bits, max_value, ref, lifted, r, i, ok = 1;
+    size_t n, off;
+    int32_t diff;
+
+    ASSERT(etimer_lift_raw(narrow, 4, 0, 0xFFFE, out) == -EINVAL);
+    ASSERT(etimer_lift_raw(narrow, 4, 0, 0, out) == -EINVAL);
+    ASSERT(etimer16_lift_raw(narrow16, 4, 0, 0x0FFE, out) == -EINVAL);
+
+    // single values: nearest to the reference, same as etimer_sub_raw
+    ASSERT(etimer_lift_one(0xFFF0, 0x00010005, 0xFFFF) == 0x0000FFF0);
+    ASSERT(etimer_lift_one(0x0005, 0x0001FFF0, 0xFFFF) == 0x00020005);
+    ASSERT(etimer_lift_one(0x0005, 0xFFFFFFF0, 0xFFFF) == 0x00000005);
+    ASSERT(etimer_lift_one(0x8000, 0x00010000, 0xFFFF) == 0x00008000);
+    ASSERT(etimer_lift_one(0x7FFF, 0x00010000, 0xFFFF) == 0x00017FFF);
+    ASSERT(etimer_lift_one(0x12345678, 0xFFFFFFFF, ETIMER_MAX_VALUE) == 0x12345678);
+    for (bits = 1; bits <= 32; bits++)
+    {
+        max_value = bits == 32 ? ETIMER_MAX_VALUE : (1u << bits) - 1;
+        for (i = 0; i < 2000; i++)
+        {
+            ref = i < 10 ? refs[i] : test_rand();
+            r = test_rand() & max_value;
+            lifted = etimer_lift_one(r, ref, max_value);
+            diff = (int32_t)(lifted - ref);
+            ok &= (lifted & max_value) == r;
+            if (diff == -(int32_t)(max_value >> 1) - 1)
+            {
+                // half the range, always past
+                ok &= ((r - ref) & max_value) == (max_value >> 1) + 1;
+                continue;
+            }
+            ok &= diff == etimer_sub_raw(r, ref & max_value, max_value >> 1, max_value);
+        }
+    }
+    ASSERT(ok);
+
+    // vector paths against the scalar one, all widths, lengths and alignments
+    for (bits = 1; bits <= 32; bits++)
+    {
+        max_value = bits == 32 ? ETIMER_MAX_VALUE : (1u << bits) - 1;
+        for (n = 0; n < 70; n += 1 + n / 8)
+        {
+            for (off = 0; off < 4; off++)
+            {
+                ref = (n + off) % 3 ? test_rand() : refs[(n + off) % 10];
+                for (i = 0; i < n; i++)
+                {
+                    narrow[off + i] = test_rand() & max_value;
+                    narrow16[off + i] = (uint16_t)(test_rand() & max_value);
+                }
+                ok &= etimer_lift_raw(narrow + off, n, ref, max_value, out + off) == 0;
+                for (i = 0; i < n; i++)
+                {
+                    ok &= out[off + i] == etimer_lift_one(narrow[off + i], ref, max_value);
+                }
+                if (bits > 16)
+                {
+                    continue;
+                }
+                ok &= etimer16_lift_raw(narrow16 + off, n, ref, (uint16_t)max_value,
+                                        out + off) == 0;
+                for (i = 0; i < n; i++)
+                {
+                    ok &= out[off + i] == etimer_lift_one(narrow16[off + i], ref, max_value);
+                }
+            }
+        }
+    }
+    ASSERT(ok);
+
+    // in place, and etimer16 times against etimer16_sub
+    for (i = 0; i < 64; i++)
+    {
+        narrow[i] = (uint16_t)(0xFFC0 + i * 3);
+        narrow16[i] = (uint16_t)narrow[i];
+    }
+    etimer16_lift(narrow16, 64, 0x1FFF0, out);
+    ASSERT(etimer_lift_raw(narrow, 64, 0x1FFF0, 0xFFFF, narrow) == 0);
+    for (i = 0; i < 64; i++)
+    {
+        ok &= out[i] == narrow[i];
+        ok &= (int32_t)(out[i] - 0x1FFF0) == etimer16_sub(narrow16[i], 0xFFF0);
+    }
+    ASSERT(ok);
+
+    SUITE_END();
+}
+
+void test_etimer_earliest(void)
+{
+    SUITE_START("test_etimer_earliest");
+
+    static struct etimer_earliest reg;
+    struct etimer_earliest_shards set;
+    uint32_t now, deadline, model, i, shard, ok = 1;
+    int32_t rel;
+    int held;
+
+    etimer_earliest_init(&reg);
+    ASSERT(etimer_earliest_get(&reg, 0, &deadline) == 0);
+    ASSERT(etimer_earliest_take(&reg, 0, &deadline) == 0);
+
+    // earlier relative to now across the wrap
+    now = 0xFFFFFF00;
+    ASSERT(etimer_earliest_update(&reg, 0x00000100, now) == 1);
+    ASSERT(etimer_earliest_update(&reg, 0x00000200, now) == 0);
+    ASSERT(etimer_earliest_update(&reg, 0xFFFFFFF0, now) == 1);
+    ASSERT(etimer_earliest_update(&reg, 0xFFFFFFF0, now) == 0);
+    ASSERT(etimer_earliest_get(&reg, now, &deadline) == 1 && deadline == 0xFFFFFFF0);
+    ASSERT(etimer_earliest_update(&reg, 0xFFFFFE00, now) == 1);
+    ASSERT(etimer_earliest_take(&reg, now, &deadline) == 1 && deadline == 0xFFFFFE00);
+    ASSERT(etimer_earliest_get(&reg, now, &deadline) == 0);
+
+    // a due deadline left alone is pinned, it never comes back as a future one
+    ASSERT(etimer_earliest_update(&reg, 1000, 1000) == 1);
+    for (now = 1000, i = 0; i < 20; i++)
+    {
+        now += ETIMER_EARLIEST_PIN / 2 + test_rand() % 1000;
+        ok &= etimer_earliest_get(&reg, now, &deadline) == 1;
+        ok &= etimer_sub(deadline, now) <= 0 && etimer_sub(deadline, now) >= -ETIMER_EARLIEST_PIN;
+        ok &= etimer_earliest_update(&reg, now + 10, now) == 0;
+    }
+    ASSERT(ok);
+    ASSERT(etimer_earliest_update(&reg, now - ETIMER_EARLIEST_PIN - 5, now) == 0);
+    ASSERT(etimer_earliest_take(&reg, now, &deadline) == 1 &&
+           deadline == now - ETIMER_EARLIEST_PIN);
+
+    // against a model of the earliest deadline, now moving across the wrap
+    now = 0xFFF00000;
+    held = 0;
+    model = 0;
+    for (i = 0; i < 100000; i++)
+    {
+        now += test_rand() % 64;
+        deadline = now + test_rand() % 100000 - 1000;
+        rel = etimer_sub(deadline, now);
+        if (!held || rel < etimer_sub(model, now))
+        {
+            ok &= etimer_earliest_update(&reg, deadline, now) == 1;
+            model = deadline;
+            held = 1;
+        }
+        else
+        {
+            ok &= etimer_earliest_update(&reg, deadline, now) == 0;
+        }
+        if (test_rand() % 100 == 0)
+        {
+            ok &= etimer_earliest_take(&reg, now, &deadline) == 1 && deadline == model;
+            held = 0;
+        }
+    }
+    ASSERT(ok);
+    ASSERT(etimer_earliest_get(&reg, now, &deadline) == held && (!held || deadline == model));
+
+    // shards: the minimum of all of them
+    ASSERT(etimer_earliest_shards_init(&set, 0) == -EINVAL);
+    ASSERT(etimer_earliest_shards_init(&set, 8) == 0);
+    ASSERT(((uintptr_t)set.shards & 63) == 0);
+    ASSERT(etimer_earliest_shards_get(&set, 0, &deadline) == 0);
+    now = 0xFFFFF000;
+    model = now + 0x10000;
+    for (i = 0; i < 1000; i++)
+    {
+        shard = test_rand();
+        deadline = now + test_rand() % 0x10000;
+        etimer_earliest_shards_update(&set, shard, deadline, now);
+        model = etimer_sub(deadline, now) < etimer_sub(model, now) ? deadline : model;
+    }
+    ASSERT(etimer_earliest_shards_get(&set, now, &deadline) == 1 && deadline == model);
+    ASSERT(etimer_earliest_shards_take(&set, now, &deadline) == 1 && deadline == model);
+    ASSERT(etimer_earliest_shards_get(&set, now, &deadline) == 0);
+    etimer_earliest_shards_deinit(&set);
+
+    SUITE_END();
+}
+
+void test_etimer_bin(void)
+{
+    SUITE_START("test_etimer_bin");
+
+    static const uint32_t max_values[] = {0xFF, 0xFFF, 0xFFFF, 0xFFFFFF, ETIMER_MAX_VALUE};
+    static uint32_t times[80], index[80], counts[64], model[64];
+    static uint16_t times16[80];
+    struct etimer_bin bin;
+    uint32_t max_value, width, bins, base, t, d, i, k, expect, ok = 1;
+    size_t n, off, inside, want;
+    int32_t rel;
+
+    ASSERT(etimer_bin_init(&bin, 0, 4, 0xFFFF) == -EINVAL);
+    ASSERT(etimer_bin_init(&bin, 4, 0, 0xFFFF) == -EINVAL);
+    ASSERT(etimer_bin_init(&bin, 4, 4, 0xFFFE) == -EINVAL);
+    ASSERT(etimer_bin_init(&bin, 0x1000, 9, 0xFFFF) == -EINVAL);
+    ASSERT(etimer_bin_init(&bin, 0x1000, 8, 0xFFFF) == 0);
+    ASSERT(etimer_bin_init(&bin, 0x80000000u, 1, ETIMER_MAX_VALUE) == 0);
+
+    // across the wrap: before the base or past the window is out
+    ASSERT(etimer_bin_init(&bin, 1000, 10, ETIMER_MAX_VALUE) == 0);
+    ASSERT(etimer_bin_one(&bin, 0xFFFFFF00, 0xFFFFFF00) == 0);
+    ASSERT(etimer_bin_one(&bin, 0x00000100, 0xFFFFFF00) == 0);
+    ASSERT(etimer_bin_one(&bin, 0x000003E8, 0xFFFFFF00) == 1);
+    ASSERT(etimer_bin_one(&bin, 0x0000260F, 0xFFFFFF00) == 9);
+    ASSERT(etimer_bin_one(&bin, 0x00002611, 0xFFFFFF00) == ETIMER_BIN_NONE);
+    ASSERT(etimer_bin_one(&bin, 0xFFFFFEFF, 0xFFFFFF00) == ETIMER_BIN_NONE);
+
+    // single times against etimer_sub_raw() and a division, widths near powers of 2 included
+    for (d = 0; d < 5; d++)
+    {
+        max_value = max_values[d];
+        for (k = 0; k < 300; k++)
+        {
+            width = k < 40 ? (1u << (k / 2)) + (k % 2) * 2 - 1 : test_rand();
+            width &= max_value >> 1;
+            width = width ? width : 1;
+            bins = ((max_value >> 1) + 1) / width;
+            bins = 1 + test_rand() % (bins < 64 ? bins : 64);
+            ok &= etimer_bin_init(&bin, width, bins, max_value) == 0;
+            base = test_rand() & max_value;
+            for (i = 0; i < 200; i++)
+            {
+                // edges of the window first
+                t = i < 4 ? base + bin.span - 2 + i : base + i - 4;
+                t = i < 8 ? t : base + (uint32_t)(test_rand() % (2ull * bin.span)) - bin.span / 2;
+                t &= max_value;
+                rel = etimer_sub_raw(t, base, max_value >> 1, max_value);
+                expect = rel >= 0 && (uint32_t)rel < bin.span ? (uint32_t)rel / width
+                                                               : ETIMER_BIN_NONE;
+                ok &= etimer_bin_one(&bin, t, base) == expect;
+            }
+        }
+    }
+    ASSERT(ok);
+
+    // vector paths against the scalar one, all lengths and alignments, counts included
+    for (d = 0; d < 5; d++)
+    {
+        max_value = max_values[d];
+        for (n = 0; n < 70; n += 1 + n / 8)
+        {
+            for (off = 0; off < 4; off++)
+            {
+                width = 1 + test_rand() % (max_value < 0xFFFF ? 8 : 1000);
+                bins = 1 + test_rand() % 64;
+                bins = (uint64_t)width * bins > (max_value >> 1) + 1 ? 1 : bins;
+                ok &= etimer_bin_init(&bin, width, bins, max_value) == 0;
+                base = test_rand() & (d < 3 ? max_value : 0xFFFF);
+                for (i = 0; i < n; i++)
+                {
+                    times[off + i] = (base + test_rand() % (2 * bin.span) - bin.span / 2) &
+                                     max_value;
+                    times16[off + i] = (uint16_t)times[off + i];
+                }
+                memset(counts, 0, sizeof(counts));
+                memset(model, 0, sizeof(model));
+                inside = etimer_bin_raw(&bin, times + off, n, base, index + off, counts);
+                for (want = 0, i = 0; i < n; i++)
+                {
+                    expect = etimer_bin_one(&bin, times[off + i], base);
+                    ok &= index[off + i] == expect;
+                    if (expect != ETIMER_BIN_NONE)
+                    {
+                        model[expect]++;
+                        want++;
+                    }
+                }
+                ok &= inside == want && memcmp(counts, model, sizeof(counts)) == 0;
+                ok &= etimer_bin_raw(&bin, times + off, n, base, NULL, NULL) == want;
+
+                if (d < 3)
+                {
+                    memset(counts, 0, sizeof(counts));
+                    inside = etimer16_bin_raw(&bin, times16 + off, n, (uint16_t)base, NULL,
+                                              counts);
+                    ok &= inside == want && memcmp(counts, model, sizeof(counts)) == 0;
+                }
+            }
+        }
+    }
+    ASSERT(ok);
+
+    SUITE_END();
+}
+
+void test_etimer_compact(void)
+{
+    SUITE_START("test_etimer_compact");
+
+    static struct etimer_compact compact;
+    static uint32_t model[4096], expired[64];
+    static uint8_t pending[4096];
+    uint32_t now, handle, i, k, ok = 1, early = 0, late = 0, far = 0;
+    size_t n, j;
+
+    ASSERT(etimer_compact_init(&compact, 16, 0, 16, 0) == -EINVAL);
+    ASSERT(etimer_compact_init(&compact, 16, 0x8001, 16, 0) == -EINVAL);
+    ASSERT(etimer_compact_init(&compact, 16, 0x8000, 0x4001, 0) == -EINVAL);
+    ASSERT(etimer_compact_init(&compact, 2, 100, 10, 0) == 0);
+    ASSERT(compact.shift == 7 && compact.mask == 15);
+    ASSERT(etimer_compact_add(&compact, 5) == 0);
+    ASSERT(etimer_compact_add(&compact, 5000) == 1);
+    ASSERT(etimer_compact_add(&compact, 5) == ETIMER_COMPACT_NONE);
+    ASSERT(compact.where[1] == 16 && etimer_compact_deadline(&compact, 1) == 5000);
+    ASSERT(etimer_compact_cancel(&compact, 1) == 0);
+    ASSERT(etimer_compact_cancel(&compact, 1) == -EINVAL);
+    ASSERT(etimer_compact_expire(&compact, 4, expired, 64) == 0);
+    ASSERT(etimer_compact_expire(&compact, 5, expired, 64) == 1 && expired[0] == 0);
+    ASSERT(compact.count == 0);
+    etimer_compact_deinit(&compact);
+
+    // against a model, deadlines up to twice the horizon ahead, now moving across the wrap with
+    // some long pauses, expiry in small batches
+    ASSERT(etimer_compact_init(&compact, 4096, 64, 64, 0xFFF00000) == 0);
+    now = 0xFFF00000;
+    for (i = 0; i < 40000; i++)
+    {
+        k = test_rand() % 8;
+        if (k < 4)
+        {
+            uint32_t deadline = now + test_rand() % (k == 0 ? 2 * 64 * 64 : 300);
+            handle = etimer_compact_add(&compact, deadline);
+            if (handle != ETIMER_COMPACT_NONE)
+            {
+                ok &= !pending[handle];
+                model[handle] = deadline;
+                pending[handle] = 1;
+                far += compact.where[handle] > compact.mask;
+                ok &= etimer_compact_deadline(&compact, handle) == deadline;
+            }
+        }
+        else if (k == 4)
+        {
+            handle = test_rand() % 4096;
+            ok &= etimer_compact_cancel(&compact, handle) == (pending[handle] ? 0 : -EINVAL);
+            pending[handle] = 0;
+        }
+        else
+        {
+            now += test_rand() % 1000 == 0 ? 100000 : test_rand() % 40;
+            do
+            {
+                n = etimer_compact_expire(&compact, now, expired, 1 + test_rand() % 64);
+                for (j = 0; j < n; j++)
+                {
+                    ok &= pending[expired[j]];
+                    early += etimer_sub(now, model[expired[j]]) < 0;
+                    pending[expired[j]] = 0;
+                }
+            } while (n);
+            for (handle = 0; handle < 4096; handle++)
+            {
+                late += pending[handle] && etimer_sub(now, model[handle]) >= 0;
+            }
+        }
+    }
+    ASSERT(ok);
+    ASSERT(early == 0 && late == 0);
+    ASSERT(far > 100 && now < 0xFFF00000);
+    for (handle = 0, k = 0; handle < 4096; handle++)
+    {
+        k += pending[handle];
+    }
+    ASSERT(compact.count == k);
+    etimer_compact_deinit(&compact);
+
+    SUITE_END();
+}
+
+void test_etimer_snap(void)
+{
+    SUITE_START("test_etimer_snap");
+
+    const char *path = "etimer_snap_test.bin";
+    struct etimer_snap_reader reader;
+    uint32_t now = 0xFFFFFF00;
+    uint32_t deadlines[4] = {now + 0x10, now + 0x200, now - 5, now + 0x7FFFFFFF};
+    uint32_t ids[4] = {10, 11, 12, 13};
+    uint32_t narrow[2] = {0x0010, 0xFFE0};
+    uint32_t out[4];
+    FILE *fp;
+
+    // 32bit domain, deltas across the wrap
+    ASSERT(etimer_snap_save(path, deadlines, ids, 4, now, ETIMER_MAX_VALUE, 123) == 0);
+    ASSERT(etimer_snap_open(&reader, path) == 0);
+    ASSERT(reader.header->count == 4 && reader.header->time == now);
+    ASSERT(reader.header->wall == 123 && reader.header->max_value == ETIMER_MAX_VALUE);
+    ASSERT(reader.records[0].delta == 0x10 && reader.records[1].delta == 0x200);
+    ASSERT(reader.records[2].delta == -5 && reader.records[3].delta == 0x7FFFFFFF);
+    ASSERT(reader.records[2].id == 12);
+
+    // new clock restarted from 0x1000, 0x20 ticks after the snapshot
+    ASSERT(etimer_snap_restore(reader.records, 4, 0x1000, 0x20, ETIMER_MAX_VALUE, out) == 2);
+    ASSERT(out[0] == 0xFF0 && out[1] == 0x11E0 && out[2] == 0xFDB && out[3] == 0x80000FDF);
+    ASSERT(etimer_past(out[0], 0x1000) && etimer_past(0x1000, out[1]));
+
+    // all due after a long downtime, the lateness is clamped to a quarter of the range
+    ASSERT(etimer_snap_restore(reader.records, 4, 0x1000, 1000000000000ull, ETIMER_MAX_VALUE,
+                               out) == 4);
+    ASSERT(out[0] == 0xC0001001 && out[3] == 0xC0001001);
+    ASSERT(etimer_sub(0x1000, out[3]) > 0);
+    etimer_snap_close(&reader);
+
+    // 16bit domain, ids default to the indexes
+    ASSERT(etimer_snap_save(path, narrow, NULL, 2, 0xFFF0, 0xFFFF, 0) == 0);
+    ASSERT(etimer_snap_open(&reader, path) == 0);
+    ASSERT(reader.records[0].delta == 0x20 && reader.records[1].delta == -0x10);
+    ASSERT(reader.records[1].id == 1);
+    ASSERT(etimer_snap_restore(reader.records, 2, 0x0005, 0x18, 0xFFFF, out) == 1);
+    ASSERT(out[0] == 0x000D && out[1] == 0xFFDD);
+    etimer_snap_close(&reader);
+
+    // empty and malformed files
+    ASSERT(etimer_snap_save(path, NULL, NULL, 0, 0, ETIMER_MAX_VALUE, 0) == 0);
+    ASSERT(etimer_snap_open(&reader, path) == 0 && reader.header->count == 0);
+    etimer_snap_close(&reader);
+    fp = fopen(path, "ab");
+    fputc(0, fp);
+    fclose(fp);
+    ASSERT(etimer_snap_open(&reader, path) == -EINVAL);
+
+    // a count whose size wraps 64 bits back to the file size, a domain that is not 2^n
+    struct etimer_snap_header header;
+    ASSERT(etimer_snap_save(path, narrow, NULL, 2, 0xFFF0, 0xFFFF, 0) == 0);
+    ASSERT(etimer_snap_open(&reader, path) == 0);
+    header = *reader.header;
+    etimer_snap_close(&reader);
+    header.count = (1ull << 61) + 2;
+    fp = fopen(path, "r+b");
+    fwrite(&header, sizeof(header), 1, fp);
+    fclose(fp);
+    ASSERT(etimer_snap_open(&reader, path) == -EINVAL);
+    header.count = 2;
+    header.max_value = 0xFFFE;
+    header.overflow = 0x7FFF;
+    fp = fopen(path, "r+b");
+    fwrite(&header, sizeof(header), 1, fp);
+    fclose(fp);
+    ASSERT(etimer_snap_open(&reader, path) == -EINVAL);
+    remove(path);
+    ASSERT(etimer_snap_open(&reader, path) == -ENOENT);
+
+    SUITE_END();
+}
+
+void test_etimer_wait(void)
+{
+    SUITE_START("test_etimer_wait");
+
+    struct etimer_wait wait;
+    uint32_t i;
+
+    // the margin settles around a steady oversleep
+    etimer_wait_init(&wait);
+    ASSERT(wait.margin == ETIMER_WAIT_MARGIN_NS);
+    etimer_wait_adapt(&wait, 150000);
+    ASSERT(wait.margin == ETIMER_WAIT_MARGIN_NS + ETIMER_WAIT_MARGIN_NS / 4 + 1);
+    for (i = 0; i < 1000; i++)
+    {
+        etimer_wait_adapt(&wait, 50000);
+    }
+    ASSERT(wait.margin >= 40000 && wait.margin < 63000);
+
+    // covers outliers of 1 sleep in 10, not of 1 in 100
+    for (i = 0; i < 2000; i++)
+    {
+        etimer_wait_adapt(&wait, i % 10 == 0 ? 500000 : 50000);
+    }
+    ASSERT(wait.margin > 400000);
+    for (i = 0; i < 2000; i++)
+    {
+        etimer_wait_adapt(&wait, i % 100 == 0 ? 500000 : 50000);
+    }
+    ASSERT(wait.margin < 100000);
+
+    // clamped
+    for (i = 0; i < 100; i++)
+    {
+        etimer_wait_adapt(&wait, 0x7FFFFFFF);
+    }
+    ASSERT(wait.margin == ETIMER_WAIT_MAX_MARGIN_NS);
+    for (i = 0; i < 2000; i++)
+    {
+        etimer_wait_adapt(&wait, -5);
+    }
+    ASSERT(wait.margin == ETIMER_WAIT_MIN_MARGIN_NS);
+
+#ifdef __linux__
+    int64_t late;
+
+    etimer_wait_init(&wait);
+    late = etimer_wait(&wait, etimer_add(etimer_timerfd_now(), 3000));
+    ASSERT(late >= 0 && late < 2000000);
+    ASSERT(wait.waits == 1 && wait.sleeps == 1);
+
+    // passed deadline returns at once
+    late = etimer_wait(&wait, etimer_add(etimer_timerfd_now(), -100));
+    ASSERT(late >= 100000 && late < 2000000);
+    ASSERT(wait.waits == 2 && wait.sleeps == 1);
+#endif /* __linux__ */
+
+    SUITE_END();
+}
+
+void test_etimer_shm(void)
+{
+    SUITE_START("test_etimer_shm");
+
+#ifdef __linux__
+    static struct etimer_shm_dispatcher disp;
+    struct etimer_shm shm, other;
+    char name[64];
+    uint32_t handles[4], cookies[4], now = 0xFFFFFF00, handle;
+    size_t n;
+    pid_t pid;
+    int status;
+
+    snprintf(name, sizeof(name), "/etimer_shm_test_%d", (int)getpid());
+    ASSERT(etimer_shm_create(&shm, name, 0, 1) == -EINVAL);
+    ASSERT(etimer_shm_create(&shm, name, 4, 2) == 0);
+    ASSERT(etimer_shm_create(&other, name, 4, 2) == -EEXIST);
+    ASSERT(etimer_shm_open(&other, name) == 0 && other.header->capacity == 4);
+    ASSERT(etimer_shm_dispatcher_init(&disp, &shm) == 0);
+
+    // armed through one mapping, dispatched through the other, across the wrap
+    handles[0] = etimer_shm_arm(&other, 0, now + 0x200, 10, now);
+    handles[1] = etimer_shm_arm(&other, 1, now + 0x100, 11, now);
+    handles[2] = etimer_shm_arm(&other, 0, now + 0x180, 12, now);
+    handles[3] = etimer_shm_arm(&other, 1, now + 0x300, 13, now);
+    ASSERT(etimer_shm_arm(&other, 0, now, 14, now) == ETIMER_SHM_NONE);
+    ASSERT(etimer_shm_arm(&other, 2, now, 14, now) == ETIMER_SHM_NONE);
+    ASSERT(etimer_shm_collect(&other, 2, cookies, 4) == 0);
+    ASSERT(etimer_shm_wait(&other, 2, 0) == -EINVAL);
+    ASSERT(etimer_shm_cancel(&other, handles[2]) == 0);
+    ASSERT(etimer_shm_cancel(&other, handles[2]) == -EINVAL);
+
+    ASSERT(etimer_shm_dispatch(&disp, now + 0xFF) == 0 && disp.count == 3);
+    ASSERT(etimer_shm_dispatch(&disp, now + 0x200) == 2);
+    ASSERT(etimer_shm_cancel(&other, handles[0]) == -EINVAL);
+    ASSERT(etimer_shm_wait(&other, 0, 0) == 1);
+    n = etimer_shm_collect(&other, 0, cookies, 4);
+    ASSERT(n == 1 && cookies[0] == 10);
+    ASSERT(etimer_shm_collect(&other, 1, cookies, 4) == 1 && cookies[0] == 11);
+
+    // freed slots come back with a new generation, stale handles are refused
+    handle = etimer_shm_arm(&shm, 1, now + 0x400, 15, now + 0x200);
+    ASSERT(handle != ETIMER_SHM_NONE);
+    ASSERT(etimer_shm_cancel(&shm, handles[0]) == -EINVAL);
+    ASSERT(etimer_shm_cancel(&shm, handles[1]) == -EINVAL);
+    ASSERT(etimer_shm_dispatch(&disp, now + 0x400) == 2);
+    ASSERT(etimer_shm_collect(&shm, 1, cookies, 1) == 1);
+    ASSERT(etimer_shm_collect(&shm, 1, cookies + 1, 1) == 1);
+    ASSERT(cookies[0] + cookies[1] == 13 + 15);
+    ASSERT(etimer_shm_wait(&shm, 1, 0) == 0);
+    etimer_shm_close(&other);
+
+    // another process arms and waits, this one dispatches on the real clock
+    pid = fork();
+    if (pid == 0)
+    {
+        uint32_t cookie = 0;
+
+        if (etimer_shm_open(&other, name) != 0)
+        {
+            _exit(1);
+        }
+        now = etimer_timerfd_now();
+        etimer_shm_arm(&other, 1, etimer_add(now, 2000), 42, now);
+        while (!etimer_shm_wait(&other, 1, 100000))
+        {
+        }
+        etimer_shm_collect(&other, 1, &cookie, 1);
+        _exit(cookie == 42 ? 0 : 1);
+    }
+    n = 0;
+    while (n == 0)
+    {
+        etimer_shm_dispatcher_sleep(&disp, etimer_timerfd_now());
+        n += etimer_shm_dispatch(&disp, etimer_timerfd_now());
+    }
+    waitpid(pid, &status, 0);
+    ASSERT(n == 1 && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    etimer_shm_dispatcher_deinit(&disp);
+
+    // a capacity past the handle index bits, with a size that matches it
+    int fd = shm_open(name, O_RDWR, 0);
+    shm.header->capacity = 1u << ETIMER_SHM_INDEX_BITS;
+    ASSERT(fd >= 0 && ftruncate(fd, sizeof(struct etimer_shm_header) +
+                                            2 * sizeof(struct etimer_shm_owner) +
+                                            ((size_t)1 << ETIMER_SHM_INDEX_BITS) *
+                                                    sizeof(struct etimer_shm_slot)) == 0);
+    close(fd);
+    ASSERT(etimer_shm_open(&other, name) == -EINVAL);
+
+    etimer_shm_close(&shm);
+    ASSERT(etimer_shm_unlink(name) == 0);
+    ASSERT(etimer_shm_open(&other, name) == -ENOENT);
+#endif /* __linux__ */
+
+    SUITE_END();
+}
+
 int main(void)
 {
     // normal process test
@@ -964,5 +3074,28 @@ int main(void)
     test_etimer16_raw_sub();
     test_etimer16_raw_add();
 
+    // extension module test
+    test_etimer_trace();
+    test_etimer_min();
+    test_etimer_service();
+    test_etimer_loop();
+    test_etimer_timerfd();
+    test_etimer_stat();
+    test_etimer_prof();
+    test_etimer_store();
+    test_etimer_jitter();
+    test_etimer_queue();
+    test_etimer_sorted();
+    test_etimer_clock();
+    test_etimer_edf();
+    test_etimer_idle();
+    test_etimer_lift();
+    test_etimer_earliest();
+    test_etimer_bin();
+    test_etimer_compact();
+    test_etimer_snap();
+    test_etimer_wait();
+    test_etimer_shm();
+
     return 0;
 }